@@ -1,24 +1,53 @@
 #ifndef AATREE_H
 #define AATREE_H
 
+#include <cstddef>
 #include <exception>
-
-template <typename Key, typename Value>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../eytzinger_layout/src/eytzinger.h"
+#include "../../key_compare/src/keycompare.h"
+#include "../../parallel_sort/src/parallelsort.h"
+#include "../../tree_statistics/src/treestatistics.h"
+
+// Keys are ordered by the Compare policy (see keycompare.h) with one
+// three-way comparison per visited node.
+template <typename Key, typename Value, typename Compare = ThreeWayCompare<Key> >
 class AATree {
+	typedef typename Compare::Cache KeyCache;
+
 	struct Node {
 		Node* left;
 		Node* right;
 		Key key;
 		Value value;
+		KeyCache cache;
 		int level;
 
-		Node(const Key& key, const Value& value)
-			: key(key), value(value), left(0), right(0), level(1) {
+		template <typename K, typename V>
+		Node(K&& key, V&& value)
+			: left(0), right(0), key(std::forward<K>(key)), value(std::forward<V>(value)), cache(Compare::cache(this->key)), level(1) {
 		}
 	};
 
 	Node* root;
 
+	// The right spine of the tree: finger[0] is the root and every other
+	// entry is the right child of the one before it. Empty when it has to be
+	// rebuilt, i.e. after any change other than putNearEnd.
+	std::vector<Node*> finger;
+
+	// Operation counts, kept only when TREE_STATISTICS is defined
+	mutable TreeCounters counters;
+
+	// Compares key, whose cache is keyCache, with the key of node
+	int compare(const Key& key, const KeyCache& keyCache, const Node* node) const {
+		return Compare::compare(key, keyCache, node->key, node->cache);
+	}
+
 	void skew(Node*& root) {
 		if (root != 0 && root->left != 0 &&
 			root->level == root->left->level) {
@@ -26,6 +55,7 @@ class AATree {
 			root->left = newRoot->right;
 			newRoot->right = root;
 			root = newRoot;
+			counters.skews.add(1);
 		}
 	}
 
@@ -37,26 +67,38 @@ class AATree {
 			newRoot->left = root;
 			newRoot->level++;
 			root = newRoot;
+			counters.splits.add(1);
 		}
 	}
 
-	void insert(Node*& root, const Key& key, const Value& value) {
+	// Returns the node holding key. An existing value is only replaced when
+	// overwrite is set.
+	template <typename K, typename V>
+	Node* insert(Node*& root, K&& key, const KeyCache& keyCache, V&& value, bool overwrite) {
 		if (root == 0) {
-			root = new Node(key, value);
+			root = new Node(std::forward<K>(key), std::forward<V>(value));
 
-			return;
+			return root;
 		}
 
-		if (key < root->key) {
-			insert(root->left, key, value);
-		} else if (key > root->key) {
-			insert(root->right, key, value);
+		Node* node;
+		int comparison = compare(key, keyCache, root);
+		if (comparison < 0) {
+			node = insert(root->left, std::forward<K>(key), keyCache, std::forward<V>(value), overwrite);
+		} else if (comparison > 0) {
+			node = insert(root->right, std::forward<K>(key), keyCache, std::forward<V>(value), overwrite);
 		} else {
-			root->value = value;
+			if (overwrite) {
+				root->value = std::forward<V>(value);
+			}
+
+			return root;
 		}
 
 		skew(root);
 		split(root);
+
+		return node;
 	}
 
 	int nlevel(Node*& node) {
@@ -67,11 +109,47 @@ class AATree {
 		}
 	}
 
-	void remove(Node*& root, const Key& key) {
-		if (key < root->key) {
-			remove(root->left, key);
-		} else if (key > root->key) {
-			remove(root->right, key);
+	static int levelOf(const Node* node) {
+		return node == 0 ? 0 : node->level;
+	}
+
+	// The level of node if it roots a valid subtree with keys between those
+	// of low and high (either 0 for no bound), -1 otherwise
+	int checkSubtree(const Node* node, const Node* low, const Node* high) const {
+		if (node == 0) {
+			return 0;
+		}
+
+		if ((low != 0 && compare(node->key, node->cache, low) <= 0)
+				|| (high != 0 && compare(node->key, node->cache, high) >= 0)
+				|| levelOf(node->left) != node->level - 1
+				|| (levelOf(node->right) != node->level && levelOf(node->right) != node->level - 1)
+				|| (node->right != 0 && levelOf(node->right->right) >= node->level)) {
+			return -1;
+		}
+
+		if (checkSubtree(node->left, low, node) < 0 || checkSubtree(node->right, node, high) < 0) {
+			return -1;
+		}
+
+		return node->level;
+	}
+
+	// Returns whether key was found and removed
+	bool remove(Node*& root, const Key& key, const KeyCache& keyCache) {
+		if (root == 0) {
+			return false;
+		}
+
+		int comparison = compare(key, keyCache, root);
+		if (comparison < 0) {
+			if (!remove(root->left, key, keyCache)) {
+				return false;
+			}
+		} else if (comparison > 0) {
+			if (!remove(root->right, key, keyCache)) {
+				return false;
+			}
 		} else {
 			if (root->left != 0 && root->right != 0) {
 				Node* predecessor = root->left;
@@ -79,9 +157,11 @@ class AATree {
 					predecessor = predecessor->right;
 				}
 
+				root->key = predecessor->key;
 				root->value = predecessor->value;
+				root->cache = predecessor->cache;
 
-				remove(root->left, root->value);
+				remove(root->left, root->key, root->cache);
 			} else {
 				Node* heir;
 				if (root->left == 0) {
@@ -92,7 +172,7 @@ class AATree {
 
 				delete root;
 				root = heir;
-				return;
+				return true;
 			}
 		}
 
@@ -112,8 +192,197 @@ class AATree {
 			split(root);
 			split(root->right);
 		}
+
+		return true;
+	}
+
+	// The link that points to finger[level]
+	Node*& fingerLink(std::size_t level) {
+		return level == 0 ? root : finger[level - 1]->right;
+	}
+
+	void rebuildFinger(std::size_t level) {
+		finger.resize(level);
+		for (Node* node = fingerLink(level); node != 0; node = node->right) {
+			finger.push_back(node);
+		}
+	}
+
+	template <typename K, typename V>
+	void insertNearEnd(K&& key, V&& value) {
+		if (finger.empty()) {
+			rebuildFinger(0);
+		}
+
+		KeyCache keyCache = Compare::cache(key);
+		std::size_t level = finger.size();
+		int comparison = 1;
+		while (level > 0 && (comparison = compare(key, keyCache, finger[level - 1])) < 0) {
+			level--;
+		}
+
+		if (level > 0 && comparison == 0) {
+			finger[level - 1]->value = std::forward<V>(value);
+			return;
+		}
+
+		// key is greater than every spine node above level and less than
+		// finger[level], so it goes into the left part of that subtree
+		Node*& link = fingerLink(level);
+		Node* oldNode = link;
+		int oldLevel = nlevel(oldNode);
+		insert(link, std::forward<K>(key), keyCache, std::forward<V>(value), true);
+
+		// skew and split of a spine node look at most two spine nodes down,
+		// so the walk up stops after two unchanged ones
+		bool changed = link != oldNode || link->level != oldLevel;
+		bool changedBelow = changed;
+		while (level > 0 && (changed || changedBelow)) {
+			level--;
+			Node*& current = fingerLink(level);
+			oldNode = current;
+			oldLevel = current->level;
+
+			skew(current);
+			split(current);
+
+			changedBelow = changed;
+			changed = current != oldNode || current->level != oldLevel;
+		}
+
+		rebuildFinger(level);
+	}
+
+	const Value* find(const Node* root, const Key& key) const {
+		KeyCache keyCache = Compare::cache(key);
+		const Node* current = root;
+		unsigned long long comparisons = 0;
+
+		while (current != 0) {
+			int comparison = compare(key, keyCache, current);
+			comparisons++;
+
+			if (comparison < 0) {
+				current = current->left;
+			} else if (comparison > 0) {
+				current = current->right;
+			} else {
+				break;
+			}
+		}
+
+		counters.lookups.add(1);
+		counters.lookupComparisons.add(comparisons);
+
+		return current != 0 ? &current->value : 0;
+	}
+
+	struct EntryLess {
+		bool operator()(const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) const {
+			return Compare::compare(a.first, Compare::cache(a.first), b.first, Compare::cache(b.first)) < 0;
+		}
+	};
+
+	static void prefetch(const Node* node) {
+#ifdef __GNUC__
+		if (node != 0) {
+			__builtin_prefetch(node);
+		}
+#endif
+	}
+
+	// Number of searches findGroup runs side by side
+	static const std::size_t BATCH_GROUP_SIZE = 16;
+
+	// Searches for up to BATCH_GROUP_SIZE keys in lockstep, one level of each
+	// search per round, and prefetches every next node. The cache misses of
+	// the searches then overlap instead of following one another. Stores a
+	// pointer to the value of keys[i], or 0, in results[i].
+	void findGroup(const Key* const* keys, std::size_t count, const Value** results) const {
+		const Node* current[BATCH_GROUP_SIZE];
+		KeyCache caches[BATCH_GROUP_SIZE];
+		std::size_t active = root != 0 ? count : 0;
+		unsigned long long comparisons = 0;
+
+		for (std::size_t i = 0; i < count; i++) {
+			current[i] = root;
+			caches[i] = Compare::cache(*keys[i]);
+			results[i] = 0;
+		}
+
+		while (active > 0) {
+			for (std::size_t i = 0; i < count; i++) {
+				const Node* node = current[i];
+				if (node == 0) {
+					continue;
+				}
+
+				int comparison = compare(*keys[i], caches[i], node);
+				comparisons++;
+				if (comparison == 0) {
+					results[i] = &node->value;
+					node = 0;
+				} else {
+					node = (comparison < 0 ? node->left : node->right);
+					prefetch(node);
+				}
+
+				if (node == 0) {
+					active--;
+				}
+				current[i] = node;
+			}
+		}
+
+		counters.lookups.add(count);
+		counters.lookupComparisons.add(comparisons);
+	}
+
+	// Sorts entries by key on up to threads threads and keeps only the last
+	// of equal keys
+	static void sortBatch(std::vector<std::pair<Key, Value> >& entries, unsigned threads = 1) {
+		parallelStableSort(entries.begin(), entries.end(), EntryLess(), threads);
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < entries.size(); i++) {
+			if (i + 1 < entries.size() && !EntryLess()(entries[i], entries[i + 1])) {
+				continue;
+			}
+
+			if (count != i) {
+				entries[count] = std::move(entries[i]);
+			}
+			count++;
+		}
+
+		entries.erase(entries.begin() + count, entries.end());
+	}
+
+	void collectStatistics(const Node* root, int depth, TreeStatistics& statistics) const {
+		if (root != 0) {
+			statistics.addNode(depth);
+			collectStatistics(root->left, depth + 1, statistics);
+			collectStatistics(root->right, depth + 1, statistics);
+		}
 	}
 
+	template <typename Visitor>
+	void forEach(const Node* root, Visitor& visitor) const {
+		if (root != 0) {
+			forEach(root->left, visitor);
+			visitor(root->key, root->value);
+			forEach(root->right, visitor);
+		}
+	}
+
+	struct EntryCollector {
+		std::vector<std::pair<Key, Value> >* entries;
+
+		void operator()(const Key& key, const Value& value) {
+			entries->push_back(std::make_pair(key, value));
+		}
+	};
+
 	void deleteTree(Node*& root) const {
 		if (root == 0) {
 			return;
@@ -125,16 +394,76 @@ class AATree {
 		delete root;
 	}
 
-	void buildFromTree(Node*& root, Node*& from) {
+	void buildFromTree(Node*& root, Node* from) {
 		if (from != 0) {
 			root = new Node(from->key, from->value);
+			root->level = from->level;
 
 			buildFromTree(root->left, from->left);
 			buildFromTree(root->right, from->right);
 		}
 	}
 
+	static int floorLog2(std::size_t n) {
+		int result = 0;
+		while (n > 1) {
+			n >>= 1;
+			result++;
+		}
+
+		return result;
+	}
+
+	// Builds a tree from count sorted entries by always taking the lower middle
+	// as the root, so the right subtree is never the smaller one. Giving every
+	// node the level floor(log2(count + 1)) then satisfies the AA invariants.
+	// If copying an entry throws, the nodes built so far are freed.
+	template <typename RandomAccessIterator>
+	Node* buildFromSorted(RandomAccessIterator first, std::size_t count, int parallelDepth) {
+		if (count == 0) {
+			return 0;
+		}
+
+		std::size_t leftCount = (count - 1) / 2;
+		RandomAccessIterator middle = first + leftCount;
+		Node* node = new Node(middle->first, middle->second);
+		node->level = floorLog2(count + 1);
+
+		try {
+			if (parallelDepth > 0 && count >= PARALLEL_BUILD_GRAIN) {
+				parallelInvoke([=]() {
+					node->left = buildFromSorted(first, leftCount, parallelDepth - 1);
+				}, [=]() {
+					node->right = buildFromSorted(middle + 1, count - leftCount - 1, parallelDepth - 1);
+				});
+			} else {
+				node->left = buildFromSorted(first, leftCount, 0);
+				node->right = buildFromSorted(middle + 1, count - leftCount - 1, 0);
+			}
+		} catch (...) {
+			deleteTree(node);
+			throw;
+		}
+
+		return node;
+	}
+
+	template <typename RandomAccessIterator>
+	void buildFromSorted(RandomAccessIterator first, RandomAccessIterator last, int parallelDepth) {
+		AATree temp;
+		temp.root = buildFromSorted(first, last - first, parallelDepth);
+		swap(temp);
+	}
+
+	// Subtrees smaller than this are not worth a thread of their own
+	static const std::size_t PARALLEL_BUILD_GRAIN = 1 << 14;
+
 public:
+	typedef Key KeyType;
+	typedef Value ValueType;
+	// The ordering of the keys, which snapshots share
+	typedef Compare KeyCompare;
+
 	AATree()
 		: root(0) {
 	}
@@ -149,7 +478,8 @@ public:
 	}
 
 	void swap(AATree& tree) {
-		std::swap(root, tree->root);
+		std::swap(root, tree.root);
+		finger.swap(tree.finger);
 	}
 
 	AATree& operator=(const AATree& tree) {
@@ -165,47 +495,203 @@ public:
 		return root == 0;
 	}
 
-	void put(const Key& key, const Key& value) {
-		insert(root, key, value);
+	// Replaces the contents with the (key, value) pairs of [first, last), whose
+	// keys must be strictly increasing. Runs in O(n) without any rebalancing.
+	template <typename RandomAccessIterator>
+	void buildFromSorted(RandomAccessIterator first, RandomAccessIterator last) {
+		buildFromSorted(first, last, 0);
+	}
+
+	// Same as buildFromSorted but builds independent subtrees on up to threads threads
+	template <typename RandomAccessIterator>
+	void buildFromSortedParallel(RandomAccessIterator first, RandomAccessIterator last,
+			unsigned threads = std::thread::hardware_concurrency()) {
+		buildFromSorted(first, last, floorLog2(threads) + ((threads & (threads - 1)) != 0));
+	}
+
+	// Replaces the contents with the (key, value) pairs of [first, last) in
+	// any order; of equal keys the last one wins, as with put. Sorts with a
+	// parallel merge sort and builds like buildFromSortedParallel, both on
+	// up to threads threads, in O(n log n / threads + n).
+	template <typename InputIterator>
+	void buildFrom(InputIterator first, InputIterator last, unsigned threads = std::thread::hardware_concurrency()) {
+		std::vector<std::pair<Key, Value> > entries(first, last);
+		sortBatch(entries, threads);
+		buildFromSortedParallel(entries.begin(), entries.end(), threads);
+	}
+
+	void put(const Key& key, const Value& value) {
+		finger.clear();
+		insert(root, key, Compare::cache(key), value, true);
+	}
+
+	void put(Key&& key, Value&& value) {
+		finger.clear();
+		KeyCache keyCache = Compare::cache(key);
+		insert(root, std::move(key), keyCache, std::move(value), true);
+	}
+
+	// Same as put, but searches up the right spine from the largest key
+	// instead of down from the root and rebalances only as far up as needed.
+	// A key among the d largest costs O(log d) plus amortized O(1)
+	// rebalancing, so streams of mostly increasing keys insert in nearly
+	// constant time. The first call after any other change rebuilds the
+	// spine in O(log n).
+	void putNearEnd(const Key& key, const Value& value) {
+		insertNearEnd(key, value);
+	}
+
+	void putNearEnd(Key&& key, Value&& value) {
+		insertNearEnd(std::move(key), std::move(value));
+	}
+
+	// Returns the value for key, inserting a default constructed one at the
+	// position the search ended on if key is absent
+	Value& getOrInsert(const Key& key) {
+		finger.clear();
+		return insert(root, key, Compare::cache(key), Value(), false)->value;
 	}
 
 	void remove(const Key& key) {
-		if (!contains(key)) {
+		finger.clear();
+		if (!remove(root, key, Compare::cache(key))) {
 			throw std::exception();
 		}
-		remove(root, key);
 	}
 
-	Value get(const Key& key) {
-		Node* current = root;
+	// Removes key in a single pass and returns whether it was present
+	bool tryRemove(const Key& key) {
+		finger.clear();
+		return remove(root, key, Compare::cache(key));
+	}
 
-		while (current != 0 && key != current->key) {
-			if (key < current->key) {
-				current = current->left;
-			} else {
-				current = current->right;
-			}
-		}
+	Value get(const Key& key) const {
+		const Value* value = find(root, key);
 
-		if (current == 0) {
+		if (value == 0) {
 			throw std::exception();
 		}
 
-		return current->value;
+		return *value;
 	}
 
-	bool contains(const Key& key) {
-		Node* current = root;
+	// Pointer to the value for key, or 0 if there is none. Removing any key
+	// may invalidate it.
+	Value* find(const Key& key) {
+		return const_cast<Value*>(find(root, key));
+	}
 
-		while (current != 0 && key != current->key) {
-			if (key < current->key) {
-				current = current->left;
-			} else {
-				current = current->right;
+	const Value* find(const Key& key) const {
+		return find(root, key);
+	}
+
+	bool contains(const Key& key) const {
+		return find(root, key) != 0;
+	}
+
+	// Looks up the keys [first, last) and stores a pointer to the value of
+	// the i-th one, or 0 if it is absent, in results[i]. The searches run in
+	// interleaved groups so their cache misses overlap, which on large trees
+	// is several times faster than calling find for each key. The pointers
+	// are invalidated like those of find.
+	template <typename RandomAccessIterator>
+	void findBatch(RandomAccessIterator first, RandomAccessIterator last, const Value** results) const {
+		std::size_t count = last - first;
+
+		for (std::size_t base = 0; base < count; base += BATCH_GROUP_SIZE) {
+			std::size_t groupSize = count - base < BATCH_GROUP_SIZE ? count - base : BATCH_GROUP_SIZE;
+			const Key* keys[BATCH_GROUP_SIZE];
+
+			for (std::size_t i = 0; i < groupSize; i++) {
+				keys[i] = &first[base + i];
+			}
+			findGroup(keys, groupSize, results + base);
+		}
+	}
+
+	// Puts the (key, value) pairs of [first, last); of equal keys the last
+	// one wins. A batch of at least 2^level of the root entries, which lies
+	// between about sqrt(n) and n depending on the shape of the tree, is
+	// inserted in key order, so consecutive descents share the cached upper
+	// part of their paths. A smaller batch is first looked up in interleaved
+	// groups like findBatch: present keys get their new values in place and
+	// only the absent ones are inserted, along paths that are then cached.
+	template <typename RandomAccessIterator>
+	void putBatch(RandomAccessIterator first, RandomAccessIterator last) {
+		std::size_t count = last - first;
+
+		if (count >= static_cast<std::size_t>(1) << nlevel(root)) {
+			std::vector<std::pair<Key, Value> > entries(first, last);
+			sortBatch(entries);
+
+			finger.clear();
+			for (std::size_t i = 0; i < entries.size(); i++) {
+				KeyCache keyCache = Compare::cache(entries[i].first);
+				insert(root, std::move(entries[i].first), keyCache, std::move(entries[i].second), true);
+			}
+			return;
+		}
+
+		finger.clear();
+		for (std::size_t base = 0; base < count; base += BATCH_GROUP_SIZE) {
+			std::size_t groupSize = count - base < BATCH_GROUP_SIZE ? count - base : BATCH_GROUP_SIZE;
+			const Key* keys[BATCH_GROUP_SIZE];
+			const Value* values[BATCH_GROUP_SIZE];
+
+			for (std::size_t i = 0; i < groupSize; i++) {
+				keys[i] = &first[base + i].first;
+			}
+			findGroup(keys, groupSize, values);
+
+			// Inserting never moves a node, so the pointers stay valid
+			for (std::size_t i = 0; i < groupSize; i++) {
+				if (values[i] != 0) {
+					*const_cast<Value*>(values[i]) = first[base + i].second;
+				} else {
+					insert(root, first[base + i].first, Compare::cache(first[base + i].first), first[base + i].second, true);
+				}
 			}
 		}
+	}
+
+	// Whether the tree keeps the AA invariants: keys in order, leaves at
+	// level 1, left children one level below their parent, right children
+	// at most one below and right grandchildren strictly below. Takes O(n);
+	// meant for tests.
+	bool isValid() const {
+		return checkSubtree(root, 0, 0) >= 0;
+	}
+
+	// Calls visitor(key, value) for every entry in increasing key order
+	template <typename Visitor>
+	void forEach(Visitor visitor) const {
+		forEach(root, visitor);
+	}
+
+	// Immutable copy of the current contents laid out for fast lookups,
+	// ordered by the same Compare. Takes O(n); the snapshot does not see
+	// later changes to the tree.
+	EytzingerSnapshot<Key, Value, Compare> snapshot() const {
+		std::vector<std::pair<Key, Value> > entries;
+		EntryCollector collector = { &entries };
+		forEach(root, collector);
+
+		return EytzingerSnapshot<Key, Value, Compare>(entries.begin(), entries.end());
+	}
+
+	// Shape of the tree, computed in O(n), and the operation counts since
+	// construction or the last resetCounters
+	TreeStatistics statistics() const {
+		TreeStatistics result;
+		collectStatistics(root, 0, result);
+		result.bytesUsed = result.nodeCount * sizeof(Node) + sizeof(*this) + finger.capacity() * sizeof(Node*);
+		result.setCounters(counters);
+
+		return result;
+	}
 
-		return current != 0;
+	void resetCounters() {
+		counters.reset();
 	}
 };
 
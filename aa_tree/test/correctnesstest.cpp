@@ -0,0 +1,246 @@
+#include "aatree.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+using namespace std;
+
+typedef AATree<int, int> Tree;
+
+struct EntryCollector {
+	vector<pair<int, int> >* entries;
+
+	void operator()(int key, int value) {
+		entries->push_back(make_pair(key, value));
+	}
+};
+
+// Whether tree is a valid AA tree holding exactly the entries of expected
+bool matches(const Tree& tree, const map<int, int>& expected) {
+	vector<pair<int, int> > entries;
+	EntryCollector collector = { &entries };
+	tree.forEach(collector);
+
+	return tree.isValid() && tree.isEmpty() == expected.empty()
+		&& entries == vector<pair<int, int> >(expected.begin(), expected.end());
+}
+
+// buildFromSorted for 0, 1, 2^k - 1, 2^k and 2^k + 1 entries must give a
+// valid tree, and buildFromSortedParallel one of the same shape
+void testBuildFromSorted() {
+	vector<size_t> sizes;
+	for (int k = 0; k <= 16; k++) {
+		sizes.push_back((static_cast<size_t>(1) << k) - 1);
+		sizes.push_back(static_cast<size_t>(1) << k);
+		sizes.push_back((static_cast<size_t>(1) << k) + 1);
+	}
+
+	for (size_t i = 0; i < sizes.size(); i++) {
+		vector<pair<int, int> > entries;
+		for (size_t j = 0; j < sizes[i]; j++) {
+			entries.push_back(make_pair(static_cast<int>(2 * j), static_cast<int>(j)));
+		}
+		map<int, int> expected(entries.begin(), entries.end());
+
+		Tree serial;
+		Tree parallel;
+		serial.buildFromSorted(entries.begin(), entries.end());
+		parallel.buildFromSortedParallel(entries.begin(), entries.end(), 4);
+
+		if (!matches(serial, expected) || !matches(parallel, expected)) {
+			cout << "Fail on buildFromSorted test with " << sizes[i] << " entries" << endl;
+			return;
+		}
+		if (serial.statistics().depthHistogram != parallel.statistics().depthHistogram) {
+			cout << "Fail on buildFromSortedParallel shape test with " << sizes[i] << " entries" << endl;
+			return;
+		}
+
+		// The built tree must stay valid under updates
+		for (int j = 0; j < 100; j++) {
+			int key = rand() % (2 * static_cast<int>(sizes[i]) + 2);
+			if (rand() % 2 == 0) {
+				serial.put(key, j);
+				expected[key] = j;
+			} else if (serial.tryRemove(key) != (expected.erase(key) != 0)) {
+				cout << "Fail on buildFromSorted update test with " << sizes[i] << " entries" << endl;
+				return;
+			}
+		}
+		if (!matches(serial, expected)) {
+			cout << "Fail on buildFromSorted update test with " << sizes[i] << " entries" << endl;
+			return;
+		}
+	}
+}
+
+// putNearEnd on keys near the largest, interleaved with the updates that
+// invalidate its cached spine
+void testPutNearEnd() {
+	Tree tree;
+	map<int, int> expected;
+	int largest = 0;
+
+	for (int i = 0; i < 20000; i++) {
+		if (expected.empty()) {
+			tree.putNearEnd(largest, i);
+			expected[largest] = i;
+		}
+		int step = rand() % 10;
+
+		if (step < 6) {
+			int key = largest - rand() % 20 + rand() % 5;
+			tree.putNearEnd(key, i);
+			expected[key] = i;
+			largest = max(largest, key);
+		} else if (step == 6) {
+			int key = rand() % (largest + 1);
+			tree.put(key, i);
+			expected[key] = i;
+		} else if (step == 7) {
+			// Often the largest key, whose node the cached spine ends on
+			int key = rand() % 2 == 0 ? expected.rbegin()->first : rand() % (largest + 1);
+			if (tree.tryRemove(key) != (expected.erase(key) != 0)) {
+				cout << "Fail on putNearEnd remove test" << endl;
+				return;
+			}
+		} else if (step == 8) {
+			int key = largest - rand() % 10;
+			tree.getOrInsert(key) += 1;
+			expected[key] += 1;
+		} else {
+			int key = largest - rand() % 30;
+			if (expected.count(key) != 0) {
+				tree.remove(key);
+				expected.erase(key);
+			}
+		}
+
+		if (i % 500 == 0 && !matches(tree, expected)) {
+			cout << "Fail on putNearEnd test" << endl;
+			return;
+		}
+	}
+
+	if (!matches(tree, expected)) {
+		cout << "Fail on putNearEnd test" << endl;
+	}
+}
+
+// Batches far below and far above the size at which putBatch switches to
+// the sorted path, with repeated keys in them; the last of equal keys wins.
+// findBatch must agree with find on every key.
+void testPutBatch() {
+	// A tree of 10000 entries has a root level between 7 and 13, so the
+	// threshold lies between 2^7 and 2^13
+	const int SIZES[] = {0, 1, 16, 17, 50, 10000, 20000};
+	const int RANGE = 30000;
+
+	for (size_t s = 0; s < sizeof(SIZES)/sizeof(SIZES[0]); s++) {
+		for (int initial = 0; initial <= 10000; initial += 10000) {
+			Tree tree;
+			map<int, int> expected;
+			for (int i = 0; i < initial; i++) {
+				int key = rand() % RANGE;
+				tree.put(key, -1);
+				expected[key] = -1;
+			}
+
+			vector<pair<int, int> > batch;
+			for (int i = 0; i < SIZES[s]; i++) {
+				// Every third entry repeats an earlier key of the batch
+				int key = i % 3 == 2 ? batch[rand() % i].first : rand() % RANGE;
+				batch.push_back(make_pair(key, i));
+				expected[key] = i;
+			}
+
+			tree.putBatch(batch.begin(), batch.end());
+			if (!matches(tree, expected)) {
+				cout << "Fail on putBatch test with " << SIZES[s] << " entries into " << initial << endl;
+				return;
+			}
+
+			vector<int> keys;
+			for (int i = 0; i < SIZES[s] + 40; i++) {
+				keys.push_back(rand() % (RANGE + 10) - 5);
+			}
+			vector<const int*> results(keys.size());
+			tree.findBatch(keys.begin(), keys.end(), results.data());
+			for (size_t i = 0; i < keys.size(); i++) {
+				map<int, int>::const_iterator found = expected.find(keys[i]);
+				if (found == expected.end() ? results[i] != 0 : results[i] == 0 || *results[i] != found->second) {
+					cout << "Fail on findBatch test" << endl;
+					return;
+				}
+			}
+		}
+	}
+}
+
+// Counts its copies over all threads and throws on the copy numbered
+// throwingCopy, so a build can be made to fail partway
+atomic<long long> copies(0);
+atomic<long long> throwingCopy(-1);
+
+struct ThrowingValue {
+	int value;
+
+	explicit ThrowingValue(int value)
+		: value(value) {
+	}
+
+	ThrowingValue(const ThrowingValue& other)
+		: value(other.value) {
+		if (copies.fetch_add(1) == throwingCopy.load()) {
+			throw std::exception();
+		}
+	}
+};
+
+// A build that throws partway, serial or on several threads, must reach
+// the caller, leave the tree as it was and free every node it made, which
+// the leak checker of the sanitizer builds verifies
+template <typename T>
+void testThrowingBuild(const char* name) {
+	vector<pair<int, ThrowingValue> > entries;
+	for (int i = 0; i < 200000; i++) {
+		entries.push_back(make_pair(2 * i, ThrowingValue(i)));
+	}
+
+	const long long LIMITS[] = {0, 1, 100000, 199999};
+	for (size_t i = 0; i < sizeof(LIMITS)/sizeof(LIMITS[0]); i++) {
+		for (unsigned threads = 1; threads <= 4; threads *= 4) {
+			T tree;
+			tree.put(-1, ThrowingValue(-1));
+
+			copies.store(0);
+			throwingCopy.store(LIMITS[i]);
+			bool thrown = false;
+			try {
+				tree.buildFromSortedParallel(entries.begin(), entries.end(), threads);
+			} catch (std::exception&) {
+				thrown = true;
+			}
+			throwingCopy.store(-1);
+
+			if (!thrown || !tree.contains(-1) || tree.contains(0) || !tree.isValid()) {
+				cout << "Fail on " << name << " throwing build test with limit " << LIMITS[i] << ", " << threads
+					<< " threads" << endl;
+				return;
+			}
+		}
+	}
+}
+
+int main() {
+	testBuildFromSorted();
+	testPutNearEnd();
+	testPutBatch();
+	testThrowingBuild<AATree<int, ThrowingValue> >("AATree");
+
+	return 0;
+}
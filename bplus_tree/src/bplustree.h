@@ -0,0 +1,494 @@
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <cstddef>
+#include <exception>
+#include <algorithm>
+
+// Default number of keys per node, chosen so that a node's key array spans
+// a few cache lines
+template <typename Key>
+struct BPlusTreeDefaultCapacity {
+	static const int value = sizeof(Key) >= 32 ? 8 : (sizeof(Key) >= 8 ? 256 / sizeof(Key) : 64);
+};
+
+// B+-tree with the put/get/remove/contains interface of AATree and
+// RedBlackTree. Entries live in the leaves, which are linked for range
+// scans. Keys and values must be default constructible.
+template <typename Key, typename Value, int Capacity = BPlusTreeDefaultCapacity<Key>::value>
+class BPlusTree {
+	static_assert(Capacity >= 4, "BPlusTree nodes need room for at least 4 keys");
+
+	// Splitting a full inner node moves one key up, so inner nodes may hold
+	// one key less than leaves
+	static const int MIN_LEAF_KEYS = Capacity / 2;
+	static const int MIN_INNER_KEYS = (Capacity - 1) / 2;
+
+	struct Node {
+		bool isLeaf;
+		int count;
+		Key keys[Capacity];
+
+		Node(bool isLeaf)
+			: isLeaf(isLeaf), count(0) {
+		}
+	};
+
+	struct Leaf : Node {
+		Value values[Capacity];
+		Leaf* next;
+
+		Leaf()
+			: Node(true), next(0) {
+		}
+	};
+
+	// Keys in children[i] are less than keys[i] and not less than keys[i - 1]
+	struct Inner : Node {
+		Node* children[Capacity + 1];
+
+		Inner()
+			: Node(false) {
+		}
+	};
+
+	Node* root;
+
+	static Leaf* asLeaf(Node* node) {
+		return static_cast<Leaf*>(node);
+	}
+
+	static Inner* asInner(Node* node) {
+		return static_cast<Inner*>(node);
+	}
+
+	static int minKeys(const Node* node) {
+		return node->isLeaf ? MIN_LEAF_KEYS : MIN_INNER_KEYS;
+	}
+
+	// Index of the first key not less than key. The loop compiles to
+	// conditional moves, so its cost does not depend on branch prediction.
+	static int lowerBound(const Node* node, const Key& key) {
+		const Key* base = node->keys;
+		int length = node->count;
+
+		if (length == 0) {
+			return 0;
+		}
+
+		while (length > 1) {
+			int half = length / 2;
+			base = base[half - 1] < key ? base + half : base;
+			length -= half;
+		}
+
+		return static_cast<int>(base - node->keys) + (*base < key);
+	}
+
+	// Index of the first key greater than key
+	static int upperBound(const Node* node, const Key& key) {
+		const Key* base = node->keys;
+		int length = node->count;
+
+		if (length == 0) {
+			return 0;
+		}
+
+		while (length > 1) {
+			int half = length / 2;
+			base = key < base[half - 1] ? base : base + half;
+			length -= half;
+		}
+
+		return static_cast<int>(base - node->keys) + !(key < *base);
+	}
+
+	Leaf* findLeaf(const Key& key) const {
+		Node* current = root;
+
+		while (current != 0 && !current->isLeaf) {
+			current = asInner(current)->children[upperBound(current, key)];
+		}
+
+		return asLeaf(current);
+	}
+
+	Value* find(const Key& key) const {
+		Leaf* leaf = findLeaf(key);
+
+		if (leaf == 0) {
+			return 0;
+		}
+
+		int index = lowerBound(leaf, key);
+		if (index < leaf->count && !(key < leaf->keys[index])) {
+			return &leaf->values[index];
+		}
+
+		return 0;
+	}
+
+	void insertInLeaf(Leaf* leaf, int index, const Key& key, const Value& value) {
+		for (int i = leaf->count; i > index; i--) {
+			leaf->keys[i] = leaf->keys[i - 1];
+			leaf->values[i] = leaf->values[i - 1];
+		}
+		leaf->keys[index] = key;
+		leaf->values[index] = value;
+		leaf->count++;
+	}
+
+	void insertInInner(Inner* inner, int index, const Key& separator, Node* child) {
+		for (int i = inner->count; i > index; i--) {
+			inner->keys[i] = inner->keys[i - 1];
+			inner->children[i + 1] = inner->children[i];
+		}
+		inner->keys[index] = separator;
+		inner->children[index + 1] = child;
+		inner->count++;
+	}
+
+	// Inserts into the subtree of node. When node had to be split, returns
+	// the new right sibling and sets separator to its smallest key.
+	Node* insert(Node* node, const Key& key, const Value& value, Key& separator) {
+		if (node->isLeaf) {
+			Leaf* leaf = asLeaf(node);
+			int index = lowerBound(leaf, key);
+
+			if (index < leaf->count && !(key < leaf->keys[index])) {
+				leaf->values[index] = value;
+				return 0;
+			}
+
+			if (leaf->count < Capacity) {
+				insertInLeaf(leaf, index, key, value);
+				return 0;
+			}
+
+			Leaf* sibling = new Leaf();
+			int half = Capacity / 2;
+			for (int i = half; i < Capacity; i++) {
+				sibling->keys[i - half] = leaf->keys[i];
+				sibling->values[i - half] = leaf->values[i];
+			}
+			sibling->count = Capacity - half;
+			leaf->count = half;
+			sibling->next = leaf->next;
+			leaf->next = sibling;
+
+			if (index <= half) {
+				insertInLeaf(leaf, index, key, value);
+			} else {
+				insertInLeaf(sibling, index - half, key, value);
+			}
+
+			separator = sibling->keys[0];
+			return sibling;
+		}
+
+		Inner* inner = asInner(node);
+		int index = upperBound(inner, key);
+		Key childSeparator;
+		Node* newChild = insert(inner->children[index], key, value, childSeparator);
+
+		if (newChild == 0) {
+			return 0;
+		}
+
+		if (inner->count < Capacity) {
+			insertInInner(inner, index, childSeparator, newChild);
+			return 0;
+		}
+
+		// The middle key moves up, the keys after it go to the new sibling
+		Inner* sibling = new Inner();
+		int middle = Capacity / 2;
+		for (int i = middle + 1; i < Capacity; i++) {
+			sibling->keys[i - middle - 1] = inner->keys[i];
+		}
+		for (int i = middle + 1; i <= Capacity; i++) {
+			sibling->children[i - middle - 1] = inner->children[i];
+		}
+		sibling->count = Capacity - middle - 1;
+		inner->count = middle;
+		separator = inner->keys[middle];
+
+		if (index <= middle) {
+			insertInInner(inner, index, childSeparator, newChild);
+		} else {
+			insertInInner(sibling, index - middle - 1, childSeparator, newChild);
+		}
+
+		return sibling;
+	}
+
+	void removeFromLeaf(Leaf* leaf, int index) {
+		for (int i = index + 1; i < leaf->count; i++) {
+			leaf->keys[i - 1] = leaf->keys[i];
+			leaf->values[i - 1] = leaf->values[i];
+		}
+		leaf->count--;
+	}
+
+	// Removes keys[index] and children[index + 1]
+	void removeFromInner(Inner* inner, int index) {
+		for (int i = index + 1; i < inner->count; i++) {
+			inner->keys[i - 1] = inner->keys[i];
+			inner->children[i] = inner->children[i + 1];
+		}
+		inner->count--;
+	}
+
+	// Moves an entry from a sibling of parent->children[index] into it, or
+	// merges the two when neither sibling can spare one
+	void fixUnderflow(Inner* parent, int index) {
+		Node* child = parent->children[index];
+		Node* left = index > 0 ? parent->children[index - 1] : 0;
+		Node* right = index < parent->count ? parent->children[index + 1] : 0;
+
+		if (left != 0 && left->count > minKeys(left)) {
+			if (child->isLeaf) {
+				insertInLeaf(asLeaf(child), 0, left->keys[left->count - 1], asLeaf(left)->values[left->count - 1]);
+				left->count--;
+				parent->keys[index - 1] = child->keys[0];
+			} else {
+				Inner* innerChild = asInner(child);
+				for (int i = innerChild->count; i > 0; i--) {
+					innerChild->keys[i] = innerChild->keys[i - 1];
+				}
+				for (int i = innerChild->count + 1; i > 0; i--) {
+					innerChild->children[i] = innerChild->children[i - 1];
+				}
+				innerChild->keys[0] = parent->keys[index - 1];
+				innerChild->children[0] = asInner(left)->children[left->count];
+				innerChild->count++;
+				parent->keys[index - 1] = left->keys[left->count - 1];
+				left->count--;
+			}
+		} else if (right != 0 && right->count > minKeys(right)) {
+			if (child->isLeaf) {
+				insertInLeaf(asLeaf(child), child->count, right->keys[0], asLeaf(right)->values[0]);
+				removeFromLeaf(asLeaf(right), 0);
+				parent->keys[index] = right->keys[0];
+			} else {
+				Inner* innerChild = asInner(child);
+				Inner* innerRight = asInner(right);
+				innerChild->keys[innerChild->count] = parent->keys[index];
+				innerChild->children[innerChild->count + 1] = innerRight->children[0];
+				innerChild->count++;
+				parent->keys[index] = innerRight->keys[0];
+				for (int i = 1; i < innerRight->count; i++) {
+					innerRight->keys[i - 1] = innerRight->keys[i];
+				}
+				for (int i = 1; i <= innerRight->count; i++) {
+					innerRight->children[i - 1] = innerRight->children[i];
+				}
+				innerRight->count--;
+			}
+		} else {
+			int leftIndex = left != 0 ? index - 1 : index;
+			Node* into = parent->children[leftIndex];
+			Node* from = parent->children[leftIndex + 1];
+
+			if (into->isLeaf) {
+				Leaf* intoLeaf = asLeaf(into);
+				Leaf* fromLeaf = asLeaf(from);
+				for (int i = 0; i < fromLeaf->count; i++) {
+					intoLeaf->keys[intoLeaf->count + i] = fromLeaf->keys[i];
+					intoLeaf->values[intoLeaf->count + i] = fromLeaf->values[i];
+				}
+				intoLeaf->count += fromLeaf->count;
+				intoLeaf->next = fromLeaf->next;
+				delete fromLeaf;
+			} else {
+				Inner* intoInner = asInner(into);
+				Inner* fromInner = asInner(from);
+				intoInner->keys[intoInner->count] = parent->keys[leftIndex];
+				for (int i = 0; i < fromInner->count; i++) {
+					intoInner->keys[intoInner->count + 1 + i] = fromInner->keys[i];
+				}
+				for (int i = 0; i <= fromInner->count; i++) {
+					intoInner->children[intoInner->count + 1 + i] = fromInner->children[i];
+				}
+				intoInner->count += fromInner->count + 1;
+				delete fromInner;
+			}
+
+			removeFromInner(parent, leftIndex);
+		}
+	}
+
+	// Returns whether key was found and removed from the subtree of node
+	bool remove(Node* node, const Key& key) {
+		if (node->isLeaf) {
+			Leaf* leaf = asLeaf(node);
+			int index = lowerBound(leaf, key);
+
+			if (index < leaf->count && !(key < leaf->keys[index])) {
+				removeFromLeaf(leaf, index);
+				return true;
+			}
+
+			return false;
+		}
+
+		Inner* inner = asInner(node);
+		int index = upperBound(inner, key);
+		if (!remove(inner->children[index], key)) {
+			return false;
+		}
+
+		if (inner->children[index]->count < minKeys(inner->children[index])) {
+			fixUnderflow(inner, index);
+		}
+
+		return true;
+	}
+
+	void deleteTree(Node* node) {
+		if (node == 0) {
+			return;
+		}
+
+		if (node->isLeaf) {
+			delete asLeaf(node);
+		} else {
+			Inner* inner = asInner(node);
+			for (int i = 0; i <= inner->count; i++) {
+				deleteTree(inner->children[i]);
+			}
+			delete inner;
+		}
+	}
+
+	// Copies the subtree of from, linking the copied leaves through lastLeaf
+	Node* buildFromTree(const Node* from, Leaf*& lastLeaf) {
+		if (from->isLeaf) {
+			Leaf* leaf = new Leaf(*static_cast<const Leaf*>(from));
+			leaf->next = 0;
+			if (lastLeaf != 0) {
+				lastLeaf->next = leaf;
+			}
+			lastLeaf = leaf;
+
+			return leaf;
+		}
+
+		const Inner* fromInner = static_cast<const Inner*>(from);
+		Inner* inner = new Inner();
+		inner->count = fromInner->count;
+		for (int i = 0; i < fromInner->count; i++) {
+			inner->keys[i] = fromInner->keys[i];
+		}
+		for (int i = 0; i <= fromInner->count; i++) {
+			inner->children[i] = buildFromTree(fromInner->children[i], lastLeaf);
+		}
+
+		return inner;
+	}
+
+public:
+	BPlusTree()
+		: root(0) {
+	}
+
+	BPlusTree(const BPlusTree& tree)
+		: root(0) {
+		if (tree.root != 0) {
+			Leaf* lastLeaf = 0;
+			root = buildFromTree(tree.root, lastLeaf);
+		}
+	}
+
+	~BPlusTree() {
+		deleteTree(root);
+	}
+
+	void swap(BPlusTree& tree) {
+		std::swap(root, tree.root);
+	}
+
+	BPlusTree& operator=(const BPlusTree& tree) {
+		if (this != &tree) {
+			BPlusTree temp(tree);
+			swap(temp);
+		}
+
+		return *this;
+	}
+
+	bool isEmpty() const {
+		return root == 0;
+	}
+
+	void put(const Key& key, const Value& value) {
+		if (root == 0) {
+			root = new Leaf();
+		}
+
+		Key separator;
+		Node* sibling = insert(root, key, value, separator);
+
+		if (sibling != 0) {
+			Inner* newRoot = new Inner();
+			newRoot->keys[0] = separator;
+			newRoot->children[0] = root;
+			newRoot->children[1] = sibling;
+			newRoot->count = 1;
+			root = newRoot;
+		}
+	}
+
+	void remove(const Key& key) {
+		if (root == 0 || !remove(root, key)) {
+			throw std::exception();
+		}
+
+		if (root->count == 0) {
+			Node* oldRoot = root;
+			root = root->isLeaf ? 0 : asInner(root)->children[0];
+
+			if (oldRoot->isLeaf) {
+				delete asLeaf(oldRoot);
+			} else {
+				delete asInner(oldRoot);
+			}
+		}
+	}
+
+	Value get(const Key& key) const {
+		Value* value = find(key);
+
+		if (value == 0) {
+			throw std::exception();
+		}
+
+		return *value;
+	}
+
+	bool contains(const Key& key) const {
+		return find(key) != 0;
+	}
+
+	// Calls visitor(key, value) for every entry with low <= key <= high in
+	// increasing key order, walking the linked leaves
+	template <typename Visitor>
+	void forEachInRange(const Key& low, const Key& high, Visitor visitor) const {
+		Leaf* leaf = findLeaf(low);
+		int index = leaf != 0 ? lowerBound(leaf, low) : 0;
+
+		while (leaf != 0) {
+			for (; index < leaf->count; index++) {
+				if (high < leaf->keys[index]) {
+					return;
+				}
+				visitor(leaf->keys[index], leaf->values[index]);
+			}
+
+			leaf = leaf->next;
+			index = 0;
+		}
+	}
+};
+
+#endif
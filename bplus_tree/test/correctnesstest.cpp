@@ -0,0 +1,130 @@
+#include "bplustree.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+using namespace std;
+
+vector<pair<int, int> > ints;
+map<int, int> uniqueInts;
+
+void testPutAndGet() {
+	BPlusTree<int, int> t;
+
+	for (vector<pair<int, int> >::const_iterator i = ints.begin(); i != ints.end(); ++i) {
+		t.put(i->first, i->second);
+	}
+
+	for (map<int, int>::const_iterator i = uniqueInts.begin(); i != uniqueInts.end(); ++i) {
+		if (!t.contains(i->first) || t.get(i->first) != i->second) {
+			cout << "Fail on get test with number " << i->first << endl;
+		}
+	}
+
+	if (t.contains(-1)) {
+		cout << "testPutAndGet failed\n";
+	}
+}
+
+void testRemove() {
+	// A small capacity gives a deep tree and exercises every rebalancing case
+	BPlusTree<int, int, 4> t;
+	map<int, int> m;
+
+	for (int i = 0; i < 200000; i++) {
+		int key = rand() % 5000;
+
+		if (rand() % 2 == 0) {
+			t.put(key, i);
+			m[key] = i;
+		} else if (m.count(key) != 0) {
+			t.remove(key);
+			m.erase(key);
+		}
+	}
+
+	for (int key = 0; key < 5000; key++) {
+		if (t.contains(key) != (m.count(key) != 0) || (m.count(key) != 0 && t.get(key) != m[key])) {
+			cout << "Fail on remove test with number " << key << endl;
+		}
+	}
+
+	for (map<int, int>::const_iterator i = m.begin(); i != m.end(); ++i) {
+		t.remove(i->first);
+	}
+
+	if (!t.isEmpty()) {
+		cout << "testRemove failed\n";
+	}
+}
+
+struct CollectingVisitor {
+	vector<int>* keys;
+
+	CollectingVisitor(vector<int>* keys)
+		: keys(keys) {
+	}
+
+	void operator()(int key, int) {
+		keys->push_back(key);
+	}
+};
+
+void testRangeScan() {
+	BPlusTree<int, int, 8> t;
+
+	for (map<int, int>::const_iterator i = uniqueInts.begin(); i != uniqueInts.end(); ++i) {
+		t.put(i->first, i->second);
+	}
+
+	int low = RAND_MAX / 4;
+	int high = RAND_MAX / 2;
+	vector<int> keys;
+	t.forEachInRange(low, high, CollectingVisitor(&keys));
+
+	vector<int>::const_iterator k = keys.begin();
+	for (map<int, int>::const_iterator i = uniqueInts.lower_bound(low); i != uniqueInts.end() && i->first <= high; ++i, ++k) {
+		if (k == keys.end() || *k != i->first) {
+			cout << "testRangeScan failed\n";
+			return;
+		}
+	}
+
+	if (k != keys.end()) {
+		cout << "testRangeScan failed\n";
+	}
+}
+
+void testCopy() {
+	BPlusTree<int, int> t;
+
+	for (map<int, int>::const_iterator i = uniqueInts.begin(); i != uniqueInts.end(); ++i) {
+		t.put(i->first, i->second);
+	}
+
+	BPlusTree<int, int> t2;
+	t2 = t;
+	t.remove(uniqueInts.begin()->first);
+
+	for (map<int, int>::const_iterator i = uniqueInts.begin(); i != uniqueInts.end(); ++i) {
+		if (t2.get(i->first) != i->second) {
+			cout << "Fail on copy test with number " << i->first << endl;
+		}
+	}
+}
+
+int main() {
+	for (int i = 0; i < 1000000; i++) {
+		int a = rand();
+		int b = rand();
+		ints.push_back(make_pair(a, b));
+		uniqueInts[a] = b;
+	}
+
+	testPutAndGet();
+	testRemove();
+	testRangeScan();
+	testCopy();
+
+	return 0;
+}
@@ -0,0 +1,79 @@
+#include "bplustree.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000, 10000000};
+
+vector<int> sequentialKeys;
+vector<int> randomKeys;
+
+// Adapts std::map to the put/get interface of the trees
+class StdMap {
+	map<int, int> m;
+public:
+	void put(int key, int value) {
+		m[key] = value;
+	}
+
+	int get(int key) {
+		return m.find(key)->second;
+	}
+};
+
+template <typename Tree>
+void testTree(const char* name, const vector<int>& keys, size_t count) {
+	Tree* tree = new Tree();
+
+	clock_t initial = clock();
+	for (size_t i = 0; i < count; i++) {
+		tree->put(keys[i], static_cast<int>(i));
+	}
+	clock_t afterPut = clock();
+
+	long long sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		sum += tree->get(keys[(i * 7919) % count]);
+	}
+	clock_t afterGet = clock();
+
+	delete tree;
+
+	cout << name << " put " << (afterPut - initial) * 1000 / CLOCKS_PER_SEC << "ms get "
+		<< (afterGet - afterPut) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+void testAll(const vector<int>& keys, size_t count) {
+	testTree<BPlusTree<int, int> >("BPlusTree   ", keys, count);
+	testTree<AATree<int, int> >("AATree      ", keys, count);
+	testTree<RedBlackTree<int, int> >("RedBlackTree", keys, count);
+	testTree<StdMap>("std::map    ", keys, count);
+}
+
+int main() {
+	int maxSize = TEST_SIZES[sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]) - 1];
+
+	for (int i = 0; i < maxSize; i++) {
+		sequentialKeys.push_back(i);
+	}
+	randomKeys = sequentialKeys;
+	random_shuffle(randomKeys.begin(), randomKeys.end());
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		cout << "Sequential keys, size " << TEST_SIZES[i] << endl;
+		testAll(sequentialKeys, TEST_SIZES[i]);
+		cout << endl;
+
+		cout << "Random keys, size " << TEST_SIZES[i] << endl;
+		testAll(randomKeys, TEST_SIZES[i]);
+		cout << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,309 @@
+#ifndef CONCURRENTORDEREDMAP_H
+#define CONCURRENTORDEREDMAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "../../redblack_tree/src/persistentredblacktree.h"
+
+// Ordered map that many threads may use at once. The key space is split
+// into ranges at splitter keys, and every range is a separate persistent
+// red-black tree:
+//  - Readers load the current version of a range from a plain atomic
+//    pointer and search it without taking any lock, retrying or touching a
+//    shared reference count; versions are immutable once published.
+//  - Writers to the same range serialize on its mutex, derive the next
+//    version by path copying and publish it. Writers to different ranges do
+//    not contend at all.
+// Replaced versions are freed by epoch-based reclamation: a reader announces
+// the global epoch in a slot of its own while it searches, and a writer
+// frees a version only once every announced epoch is newer than the moment
+// it was replaced.
+// put, get, contains and remove are linearizable: every one of them acts on
+// the single version of its range that is current at one instant.
+template <typename Key, typename Value>
+class ConcurrentOrderedMap {
+	typedef PersistentRedBlackTree<Key, Value> Tree;
+
+	// Writers look for versions to free after this many replacements in a
+	// partition
+	static const std::size_t RECLAIM_BATCH = 64;
+	// Reader slots are allocated in blocks of this many
+	static const int SLOT_BLOCK = 256;
+	// The announced epoch of a slot that is not reading
+	static const unsigned long long IDLE = std::numeric_limits<unsigned long long>::max();
+
+	// On its own cache line, so a write to one range does not evict the
+	// pointer of its neighbours from the caches of their readers
+	struct alignas(64) Partition {
+		std::mutex writeMutex;
+		std::atomic<const Tree*> current;
+		// Replaced versions with the epoch they were replaced in, guarded by
+		// writeMutex
+		std::vector<std::pair<const Tree*, unsigned long long> > retired;
+
+		Partition()
+			: current(new Tree()) {
+		}
+
+		~Partition() {
+			delete current.load();
+			for (std::size_t i = 0; i < retired.size(); i++) {
+				delete retired[i].first;
+			}
+		}
+	};
+
+	struct alignas(64) ReaderSlot {
+		std::atomic<unsigned long long> epoch;
+
+		ReaderSlot()
+			: epoch(IDLE) {
+		}
+	};
+
+	// Blocks are chained and only ever appended, so writers can walk them
+	// without a lock
+	struct ReaderSlotBlock {
+		ReaderSlot slots[SLOT_BLOCK];
+		std::atomic<ReaderSlotBlock*> next;
+
+		ReaderSlotBlock()
+			: next(0) {
+		}
+
+		~ReaderSlotBlock() {
+			delete next.load();
+		}
+	};
+
+	// Hands every thread that reads a slot index, unique among the live
+	// threads and reused after they exit
+	class ReaderIndices {
+		std::mutex mutex;
+		std::vector<int> released;
+		int used;
+
+		ReaderIndices()
+			: used(0) {
+		}
+
+		static ReaderIndices& instance() {
+			static ReaderIndices indices;
+			return indices;
+		}
+
+		struct Registration {
+			int index;
+
+			Registration() {
+				ReaderIndices& indices = instance();
+				std::lock_guard<std::mutex> lock(indices.mutex);
+
+				if (!indices.released.empty()) {
+					index = indices.released.back();
+					indices.released.pop_back();
+				} else {
+					index = indices.used++;
+				}
+			}
+
+			~Registration() {
+				ReaderIndices& indices = instance();
+				std::lock_guard<std::mutex> lock(indices.mutex);
+				indices.released.push_back(index);
+			}
+		};
+
+	public:
+		static int current() {
+			static thread_local Registration registration;
+			return registration.index;
+		}
+	};
+
+	// Keeps the versions the calling thread can reach alive until it goes
+	// out of scope
+	class ReadGuard {
+		std::atomic<unsigned long long>& slot;
+
+		ReadGuard(const ReadGuard&);
+		ReadGuard& operator=(const ReadGuard&);
+
+	public:
+		explicit ReadGuard(const ConcurrentOrderedMap& map)
+			: slot(map.readerSlot(ReaderIndices::current())) {
+			slot.store(map.epoch.load());
+		}
+
+		~ReadGuard() {
+			slot.store(IDLE, std::memory_order_release);
+		}
+	};
+
+	std::vector<Key> splitters;
+	std::unique_ptr<Partition[]> partitions;
+	std::unique_ptr<ReaderSlotBlock> readerSlots;
+	// Guards appending slot blocks
+	mutable std::mutex slotsMutex;
+	std::atomic<unsigned long long> epoch;
+
+	// Partition i holds the keys in [splitters[i - 1], splitters[i])
+	Partition& partitionFor(const Key& key) const {
+		return partitions[std::upper_bound(splitters.begin(), splitters.end(), key) - splitters.begin()];
+	}
+
+	// Evenly spaced quantiles of the sorted, deduplicated sample
+	static std::vector<Key> splittersOf(std::vector<Key> sample, std::size_t partitionCount) {
+		std::sort(sample.begin(), sample.end());
+		sample.erase(std::unique(sample.begin(), sample.end()), sample.end());
+
+		std::vector<Key> result;
+		for (std::size_t i = 1; i < partitionCount && i < sample.size(); i++) {
+			const Key& splitter = sample[i * sample.size() / partitionCount];
+			if (result.empty() || result.back() < splitter) {
+				result.push_back(splitter);
+			}
+		}
+
+		return result;
+	}
+
+	// Appends the blocks up to the one holding index if they are missing
+	std::atomic<unsigned long long>& readerSlot(int index) const {
+		ReaderSlotBlock* block = readerSlots.get();
+		for (; index >= SLOT_BLOCK; index -= SLOT_BLOCK) {
+			ReaderSlotBlock* next = block->next.load();
+
+			if (next == 0) {
+				std::lock_guard<std::mutex> lock(slotsMutex);
+				next = block->next.load();
+
+				if (next == 0) {
+					next = new ReaderSlotBlock();
+					block->next.store(next);
+				}
+			}
+
+			block = next;
+		}
+
+		return block->slots[index].epoch;
+	}
+
+	// The oldest epoch a reader is searching in, IDLE if none is
+	unsigned long long oldestReader() const {
+		unsigned long long result = IDLE;
+		for (const ReaderSlotBlock* block = readerSlots.get(); block != 0; block = block->next.load()) {
+			for (int i = 0; i < SLOT_BLOCK; i++) {
+				result = std::min(result, block->slots[i].epoch.load());
+			}
+		}
+
+		return result;
+	}
+
+	// Frees the replaced versions of the partition that no reader can still
+	// reach. The partition must be locked.
+	void reclaim(Partition& partition) {
+		epoch.fetch_add(1);
+		unsigned long long oldest = oldestReader();
+
+		std::size_t kept = 0;
+		for (std::size_t i = 0; i < partition.retired.size(); i++) {
+			if (partition.retired[i].second < oldest) {
+				delete partition.retired[i].first;
+			} else {
+				partition.retired[kept++] = partition.retired[i];
+			}
+		}
+		partition.retired.resize(kept);
+	}
+
+	// The partition must be locked
+	void publish(Partition& partition, std::unique_ptr<Tree>& next) {
+		const Tree* previous = partition.current.exchange(next.release());
+		partition.retired.push_back(std::make_pair(previous, epoch.load()));
+
+		if (partition.retired.size() >= RECLAIM_BATCH) {
+			reclaim(partition);
+		}
+	}
+
+	ConcurrentOrderedMap(const ConcurrentOrderedMap&);
+	ConcurrentOrderedMap& operator=(const ConcurrentOrderedMap&);
+
+public:
+	// splitters must be sorted. Spreading them so the partitions get similar
+	// traffic lets that many writers proceed in parallel; with no splitters
+	// every writer takes the same lock.
+	explicit ConcurrentOrderedMap(const std::vector<Key>& splitters)
+		: splitters(splitters), partitions(new Partition[splitters.size() + 1]),
+			readerSlots(new ReaderSlotBlock()), epoch(0) {
+	}
+
+	// Splits the key space into up to partitionCount ranges holding similar
+	// numbers of the keys in sample, which should be drawn like the keys the
+	// map will be used with
+	ConcurrentOrderedMap(const std::vector<Key>& sample, std::size_t partitionCount)
+		: splitters(splittersOf(sample, partitionCount)), partitions(new Partition[splitters.size() + 1]),
+			readerSlots(new ReaderSlotBlock()), epoch(0) {
+	}
+
+	std::size_t getPartitionCount() const {
+		return splitters.size() + 1;
+	}
+
+	void put(const Key& key, const Value& value) {
+		Partition& partition = partitionFor(key);
+		std::lock_guard<std::mutex> lock(partition.writeMutex);
+
+		std::unique_ptr<Tree> next(new Tree(*partition.current.load()));
+		next->put(key, value);
+		publish(partition, next);
+	}
+
+	void remove(const Key& key) {
+		Partition& partition = partitionFor(key);
+		std::lock_guard<std::mutex> lock(partition.writeMutex);
+
+		if (!partition.current.load()->contains(key)) {
+			throw std::exception();
+		}
+
+		std::unique_ptr<Tree> next(new Tree(*partition.current.load()));
+		next->remove(key);
+		publish(partition, next);
+	}
+
+	Value get(const Key& key) const {
+		ReadGuard guard(*this);
+		return partitionFor(key).current.load()->get(key);
+	}
+
+	bool contains(const Key& key) const {
+		ReadGuard guard(*this);
+		return partitionFor(key).current.load()->contains(key);
+	}
+
+	// Checks the partitions one after another, so with concurrent writers the
+	// answer need not match any single instant
+	bool isEmpty() const {
+		ReadGuard guard(*this);
+		for (std::size_t i = 0; i <= splitters.size(); i++) {
+			if (!partitions[i].current.load()->isEmpty()) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,201 @@
+#include "concurrentorderedmap.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int WRITERS = 4;
+const int READERS = 4;
+const int KEY_RANGE = 20000;
+
+// Every writer owns the keys congruent to its index, so it knows exactly
+// what the map must hold for them
+void write(ConcurrentOrderedMap<int, int>* m, int index, bool* failed) {
+	mt19937 random(index);
+	map<int, int> expected;
+
+	for (int i = 0; i < 50000; i++) {
+		int key = (random() % (KEY_RANGE / WRITERS)) * WRITERS + index;
+
+		if (random() % 3 == 0 && expected.count(key) != 0) {
+			m->remove(key);
+			expected.erase(key);
+		} else {
+			m->put(key, i);
+			expected[key] = i;
+		}
+	}
+
+	for (int key = index; key < KEY_RANGE; key += WRITERS) {
+		map<int, int>::const_iterator i = expected.find(key);
+
+		if (m->contains(key) != (i != expected.end()) || (i != expected.end() && m->get(key) != i->second)) {
+			*failed = true;
+		}
+	}
+}
+
+void read(ConcurrentOrderedMap<int, int>* m, atomic<bool>* stop, long long* found) {
+	mt19937 random(WRITERS);
+	long long count = 0;
+
+	while (!stop->load()) {
+		int key = random() % KEY_RANGE;
+
+		if (m->contains(key)) {
+			count++;
+		}
+	}
+
+	*found = count;
+}
+
+void testConcurrentUpdates(ConcurrentOrderedMap<int, int>& m) {
+	vector<thread> writers;
+	vector<thread> readers;
+	bool failed[WRITERS] = {false};
+	long long found[READERS];
+	atomic<bool> stop(false);
+
+	for (int i = 0; i < READERS; i++) {
+		readers.push_back(thread(read, &m, &stop, &found[i]));
+	}
+	for (int i = 0; i < WRITERS; i++) {
+		writers.push_back(thread(write, &m, i, &failed[i]));
+	}
+
+	for (int i = 0; i < WRITERS; i++) {
+		writers[i].join();
+
+		if (failed[i]) {
+			cout << "Fail on concurrent updates test with writer " << i << endl;
+		}
+	}
+
+	stop.store(true);
+	for (int i = 0; i < READERS; i++) {
+		readers[i].join();
+	}
+}
+
+void testEmpty() {
+	vector<int> splitters;
+	splitters.push_back(10);
+	splitters.push_back(20);
+	ConcurrentOrderedMap<int, int> m(splitters);
+
+	m.put(15, 1);
+	m.put(25, 2);
+	m.remove(15);
+	m.remove(25);
+
+	if (!m.isEmpty() || m.contains(15)) {
+		cout << "testEmpty failed\n";
+	}
+}
+
+// Partitions derived from a sample split it evenly, and repeated sample keys
+// give fewer of them
+void testSampledPartitions() {
+	vector<int> sample;
+	for (int i = 0; i < 1000; i++) {
+		sample.push_back(i);
+	}
+	shuffle(sample.begin(), sample.end(), mt19937(1));
+
+	ConcurrentOrderedMap<int, int> m(sample, 16);
+	if (m.getPartitionCount() != 16) {
+		cout << "Fail on sampled partitions test" << endl;
+	}
+
+	vector<int> repeated(100, 7);
+	repeated.push_back(3);
+	ConcurrentOrderedMap<int, int> few(repeated, 16);
+	if (few.getPartitionCount() != 2) {
+		cout << "Fail on repeated sample partitions test" << endl;
+	}
+
+	few.put(3, 1);
+	few.put(7, 2);
+	few.put(100, 3);
+	if (few.get(3) != 1 || few.get(7) != 2 || few.get(100) != 3) {
+		cout << "Fail on repeated sample lookup test" << endl;
+	}
+
+	ConcurrentOrderedMap<int, int> none(vector<int>(), 16);
+	none.put(1, 1);
+	if (none.getPartitionCount() != 1 || none.get(1) != 1) {
+		cout << "Fail on empty sample test" << endl;
+	}
+}
+
+// Stays alive until all the readers have read, so each holds its own slot
+void readOnce(ConcurrentOrderedMap<int, int>* m, atomic<int>* done, int readers, bool* failed) {
+	try {
+		if (!m->contains(1) || m->get(1) != 1) {
+			*failed = true;
+		}
+	} catch (const exception&) {
+		*failed = true;
+	}
+
+	done->fetch_add(1);
+	while (done->load() < readers) {
+		this_thread::yield();
+	}
+}
+
+// More threads read at once than fit in one block of reader slots
+void testManyReaders() {
+	const int MANY_READERS = 300;
+	ConcurrentOrderedMap<int, int> m((vector<int>()));
+	m.put(1, 1);
+
+	vector<thread> readers;
+	bool failed[MANY_READERS] = {false};
+	atomic<int> done(0);
+	for (int i = 0; i < MANY_READERS; i++) {
+		readers.push_back(thread(readOnce, &m, &done, MANY_READERS, &failed[i]));
+	}
+	for (int i = 0; i < MANY_READERS; i++) {
+		readers[i].join();
+	}
+
+	for (int i = 0; i < 1000; i++) {
+		m.put(i, i);
+	}
+
+	if (find(failed, failed + MANY_READERS, true) != failed + MANY_READERS || m.get(999) != 999) {
+		cout << "Fail on many readers test" << endl;
+	}
+}
+
+int main() {
+	vector<int> splitters;
+	for (int i = 1; i < 16; i++) {
+		splitters.push_back(i * KEY_RANGE / 16);
+	}
+
+	vector<int> sample;
+	for (int i = 0; i < 1000; i++) {
+		sample.push_back(rand() % KEY_RANGE);
+	}
+
+	ConcurrentOrderedMap<int, int> single((vector<int>()));
+	ConcurrentOrderedMap<int, int> split(splitters);
+	ConcurrentOrderedMap<int, int> sampled(sample, 16);
+	testConcurrentUpdates(single);
+	testConcurrentUpdates(split);
+	testConcurrentUpdates(sampled);
+	testEmpty();
+	testSampledPartitions();
+	testManyReaders();
+
+	return 0;
+}
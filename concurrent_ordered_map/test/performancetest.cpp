@@ -0,0 +1,121 @@
+#include "concurrentorderedmap.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int THREAD_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+const int READ_PERCENTAGES[] = {100, 95, 80, 50};
+const int KEY_RANGE = 1000000;
+const int OPERATIONS = 2000000;
+const int PARTITIONS = 64;
+
+// The baselines: one tree behind a single mutex or reader-writer lock
+class GlobalMutexMap {
+	RedBlackTree<int, int> tree;
+	mutex treeMutex;
+public:
+	void put(int key, int value) {
+		lock_guard<mutex> lock(treeMutex);
+		tree.put(key, value);
+	}
+
+	bool contains(int key) {
+		lock_guard<mutex> lock(treeMutex);
+		return tree.contains(key);
+	}
+};
+
+class GlobalReaderWriterLockMap {
+	RedBlackTree<int, int> tree;
+	shared_mutex treeMutex;
+public:
+	void put(int key, int value) {
+		unique_lock<shared_mutex> lock(treeMutex);
+		tree.put(key, value);
+	}
+
+	bool contains(int key) {
+		shared_lock<shared_mutex> lock(treeMutex);
+		return tree.contains(key);
+	}
+};
+
+template <typename Map>
+void work(Map* map, int operations, int readPercentage, unsigned seed, long long* found) {
+	mt19937 random(seed);
+	long long count = 0;
+
+	for (int i = 0; i < operations; i++) {
+		int key = random() % KEY_RANGE;
+
+		if (static_cast<int>(random() % 100) < readPercentage) {
+			count += map->contains(key);
+		} else {
+			map->put(key, i);
+		}
+	}
+
+	*found = count;
+}
+
+template <typename Map>
+void testMap(const char* name, Map& map, int threads, int readPercentage) {
+	vector<thread> workers;
+	vector<long long> found(threads);
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	for (int i = 0; i < threads; i++) {
+		workers.push_back(thread(work<Map>, &map, OPERATIONS / threads, readPercentage, i + 1, &found[i]));
+	}
+	for (int i = 0; i < threads; i++) {
+		workers[i].join();
+	}
+	chrono::steady_clock::time_point current = chrono::steady_clock::now();
+
+	double seconds = chrono::duration<double>(current - initial).count();
+	cout << name << " " << static_cast<long long>(OPERATIONS / seconds) << " ops/s" << endl;
+}
+
+template <typename Map>
+void prefill(Map& map) {
+	for (int key = 0; key < KEY_RANGE; key += 2) {
+		map.put(key, key);
+	}
+}
+
+int main() {
+	vector<int> splitters;
+	for (int i = 1; i < PARTITIONS; i++) {
+		splitters.push_back(i * (KEY_RANGE / PARTITIONS));
+	}
+
+	for (size_t r = 0; r < sizeof(READ_PERCENTAGES)/sizeof(READ_PERCENTAGES[0]); r++) {
+		for (size_t t = 0; t < sizeof(THREAD_COUNTS)/sizeof(THREAD_COUNTS[0]); t++) {
+			cout << "Testing " << READ_PERCENTAGES[r] << "% reads with " << THREAD_COUNTS[t] << " threads" << endl;
+
+			ConcurrentOrderedMap<int, int> concurrentMap(splitters);
+			ConcurrentOrderedMap<int, int> singleMap((vector<int>()));
+			GlobalMutexMap mutexMap;
+			GlobalReaderWriterLockMap readerWriterMap;
+			prefill(concurrentMap);
+			prefill(singleMap);
+			prefill(mutexMap);
+			prefill(readerWriterMap);
+
+			testMap("ConcurrentOrderedMap  ", concurrentMap, THREAD_COUNTS[t], READ_PERCENTAGES[r]);
+			testMap("One partition         ", singleMap, THREAD_COUNTS[t], READ_PERCENTAGES[r]);
+			testMap("Global mutex          ", mutexMap, THREAD_COUNTS[t], READ_PERCENTAGES[r]);
+			testMap("Global readers-writer ", readerWriterMap, THREAD_COUNTS[t], READ_PERCENTAGES[r]);
+			cout << endl;
+		}
+	}
+
+	return 0;
+}
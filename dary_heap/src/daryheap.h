@@ -0,0 +1,274 @@
+#ifndef DARYHEAP_H
+#define DARYHEAP_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../fibonacci_heap/src/poolallocator.h"
+
+// Implicit min heap in which every node has Arity children, with the
+// interface of FibonacciHeap. The keys sit in one array, so sifting walks
+// adjacent memory; a wider node makes the heap shallower for insert and
+// decreaseKey at the cost of more comparisons per level in extractMin.
+// insert and decreaseKey take O(log n / log Arity), extractMin and remove
+// O(Arity log n / log Arity).
+//
+// Every element has a handle, allocated with Allocator<Handle> (see
+// poolallocator.h), that tracks its position in the array, so Elements stay
+// valid while entries move.
+template <typename Key, int Arity = 4, template <typename> class Allocator = PoolAllocator>
+class DaryHeap {
+	struct Handle {
+		std::size_t index;
+		Key key;
+
+		Handle(std::size_t index, const Key& key)
+			: index(index), key(key) {
+		}
+	};
+
+	// A copy of the key of the handle, so sifting compares keys without
+	// following the handles
+	struct Entry {
+		Key key;
+		Handle* handle;
+	};
+
+	std::vector<Entry> entries;
+	Allocator<Handle> allocator;
+
+	Handle* createHandle(std::size_t index, const Key& key) {
+		Handle* handle = allocator.allocate();
+
+		try {
+			return new (handle) Handle(index, key);
+		} catch (...) {
+			allocator.deallocate(handle);
+			throw;
+		}
+	}
+
+	void destroyHandle(Handle* handle) {
+		handle->~Handle();
+		allocator.deallocate(handle);
+	}
+
+	void place(std::size_t index, Entry& entry) {
+		entry.handle->index = index;
+		entries[index] = std::move(entry);
+	}
+
+	// Moves the entry at index up until its parent is not greater
+	void siftUp(std::size_t index) {
+		Entry entry = std::move(entries[index]);
+
+		while (index > 0) {
+			std::size_t parent = (index - 1) / Arity;
+			if (!(entry.key < entries[parent].key)) {
+				break;
+			}
+
+			place(index, entries[parent]);
+			index = parent;
+		}
+
+		place(index, entry);
+	}
+
+	// Moves the entry at index down until no child is smaller
+	void siftDown(std::size_t index) {
+		std::size_t count = entries.size();
+		Entry entry = std::move(entries[index]);
+
+		for (;;) {
+			std::size_t firstChild = index * Arity + 1;
+			if (firstChild >= count) {
+				break;
+			}
+
+			std::size_t lastChild = firstChild + Arity < count ? firstChild + Arity : count;
+			std::size_t minChild = firstChild;
+			for (std::size_t child = firstChild + 1; child < lastChild; child++) {
+				if (entries[child].key < entries[minChild].key) {
+					minChild = child;
+				}
+			}
+
+			if (!(entries[minChild].key < entry.key)) {
+				break;
+			}
+
+			place(index, entries[minChild]);
+			index = minChild;
+		}
+
+		place(index, entry);
+	}
+
+	// Removes the entry at index and destroys its handle
+	void removeAt(std::size_t index) {
+		destroyHandle(entries[index].handle);
+
+		std::size_t last = entries.size() - 1;
+		if (index != last) {
+			bool isSmaller = entries[last].key < entries[index].key;
+			place(index, entries[last]);
+			entries.pop_back();
+
+			if (isSmaller) {
+				siftUp(index);
+			} else {
+				siftDown(index);
+			}
+		} else {
+			entries.pop_back();
+		}
+	}
+
+	void deleteHandles() {
+		for (std::size_t i = 0; i < entries.size(); i++) {
+			destroyHandle(entries[i].handle);
+		}
+		entries.clear();
+	}
+
+public:
+	class Element {
+		Handle* handle;
+
+		Element(Handle* handle)
+			: handle(handle) {
+		}
+	public:
+		// An element of no heap, to be assigned later
+		Element()
+			: handle(0) {
+		}
+
+		const Key& getKey() const {
+			return handle->key;
+		}
+
+	friend class DaryHeap;
+	};
+
+	DaryHeap() {
+	}
+
+	// A pooling allocator frees all handles at once, so they are only
+	// visited when their keys need destroying
+	~DaryHeap() {
+		if (!Allocator<Handle>::OWNS_STORAGE || !std::is_trivially_destructible<Key>::value) {
+			deleteHandles();
+		}
+	}
+
+	DaryHeap(const DaryHeap& heap) {
+		entries.reserve(heap.entries.size());
+
+		try {
+			for (std::size_t i = 0; i < heap.entries.size(); i++) {
+				Entry entry = { heap.entries[i].key, createHandle(i, heap.entries[i].key) };
+				entries.push_back(entry);
+			}
+		} catch (...) {
+			deleteHandles();
+			throw;
+		}
+	}
+
+	void swap(DaryHeap& heap) {
+		entries.swap(heap.entries);
+		allocator.swap(heap.allocator);
+	}
+
+	DaryHeap& operator=(const DaryHeap& heap) {
+		if (this != &heap) {
+			DaryHeap temp(heap);
+			swap(temp);
+		}
+
+		return *this;
+	}
+
+	Element insert(const Key& key) {
+		Handle* handle = createHandle(entries.size(), key);
+		Entry entry = { key, handle };
+
+		try {
+			entries.push_back(entry);
+		} catch (...) {
+			destroyHandle(handle);
+			throw;
+		}
+		siftUp(entries.size() - 1);
+
+		return Element(handle);
+	}
+
+	Element getMinElement() const {
+		return Element(entries.empty() ? 0 : entries[0].handle);
+	}
+
+	const Key& getMin() const {
+		return entries[0].key;
+	}
+
+	// Moves the elements of heap, whose Elements stay valid, to this heap.
+	// Restores the heap order bottom-up in O(n + m) when heap is the larger
+	// one and sifts up its entries in O(m log n) otherwise.
+	void mergeWith(DaryHeap& heap) {
+		std::size_t oldCount = entries.size();
+		std::size_t addedCount = heap.entries.size();
+
+		entries.reserve(oldCount + addedCount);
+		for (std::size_t i = 0; i < addedCount; i++) {
+			entries.push_back(std::move(heap.entries[i]));
+			entries.back().handle->index = oldCount + i;
+		}
+		heap.entries.clear();
+		allocator.absorb(heap.allocator);
+
+		if (addedCount >= oldCount) {
+			if (entries.size() > 1) {
+				for (std::size_t i = (entries.size() - 2) / Arity + 1; i-- > 0;) {
+					siftDown(i);
+				}
+			}
+		} else {
+			for (std::size_t i = oldCount; i < entries.size(); i++) {
+				siftUp(i);
+			}
+		}
+	}
+
+	bool isEmpty() const {
+		return entries.empty();
+	}
+
+	std::size_t getSize() const {
+		return entries.size();
+	}
+
+	void extractMin() {
+		removeAt(0);
+	}
+
+	// newKey must not be greater than the key of element
+	void decreaseKey(Element element, const Key& newKey) {
+		Handle* handle = element.handle;
+
+		handle->key = newKey;
+		entries[handle->index].key = newKey;
+		siftUp(handle->index);
+	}
+
+	void remove(Element element) {
+		removeAt(element.handle->index);
+	}
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "daryheap.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int ROUNDS = 200;
+const int KEY_RANGE = 100000;
+
+// Inserts, extracts, decreases and removes random elements, and merges in
+// and copies whole heaps, comparing every minimum with a multiset. When
+// monotone is set, no key is ever below the last extracted minimum.
+template <typename Heap>
+void testAgainstMultiset(const char* name, bool monotone) {
+	Heap heap;
+	multiset<int> expected;
+	vector<typename Heap::Element> elements;
+	vector<bool> isAlive;
+	// Elements by the address of their key, which stays put
+	map<const int*, size_t> indexOf;
+	int lastExtracted = 0;
+
+	for (int round = 0; round < ROUNDS; round++) {
+		Heap other;
+		for (int i = 0; i < 500; i++) {
+			int key = (monotone ? lastExtracted : 0) + rand() % KEY_RANGE;
+			elements.push_back(i % 4 == 0 ? other.insert(key) : heap.insert(key));
+			isAlive.push_back(true);
+			indexOf[&elements.back().getKey()] = elements.size() - 1;
+			expected.insert(key);
+		}
+		heap.mergeWith(other);
+
+		for (int i = 0; i < 300; i++) {
+			size_t index = rand() % elements.size();
+			if (!isAlive[index]) {
+				continue;
+			}
+
+			int key = elements[index].getKey();
+			expected.erase(expected.find(key));
+
+			if (rand() % 5 == 0) {
+				indexOf.erase(&elements[index].getKey());
+				heap.remove(elements[index]);
+				isAlive[index] = false;
+			} else {
+				int lowest = monotone ? lastExtracted : 0;
+				int newKey = lowest + rand() % (key - lowest + 1);
+				heap.decreaseKey(elements[index], newKey);
+				expected.insert(newKey);
+			}
+		}
+
+		for (int i = 0; i < 200 && !expected.empty(); i++) {
+			if (heap.getMin() != *expected.begin() || heap.getMinElement().getKey() != *expected.begin()) {
+				cout << "Fail on " << name << " minimum test" << endl;
+				return;
+			}
+
+			map<const int*, size_t>::iterator extracted = indexOf.find(&heap.getMinElement().getKey());
+			if (extracted == indexOf.end()) {
+				cout << "Fail on " << name << " getMinElement test" << endl;
+				return;
+			}
+			isAlive[extracted->second] = false;
+			indexOf.erase(extracted);
+
+			lastExtracted = heap.getMin();
+			expected.erase(expected.begin());
+			heap.extractMin();
+		}
+
+		if (heap.getSize() != expected.size()) {
+			cout << "Fail on " << name << " size test" << endl;
+			return;
+		}
+	}
+
+	Heap copy(heap);
+	copy = heap;
+	while (!expected.empty()) {
+		if (heap.getMin() != *expected.begin() || copy.getMin() != *expected.begin()) {
+			cout << "Fail on " << name << " drain test" << endl;
+			return;
+		}
+
+		expected.erase(expected.begin());
+		heap.extractMin();
+		copy.extractMin();
+	}
+
+	if (!heap.isEmpty() || !copy.isEmpty()) {
+		cout << "Fail on " << name << " empty test" << endl;
+	}
+}
+
+void testStringKeys() {
+	DaryHeap<string> heap;
+	multiset<string> expected;
+
+	for (int i = 0; i < 10000; i++) {
+		string key(1 + rand() % 30, 'a' + rand() % 26);
+		heap.insert(key);
+		expected.insert(key);
+	}
+
+	for (int i = 0; i < 5000; i++) {
+		if (heap.getMin() != *expected.begin()) {
+			cout << "Fail on string key test" << endl;
+			return;
+		}
+
+		heap.extractMin();
+		expected.erase(expected.begin());
+	}
+}
+
+int main() {
+	testAgainstMultiset<DaryHeap<int> >("DaryHeap", false);
+	testAgainstMultiset<DaryHeap<int, 2> >("DaryHeap with arity 2", false);
+	testAgainstMultiset<DaryHeap<int, 8, NewDeleteAllocator> >("DaryHeap with arity 8", false);
+	testStringKeys();
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+#ifndef EYTZINGER_H
+#define EYTZINGER_H
+
+#include <cstddef>
+#include <exception>
+#include <vector>
+
+#include "../../key_compare/src/keycompare.h"
+
+// Immutable sorted map stored in Eytzinger (breadth-first) order: the
+// children of position k are 2k and 2k + 1. A search touches the array
+// top-down with no pointers to chase and always takes the same number of
+// steps, so the loop needs no unpredictable branches and the descendants a
+// few levels below can be prefetched. Keys and values are kept in separate
+// arrays so a search only brings keys into the cache.
+//
+// Keys are ordered by the Compare policy (see keycompare.h) of the tree the
+// snapshot is taken from. A search computes the cache of the key it looks
+// for once and that of every visited key on the fly, since the caches are
+// not stored.
+//
+// Nothing is modified after construction, so any number of threads may
+// query one snapshot concurrently.
+template <typename Key, typename Value, typename Compare = ThreeWayCompare<Key> >
+class EytzingerSnapshot {
+	typedef typename Compare::Cache KeyCache;
+
+	// keys[0] and values[0] are unused, which makes 0 free to mean "not found"
+	std::vector<Key> keys;
+	std::vector<Value> values;
+	std::size_t size;
+
+	// Distance in positions to the descendants that are prefetched: all the
+	// descendants log2(PREFETCH_STRIDE) levels down share one cache line
+	static const std::size_t PREFETCH_STRIDE = sizeof(Key) >= 64 ? 1 : 64 / sizeof(Key);
+
+	template <typename RandomAccessIterator>
+	void fill(std::size_t position, RandomAccessIterator& current) {
+		if (position > size) {
+			return;
+		}
+
+		fill(2 * position, current);
+		keys[position] = current->first;
+		values[position] = current->second;
+		++current;
+		fill(2 * position + 1, current);
+	}
+
+	void prefetch(std::size_t position) const {
+#ifdef __GNUC__
+		if (position < keys.size()) {
+			__builtin_prefetch(&keys[position]);
+		}
+#endif
+	}
+
+	static bool isLess(const Key& first, const KeyCache& firstCache, const Key& second, const KeyCache& secondCache) {
+		return Compare::compare(first, firstCache, second, secondCache) < 0;
+	}
+
+	std::size_t lowerBoundPosition(const Key& key, const KeyCache& keyCache) const {
+		std::size_t position = 1;
+
+		while (position <= size) {
+			prefetch(position * PREFETCH_STRIDE);
+			position = 2 * position + isLess(keys[position], Compare::cache(keys[position]), key, keyCache);
+		}
+
+		// The answer is the last node where the search went left. Going left
+		// appends a 0 bit, so drop the trailing 1 bits and one more.
+#ifdef __GNUC__
+		return position >> (__builtin_ctzll(~static_cast<unsigned long long>(position)) + 1);
+#else
+		while (position & 1) {
+			position >>= 1;
+		}
+		return position >> 1;
+#endif
+	}
+
+public:
+	EytzingerSnapshot()
+		: size(0) {
+	}
+
+	// Builds a snapshot from the (key, value) pairs of [first, last), whose
+	// keys must be strictly increasing
+	template <typename RandomAccessIterator>
+	EytzingerSnapshot(RandomAccessIterator first, RandomAccessIterator last)
+		: size(last - first) {
+		if (size != 0) {
+			keys.assign(size + 1, first->first);
+			values.assign(size + 1, first->second);
+
+			RandomAccessIterator current = first;
+			fill(1, current);
+		}
+	}
+
+	bool isEmpty() const {
+		return size == 0;
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+	Value get(const Key& key) const {
+		KeyCache keyCache = Compare::cache(key);
+		std::size_t position = lowerBoundPosition(key, keyCache);
+
+		if (position == 0 || isLess(key, keyCache, keys[position], Compare::cache(keys[position]))) {
+			throw std::exception();
+		}
+
+		return values[position];
+	}
+
+	bool contains(const Key& key) const {
+		KeyCache keyCache = Compare::cache(key);
+		std::size_t position = lowerBoundPosition(key, keyCache);
+
+		return position != 0 && !isLess(key, keyCache, keys[position], Compare::cache(keys[position]));
+	}
+
+	// Position of the smallest key not less than key, or 0 if there is none.
+	// Use getKey and getValue to read the entry.
+	std::size_t lowerBound(const Key& key) const {
+		return lowerBoundPosition(key, Compare::cache(key));
+	}
+
+	const Key& getKey(std::size_t position) const {
+		return keys[position];
+	}
+
+	const Value& getValue(std::size_t position) const {
+		return values[position];
+	}
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "eytzinger.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+using namespace std;
+
+map<int, int> uniqueInts;
+
+void testLookups(const EytzingerSnapshot<int, int>& snapshot, const char* name) {
+	if (snapshot.getSize() != uniqueInts.size()) {
+		cout << name << " size test failed\n";
+	}
+
+	for (map<int, int>::const_iterator i = uniqueInts.begin(); i != uniqueInts.end(); ++i) {
+		if (!snapshot.contains(i->first) || snapshot.get(i->first) != i->second) {
+			cout << "Fail on " << name << " get test with number " << i->first << endl;
+		}
+	}
+
+	for (int i = 0; i < 100000; i++) {
+		int key = rand();
+		map<int, int>::const_iterator expected = uniqueInts.lower_bound(key);
+		size_t position = snapshot.lowerBound(key);
+
+		if (expected == uniqueInts.end() ? position != 0 : position == 0 || snapshot.getKey(position) != expected->first) {
+			cout << "Fail on " << name << " lowerBound test with number " << key << endl;
+		}
+
+		if (snapshot.contains(key) != (uniqueInts.count(key) != 0)) {
+			cout << "Fail on " << name << " contains test with number " << key << endl;
+		}
+	}
+}
+
+void testSmallSizes() {
+	for (int size = 0; size < 100; size++) {
+		vector<pair<int, int> > entries;
+		for (int i = 0; i < size; i++) {
+			entries.push_back(make_pair(2 * i, i));
+		}
+
+		EytzingerSnapshot<int, int> snapshot(entries.begin(), entries.end());
+
+		for (int key = -1; key <= 2 * size; key++) {
+			size_t position = snapshot.lowerBound(key);
+			int expected = key < 0 ? 0 : (key + 1) / 2;
+
+			if (expected == size ? position != 0 : position == 0 || snapshot.getValue(position) != expected) {
+				cout << "Fail on small size test with size " << size << " and key " << key << endl;
+			}
+		}
+	}
+}
+
+// Orders ints from the largest down
+struct ReverseCompare {
+	struct Cache {
+	};
+
+	static Cache cache(int) {
+		return Cache();
+	}
+
+	static int compare(int a, const Cache&, int b, const Cache&) {
+		return a > b ? -1 : (a < b ? 1 : 0);
+	}
+};
+
+// A snapshot searches by the Compare of its tree
+template <typename Tree>
+void testCompareOrder(const char* name) {
+	Tree tree;
+	for (int key = 0; key < 2000; key += 2) {
+		tree.put(key, key + 1);
+	}
+
+	EytzingerSnapshot<int, int, ReverseCompare> snapshot = tree.snapshot();
+	for (int key = -1; key <= 2000; key++) {
+		bool isPresent = key >= 0 && key < 2000 && key % 2 == 0;
+		if (snapshot.contains(key) != isPresent || (isPresent && snapshot.get(key) != key + 1)) {
+			cout << "Fail on " << name << " compare order test with number " << key << endl;
+			return;
+		}
+
+		// The first key in reverse order not before key is the largest one
+		// not above it
+		int expected = key >= 1998 ? 1998 : (key < 0 ? -1 : key - key % 2);
+		size_t position = snapshot.lowerBound(key);
+		if (expected == -1 ? position != 0 : position == 0 || snapshot.getKey(position) != expected) {
+			cout << "Fail on " << name << " compare order lowerBound test with number " << key << endl;
+			return;
+		}
+	}
+}
+
+int main() {
+	AATree<int, int> aaTree;
+	RedBlackTree<int, int> redBlackTree;
+
+	for (int i = 0; i < 1000000; i++) {
+		int a = rand();
+		int b = rand();
+		uniqueInts[a] = b;
+		aaTree.put(a, b);
+		redBlackTree.put(a, b);
+	}
+
+	testLookups(aaTree.snapshot(), "AATree");
+	testLookups(redBlackTree.snapshot(), "RedBlackTree");
+	testSmallSizes();
+	testCompareOrder<AATree<int, int, ReverseCompare> >("AATree");
+	testCompareOrder<RedBlackTree<int, int, false, ReverseCompare> >("RedBlackTree");
+
+	return 0;
+}
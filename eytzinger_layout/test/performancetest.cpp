@@ -0,0 +1,56 @@
+#include "eytzinger.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000, 10000000};
+const int LOOKUPS = 10000000;
+
+vector<int> lookups;
+
+template <typename Map>
+void testLookups(const char* name, Map& map) {
+	clock_t initial = clock();
+
+	long long found = 0;
+	for (size_t i = 0; i < lookups.size(); i++) {
+		found += map.contains(lookups[i]);
+	}
+
+	clock_t current = clock();
+
+	cout << name << " " << (current - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << found << " found)" << endl;
+}
+
+int main() {
+	for (int i = 0; i < LOOKUPS; i++) {
+		lookups.push_back(rand());
+	}
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		cout << "Testing with size of " << TEST_SIZES[i] << endl;
+
+		AATree<int, int> aaTree;
+		RedBlackTree<int, int> redBlackTree;
+		for (int j = 0; j < TEST_SIZES[i]; j++) {
+			int key = rand();
+			aaTree.put(key, j);
+			redBlackTree.put(key, j);
+		}
+
+		EytzingerSnapshot<int, int> aaSnapshot = aaTree.snapshot();
+		EytzingerSnapshot<int, int> redBlackSnapshot = redBlackTree.snapshot();
+
+		testLookups("AATree               ", aaTree);
+		testLookups("AATree snapshot      ", aaSnapshot);
+		testLookups("RedBlackTree         ", redBlackTree);
+		testLookups("RedBlackTree snapshot", redBlackSnapshot);
+		cout << endl;
+	}
+
+	return 0;
+}
@@ -1,12 +1,12 @@
 #ifndef FIBHEAP_H
 #define FIBHEAP_H
 
-#include <cmath>
+#include <new>
+#include <type_traits>
 #include <vector>
 #include <limits>
 
-const double GOLDEN_RATIO = (1 + sqrt(5.0))/2;
-const double LOG_GOLDEN_RATION = log(GOLDEN_RATIO);
+#include "poolallocator.h"
 
 template <typename T>
 class NegativeInfinity {
@@ -16,7 +16,8 @@ public:
 	}
 };
 
-template <typename Key>
+// Nodes are allocated with Allocator<Node> (see poolallocator.h)
+template <typename Key, template <typename> class Allocator = PoolAllocator>
 class FibonacciHeap {
 public:
 	struct Node {
@@ -33,8 +34,31 @@ public:
 		}
 	};
 
+	// A node of degree d roots at least F(d + 2) >= phi^d nodes, where phi
+	// is the golden ratio, so degrees stay below log(2^64)/log(phi) < 93
+	static const int MAX_DEGREE_BOUND = 96;
+
 	Node* min;
 	size_t size;
+	Allocator<Node> allocator;
+	// Roots by degree during consolidate; all 0 between calls
+	Node* degreeToNode[MAX_DEGREE_BOUND];
+
+	Node* createNode(const Key& key) {
+		Node* node = allocator.allocate();
+
+		try {
+			return new (node) Node(key);
+		} catch (...) {
+			allocator.deallocate(node);
+			throw;
+		}
+	}
+
+	void destroyNode(Node* node) {
+		node->~Node();
+		allocator.deallocate(node);
+	}
 
 	void insertInList(Node*& list, Node* node) {
 		if (list == 0) {
@@ -73,9 +97,26 @@ public:
 		}
 	}
 
+	// An exclusive bound on the degrees in a heap of n nodes:
+	// log(n)/log(phi) < bitLength(n) * 1475/1024, rounded up
+	static int degreeBound(size_t n) {
+		int bitLength;
+#ifdef __GNUC__
+		bitLength = n == 0 ? 0 : 64 - __builtin_clzll(static_cast<unsigned long long>(n));
+#else
+		bitLength = 0;
+		for (unsigned long long bits = n; bits != 0; bits >>= 1) {
+			bitLength++;
+		}
+#endif
+
+		return ((bitLength * 1475) >> 10) + 2;
+	}
+
+	// Links the roots until no two have the same degree. Also clears the
+	// parents of the roots, which may have just been children of min.
 	void consolidate() {
-		int maxD = static_cast<int>(log(static_cast<double>(size))/LOG_GOLDEN_RATION) + 1;
-		std::vector<Node*> degreeToNode(maxD, 0);
+		int bound = degreeBound(size);
 
 		min->left->right = 0;
 		min->left = 0;
@@ -83,29 +124,40 @@ public:
 		while (currentRootNode != 0) {
 			Node* current = currentRootNode;
 			currentRootNode = currentRootNode->right;
+			current->parent = 0;
 
-			while(degreeToNode[current->degree] != 0) {
+			while (degreeToNode[current->degree] != 0) {
 				Node* sameDegreeNode = degreeToNode[current->degree];
-				
+				degreeToNode[current->degree] = 0;
+
 				if (sameDegreeNode->key < current->key) {
 					std::swap(current, sameDegreeNode);
 				}
 				insertInList(current->children, sameDegreeNode);
 				sameDegreeNode->parent = current;
-				current->degree++;
 				sameDegreeNode->isMarked = false;
-
-				degreeToNode[sameDegreeNode->degree] = 0;
+				current->degree++;
 			}
 
-			current->parent = 0;
 			degreeToNode[current->degree] = current;
 		}
 
+		// Rebuilds the root list, leaving the table empty for the next call
 		min = 0;
-		for (size_t i = 0; i < degreeToNode.size(); i++) {
+		for (int i = 0; i < bound; i++) {
 			if (degreeToNode[i] != 0) {
-				insertInRootList(degreeToNode[i]);
+				Node* root = degreeToNode[i];
+				degreeToNode[i] = 0;
+
+				if (min == 0) {
+					root->left = root->right = root;
+					min = root;
+				} else {
+					insertInList(min, root);
+					if (root->key < min->key) {
+						min = root;
+					}
+				}
 			}
 		}
 	}
@@ -128,29 +180,41 @@ public:
 		}
 	}
 
+	// Destroys the nodes of list and of all trees under them. Children are
+	// spliced into the list before their parent is destroyed, so this takes
+	// no stack however deep the trees are.
 	void deleteList(Node* list) {
-		if (list != 0) {
-			list->left->right = 0;
-			list->left = 0;
-
-			Node* current = list;
-			while (current != 0) {
-				deleteList(current->children);
-				Node* temp = current->right;
-				delete current;
-				current = temp;
+		while (list != 0) {
+			if (list->children != 0) {
+				merge(list, list->children);
+				list->children = 0;
 			}
+
+			Node* temp = list;
+			extractFromList(list, temp);
+			destroyNode(temp);
 		}
 	}
 
-	void copyFromList(Node* list) {
+	// Inserts the keys of the nodes of list and of all trees under them
+	void copyFromList(const Node* list) {
+		std::vector<const Node*> lists;
 		if (list != 0) {
-			Node* current = list;
+			lists.push_back(list);
+		}
+
+		while (!lists.empty()) {
+			const Node* first = lists.back();
+			lists.pop_back();
 
-			while (current->right != list) {
-				copyFromList(current->children);
+			const Node* current = first;
+			do {
 				insert(current->key);
-			}
+				if (current->children != 0) {
+					lists.push_back(current->children);
+				}
+				current = current->right;
+			} while (current != first);
 		}
 	}
 
@@ -162,7 +226,12 @@ public:
 			: node(node) {
 		}
 	public:
-		const Key& getKey() {
+		// An element of no heap, to be assigned later
+		Element()
+			: node(0) {
+		}
+
+		const Key& getKey() const {
 			return node->key;
 		}
 
@@ -170,21 +239,31 @@ public:
 	};
 
 	FibonacciHeap()
-		: min(0), size(0) {
+		: min(0), size(0), degreeToNode() {
 	}
 
+	// A pooling allocator frees all nodes at once, so they are only visited
+	// when their keys need destroying
 	~FibonacciHeap() {
-		deleteList(min);
+		if (!Allocator<Node>::OWNS_STORAGE || !std::is_trivially_destructible<Key>::value) {
+			deleteList(min);
+		}
 	}
 
 	FibonacciHeap(const FibonacciHeap& heap)
-		: min(0), size(0) {
-			copyFromList(heap.min);
+		: min(0), size(0), degreeToNode() {
+			try {
+				copyFromList(heap.min);
+			} catch (...) {
+				deleteList(min);
+				throw;
+			}
 	}
 
 	void swap(FibonacciHeap& heap) {
 		std::swap(min, heap.min);
 		std::swap(size, heap.size);
+		allocator.swap(heap.allocator);
 	}
 
 	FibonacciHeap& operator=(const FibonacciHeap& heap) {
@@ -197,7 +276,7 @@ public:
 	}
 
 	Element insert(const Key& key) {
-		Node* newNode = new Node(key);
+		Node* newNode = createNode(key);
 
 		insertInRootList(newNode);
 		size++;
@@ -213,7 +292,9 @@ public:
 		return min->key;
 	}
 
-	void mergeWith(FibonacciHeap<Key>& heap) {
+	// Moves the elements of heap, and the allocator storage holding them,
+	// to this heap
+	void mergeWith(FibonacciHeap& heap) {
 		if (min == 0) {
 			min = heap.min;
 		} else if (heap.min != 0) {
@@ -224,6 +305,7 @@ public:
 		}
 
 		size += heap.size;
+		allocator.absorb(heap.allocator);
 
 		heap.min = 0;
 		heap.size = 0;
@@ -237,23 +319,18 @@ public:
 		return size;
 	}
 
+	// The children of min join the root list in O(1); consolidate, which
+	// visits every root anyway, clears their parents. Marks of roots are
+	// never read and are cleared when a root is linked under another.
 	void extractMin() {
 		if (min->children != 0) {
-			Node* currentChild = min->children;
-			while (currentChild->right != min->children) {
-				currentChild->parent = 0;
-				currentChild->isMarked = false;
-
-				currentChild = currentChild->right;
-			}
-
 			merge(min, min->children);
 			min->children = 0;
 		}
 
 		Node* temp = min;
 		extractFromList(min, temp);
-		delete temp;
+		destroyNode(temp);
 		size--;
 
 		if (min != 0) {
@@ -0,0 +1,310 @@
+#ifndef INTRUSIVEFIBHEAP_H
+#define INTRUSIVEFIBHEAP_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+template <typename T>
+class FibonacciHeapHook;
+
+template <typename T, FibonacciHeapHook<T> T::*Hook, typename Less>
+class IntrusiveFibonacciHeap;
+
+// The links of an object in an IntrusiveFibonacciHeap, as in the nodes of
+// FibonacciHeap. A copy of a hook is in no heap, so copying an object
+// never copies its place in one.
+template <typename T>
+class FibonacciHeapHook {
+	T* parent;
+	T* left;
+	T* right;
+	T* children;
+	int degree;
+	bool isMarked;
+
+public:
+	FibonacciHeapHook()
+		: parent(0), left(0), right(0), children(0), degree(0), isMarked(false) {
+	}
+
+	FibonacciHeapHook(const FibonacciHeapHook&)
+		: parent(0), left(0), right(0), children(0), degree(0), isMarked(false) {
+	}
+
+	FibonacciHeapHook& operator=(const FibonacciHeapHook&) {
+		return *this;
+	}
+
+	// Whether the object is in a heap. An object left in a heap destroyed
+	// without clear stays linked until it is inserted again.
+	bool isLinked() const {
+		return left != 0;
+	}
+
+	template <typename U, FibonacciHeapHook<U> U::*Hook, typename Less>
+	friend class IntrusiveFibonacciHeap;
+};
+
+// FibonacciHeap of objects that hold their own links in the member Hook,
+// ordered by Less on the objects. Nothing is allocated or copied, so no
+// operation throws unless Less does. decreaseKey and remove take the
+// object itself; lower its key in place, then call decreaseKey. An object
+// is in at most one heap per hook, and must not move while in one.
+//
+// The heap does not own the objects: destroying it leaves them as they
+// are (see clear).
+template <typename T, FibonacciHeapHook<T> T::*Hook, typename Less = std::less<T> >
+class IntrusiveFibonacciHeap {
+	// See FibonacciHeap
+	static const int MAX_DEGREE_BOUND = 96;
+
+	T* min;
+	std::size_t size;
+	Less less;
+	// Roots by degree during consolidate; all 0 between calls
+	T* degreeToNode[MAX_DEGREE_BOUND];
+
+	IntrusiveFibonacciHeap(const IntrusiveFibonacciHeap&);
+	IntrusiveFibonacciHeap& operator=(const IntrusiveFibonacciHeap&);
+
+	static FibonacciHeapHook<T>& hook(T* node) {
+		return node->*Hook;
+	}
+
+	bool isLess(T* first, T* second) const {
+		return less(*first, *second);
+	}
+
+	void insertInList(T*& list, T* node) {
+		if (list == 0) {
+			hook(node).left = hook(node).right = node;
+			list = node;
+		} else {
+			hook(hook(list).right).left = node;
+			hook(node).right = hook(list).right;
+			hook(list).right = node;
+			hook(node).left = list;
+		}
+	}
+
+	void extractFromList(T*& list, T* node) {
+		if (hook(node).right == node) {
+			list = 0;
+		} else {
+			hook(hook(node).left).right = hook(node).right;
+			hook(hook(node).right).left = hook(node).left;
+			list = hook(node).right;
+		}
+	}
+
+	void merge(T* first, T* second) {
+		T* temp = hook(first).right;
+		hook(first).right = hook(second).right;
+		hook(hook(second).right).left = first;
+		hook(temp).left = second;
+		hook(second).right = temp;
+	}
+
+	void insertInRootList(T* node) {
+		insertInList(min, node);
+		if (isLess(node, min)) {
+			min = node;
+		}
+	}
+
+	static int degreeBound(std::size_t n) {
+		int bitLength;
+#ifdef __GNUC__
+		bitLength = n == 0 ? 0 : 64 - __builtin_clzll(static_cast<unsigned long long>(n));
+#else
+		bitLength = 0;
+		for (unsigned long long bits = n; bits != 0; bits >>= 1) {
+			bitLength++;
+		}
+#endif
+
+		return ((bitLength * 1475) >> 10) + 2;
+	}
+
+	void consolidate() {
+		int bound = degreeBound(size);
+
+		hook(hook(min).left).right = 0;
+		hook(min).left = 0;
+		T* currentRootNode = min;
+		while (currentRootNode != 0) {
+			T* current = currentRootNode;
+			currentRootNode = hook(currentRootNode).right;
+			hook(current).parent = 0;
+
+			while (degreeToNode[hook(current).degree] != 0) {
+				T* sameDegreeNode = degreeToNode[hook(current).degree];
+				degreeToNode[hook(current).degree] = 0;
+
+				if (isLess(sameDegreeNode, current)) {
+					std::swap(current, sameDegreeNode);
+				}
+				insertInList(hook(current).children, sameDegreeNode);
+				hook(sameDegreeNode).parent = current;
+				hook(sameDegreeNode).isMarked = false;
+				hook(current).degree++;
+			}
+
+			degreeToNode[hook(current).degree] = current;
+		}
+
+		min = 0;
+		for (int i = 0; i < bound; i++) {
+			if (degreeToNode[i] != 0) {
+				T* root = degreeToNode[i];
+				degreeToNode[i] = 0;
+
+				if (min == 0) {
+					hook(root).left = hook(root).right = root;
+					min = root;
+				} else {
+					insertInRootList(root);
+				}
+			}
+		}
+	}
+
+	void cutNode(T* node) {
+		T* parent = hook(node).parent;
+
+		extractFromList(hook(parent).children, node);
+		hook(parent).degree--;
+		hook(node).parent = 0;
+		hook(node).isMarked = false;
+		insertInRootList(node);
+
+		if (hook(parent).parent != 0) {
+			if (hook(parent).isMarked) {
+				cutNode(parent);
+			} else {
+				hook(parent).isMarked = true;
+			}
+		}
+	}
+
+	static void unlink(T* node) {
+		FibonacciHeapHook<T>& links = hook(node);
+
+		links.parent = links.left = links.right = links.children = 0;
+		links.degree = 0;
+		links.isMarked = false;
+	}
+
+public:
+	explicit IntrusiveFibonacciHeap(const Less& less = Less())
+		: min(0), size(0), less(less), degreeToNode() {
+	}
+
+	void swap(IntrusiveFibonacciHeap& heap) {
+		std::swap(min, heap.min);
+		std::swap(size, heap.size);
+		std::swap(less, heap.less);
+	}
+
+	// object must not be in a heap by this hook
+	void insert(T& object) {
+		T* node = &object;
+
+		unlink(node);
+		insertInRootList(node);
+		size++;
+	}
+
+	T& getMin() const {
+		return *min;
+	}
+
+	// Moves the objects of heap to this heap
+	void mergeWith(IntrusiveFibonacciHeap& heap) {
+		if (min == 0) {
+			min = heap.min;
+		} else if (heap.min != 0) {
+			merge(min, heap.min);
+			if (isLess(heap.min, min)) {
+				min = heap.min;
+			}
+		}
+
+		size += heap.size;
+
+		heap.min = 0;
+		heap.size = 0;
+	}
+
+	bool isEmpty() const {
+		return min == 0;
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+	void extractMin() {
+		if (hook(min).children != 0) {
+			merge(min, hook(min).children);
+			hook(min).children = 0;
+		}
+
+		T* temp = min;
+		extractFromList(min, temp);
+		unlink(temp);
+		size--;
+
+		if (min != 0) {
+			consolidate();
+		}
+	}
+
+	// Restores the order after the key of object, which is in the heap,
+	// was lowered in place
+	void decreaseKey(T& object) {
+		T* node = &object;
+
+		if (hook(node).parent != 0) {
+			if (isLess(node, hook(node).parent)) {
+				cutNode(node);
+			}
+		} else if (isLess(node, min)) {
+			min = node;
+		}
+	}
+
+	// Cuts object to the root list and extracts it as if it were the
+	// minimum, so no key is changed
+	void remove(T& object) {
+		T* node = &object;
+
+		if (hook(node).parent != 0) {
+			cutNode(node);
+		}
+		min = node;
+		extractMin();
+	}
+
+	// Takes every object out of the heap, leaving it unlinked, in O(size)
+	void clear() {
+		T* list = min;
+
+		while (list != 0) {
+			if (hook(list).children != 0) {
+				merge(list, hook(list).children);
+				hook(list).children = 0;
+			}
+
+			T* temp = list;
+			extractFromList(list, temp);
+			unlink(temp);
+		}
+
+		min = 0;
+		size = 0;
+	}
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Node allocators for the heaps. An allocator hands out uninitialized
+// storage for one T at a time:
+//
+//   T* allocate();
+//   void deallocate(T* pointer);
+//   // Takes over the storage of allocator, which is left empty, so that
+//   // objects allocated by either can be deallocated by this one
+//   void absorb(Allocator& allocator);
+//   void swap(Allocator& allocator);
+//   // Whether destroying the allocator frees all storage it handed out,
+//   // so that trivially destructible objects need not be deallocated
+//   static const bool OWNS_STORAGE;
+
+// Allocates every object with operator new
+template <typename T>
+class NewDeleteAllocator {
+public:
+	static const bool OWNS_STORAGE = false;
+
+	T* allocate() {
+		return static_cast<T*>(::operator new(sizeof(T)));
+	}
+
+	void deallocate(T* pointer) {
+		::operator delete(pointer);
+	}
+
+	void absorb(NewDeleteAllocator&) {
+	}
+
+	void swap(NewDeleteAllocator&) {
+	}
+};
+
+// Carves objects out of contiguous slabs, each twice as large as the one
+// before, and reuses freed objects through a free list threaded through
+// them. Objects allocated one after another are thus adjacent in memory,
+// and all slabs are released at once when the pool is destroyed.
+template <typename T>
+class PoolAllocator {
+	union Slot {
+		Slot* next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	static const std::size_t FIRST_SLAB_SIZE = 64;
+	static const std::size_t MAX_SLAB_SIZE = 1 << 16;
+
+	std::vector<Slot*> slabs;
+	// The unused part of the last slab
+	Slot* next;
+	Slot* end;
+	std::size_t nextSlabSize;
+
+	// Freed slots, most recently freed first. The tail makes absorbing the
+	// list of another pool O(1).
+	Slot* freeList;
+	Slot* freeListTail;
+
+	void addSlab() {
+		Slot* slab = new Slot[nextSlabSize];
+		slabs.push_back(slab);
+
+		next = slab;
+		end = slab + nextSlabSize;
+		if (nextSlabSize < MAX_SLAB_SIZE) {
+			nextSlabSize *= 2;
+		}
+	}
+
+	void releaseSlabs() {
+		for (std::size_t i = 0; i < slabs.size(); i++) {
+			delete[] slabs[i];
+		}
+		slabs.clear();
+	}
+
+	PoolAllocator(const PoolAllocator&);
+	PoolAllocator& operator=(const PoolAllocator&);
+
+public:
+	static const bool OWNS_STORAGE = true;
+
+	PoolAllocator()
+		: next(0), end(0), nextSlabSize(FIRST_SLAB_SIZE), freeList(0), freeListTail(0) {
+	}
+
+	~PoolAllocator() {
+		releaseSlabs();
+	}
+
+	T* allocate() {
+		Slot* slot;
+
+		if (freeList != 0) {
+			slot = freeList;
+			freeList = slot->next;
+			if (freeList == 0) {
+				freeListTail = 0;
+			}
+		} else {
+			if (next == end) {
+				addSlab();
+			}
+			slot = next++;
+		}
+
+		return reinterpret_cast<T*>(slot->storage);
+	}
+
+	void deallocate(T* pointer) {
+		Slot* slot = reinterpret_cast<Slot*>(pointer);
+
+		slot->next = freeList;
+		freeList = slot;
+		if (freeListTail == 0) {
+			freeListTail = slot;
+		}
+	}
+
+	// The unused part of the last slab of pool is not reused
+	void absorb(PoolAllocator& pool) {
+		slabs.insert(slabs.end(), pool.slabs.begin(), pool.slabs.end());
+		pool.slabs.clear();
+
+		if (pool.freeList != 0) {
+			if (freeList == 0) {
+				freeList = pool.freeList;
+			} else {
+				freeListTail->next = pool.freeList;
+			}
+			freeListTail = pool.freeListTail;
+		}
+
+		pool.next = pool.end = 0;
+		pool.freeList = pool.freeListTail = 0;
+	}
+
+	void swap(PoolAllocator& pool) {
+		slabs.swap(pool.slabs);
+		std::swap(next, pool.next);
+		std::swap(end, pool.end);
+		std::swap(nextSlabSize, pool.nextSlabSize);
+		std::swap(freeList, pool.freeList);
+		std::swap(freeListTail, pool.freeListTail);
+	}
+};
+
+#endif
@@ -0,0 +1,413 @@
+#include "fibheap.h"
+#include "intrusivefibheap.h"
+#include "../../pairing_heap/src/pairingheap.h"
+#include "../../dary_heap/src/daryheap.h"
+#include "../../radix_heap/src/radixheap.h"
+#include <ctime>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <vector>
+using namespace std;
+
+// Vertices and edges of the random graphs
+const int TEST_SIZES[][2] = {{10000, 100000}, {100000, 1000000}, {1000000, 4000000}};
+
+const int HEAP_SIZES[] = {1000, 100000, 1000000};
+// Rounds of the steady state test, each an insert and an extractMin
+const int ROUNDS = 5000000;
+
+// Keys of the random and decrease-key tests
+const int RANDOM_SIZES[] = {100000, 1000000};
+// Decreases per extractMin in the decrease-key test
+const int DECREASES_PER_EXTRACT = 8;
+
+struct Edge {
+	int dest;
+	int weight;
+};
+
+struct VertexDistance {
+	int vertex;
+	int distance;
+
+	VertexDistance(int vertex, int distance)
+		: vertex(vertex), distance(distance) {
+	}
+
+	bool operator<(const VertexDistance& other) const {
+		return distance < other.distance;
+	}
+};
+
+template <>
+class RadixKey<VertexDistance> {
+public:
+	static unsigned long long get(const VertexDistance& key) {
+		return key.distance;
+	}
+};
+
+// std::priority_queue behind the heap interface used by the tests. A
+// decreased or removed element stays in the queue, outdated, until it
+// reaches the top, as in the usual way of running Dijkstra's algorithm on
+// a heap without decreaseKey.
+template <typename Key>
+class LazyPriorityQueue {
+	struct Entry {
+		Key key;
+		size_t id;
+		unsigned version;
+
+		bool operator>(const Entry& other) const {
+			return other.key < key;
+		}
+	};
+
+	priority_queue<Entry, vector<Entry>, greater<Entry> > queue;
+	// The key and current version of every element by id
+	vector<Key> keys;
+	vector<unsigned> versions;
+	vector<size_t> freeIds;
+	size_t size;
+
+	void push(size_t id) {
+		Entry entry = { keys[id], id, versions[id] };
+		queue.push(entry);
+	}
+
+	void release(size_t id) {
+		versions[id]++;
+		freeIds.push_back(id);
+		size--;
+	}
+
+	void popOutdated() {
+		while (!queue.empty() && queue.top().version != versions[queue.top().id]) {
+			queue.pop();
+		}
+	}
+
+public:
+	class Element {
+		size_t id;
+
+		Element(size_t id)
+			: id(id) {
+		}
+	public:
+		Element()
+			: id(0) {
+		}
+
+	friend class LazyPriorityQueue;
+	};
+
+	LazyPriorityQueue()
+		: size(0) {
+	}
+
+	Element insert(const Key& key) {
+		size_t id;
+		if (freeIds.empty()) {
+			id = keys.size();
+			keys.push_back(key);
+			versions.push_back(0);
+		} else {
+			id = freeIds.back();
+			freeIds.pop_back();
+			keys[id] = key;
+		}
+
+		push(id);
+		size++;
+
+		return Element(id);
+	}
+
+	const Key& getMin() const {
+		return queue.top().key;
+	}
+
+	bool isEmpty() const {
+		return size == 0;
+	}
+
+	void extractMin() {
+		release(queue.top().id);
+		queue.pop();
+		popOutdated();
+	}
+
+	void decreaseKey(Element element, const Key& newKey) {
+		keys[element.id] = newKey;
+		versions[element.id]++;
+		push(element.id);
+		popOutdated();
+	}
+
+	void remove(Element element) {
+		release(element.id);
+		popOutdated();
+	}
+};
+
+vector<vector<Edge> > neighbors;
+
+int random(int bound) {
+	return static_cast<int>((static_cast<long long>(rand()) * (RAND_MAX + 1LL) + rand()) % bound);
+}
+
+void generateGraph(int vertices, int edges) {
+	neighbors.assign(vertices, vector<Edge>());
+
+	for (int i = 0; i < edges; i++) {
+		Edge edge = { random(vertices), 1 + random(1000) };
+		neighbors[random(vertices)].push_back(edge);
+	}
+}
+
+// Dijkstra from vertex 0, inserting every vertex when it is first reached
+template <typename Heap>
+void testDijkstra(const char* name) {
+	clock_t initial = clock();
+
+	vector<int> distance(neighbors.size(), numeric_limits<int>::max());
+	vector<typename Heap::Element> elements(neighbors.size());
+	vector<bool> inHeap(neighbors.size(), false);
+	Heap heap;
+
+	distance[0] = 0;
+	elements[0] = heap.insert(VertexDistance(0, 0));
+	inHeap[0] = true;
+	long long operations = 0;
+
+	while (!heap.isEmpty()) {
+		VertexDistance current = heap.getMin();
+		heap.extractMin();
+		inHeap[current.vertex] = false;
+
+		for (size_t i = 0; i < neighbors[current.vertex].size(); i++) {
+			const Edge& edge = neighbors[current.vertex][i];
+			int newDistance = current.distance + edge.weight;
+
+			if (newDistance < distance[edge.dest]) {
+				if (inHeap[edge.dest]) {
+					heap.decreaseKey(elements[edge.dest], VertexDistance(edge.dest, newDistance));
+				} else if (distance[edge.dest] == numeric_limits<int>::max()) {
+					elements[edge.dest] = heap.insert(VertexDistance(edge.dest, newDistance));
+					inHeap[edge.dest] = true;
+				}
+				distance[edge.dest] = newDistance;
+				operations++;
+			}
+		}
+	}
+
+	clock_t afterDijkstra = clock();
+
+	cout << name << " " << (afterDijkstra - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << operations % 10 << ")" << endl;
+}
+
+struct VertexState {
+	int distance;
+	FibonacciHeapHook<VertexState> hook;
+
+	bool operator<(const VertexState& other) const {
+		return distance < other.distance;
+	}
+};
+
+// testDijkstra on the intrusive heap, which links the state of every
+// vertex in place of a node holding a copy of its distance and an Element
+void testIntrusiveDijkstra(const char* name) {
+	clock_t initial = clock();
+
+	vector<VertexState> states(neighbors.size());
+	IntrusiveFibonacciHeap<VertexState, &VertexState::hook> heap;
+
+	for (size_t i = 0; i < states.size(); i++) {
+		states[i].distance = numeric_limits<int>::max();
+	}
+	states[0].distance = 0;
+	heap.insert(states[0]);
+	long long operations = 0;
+
+	while (!heap.isEmpty()) {
+		VertexState& current = heap.getMin();
+		heap.extractMin();
+		int vertex = &current - &states[0];
+
+		for (size_t i = 0; i < neighbors[vertex].size(); i++) {
+			const Edge& edge = neighbors[vertex][i];
+			VertexState& next = states[edge.dest];
+			int newDistance = current.distance + edge.weight;
+
+			if (newDistance < next.distance) {
+				bool isReached = next.distance != numeric_limits<int>::max();
+				next.distance = newDistance;
+				if (next.hook.isLinked()) {
+					heap.decreaseKey(next);
+				} else if (!isReached) {
+					heap.insert(next);
+				}
+				operations++;
+			}
+		}
+	}
+
+	clock_t afterDijkstra = clock();
+
+	cout << name << " " << (afterDijkstra - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << operations % 10 << ")" << endl;
+}
+
+// Fills a heap with count random keys and extracts them all, then runs
+// ROUNDS inserts and extractMins on a heap kept at count keys
+void testExtractMin(int count) {
+	FibonacciHeap<int> heap;
+	long long sum = 0;
+
+	clock_t initial = clock();
+	for (int i = 0; i < count; i++) {
+		heap.insert(rand());
+	}
+	while (!heap.isEmpty()) {
+		sum += heap.getMin();
+		heap.extractMin();
+	}
+	clock_t afterDrain = clock();
+
+	for (int i = 0; i < count; i++) {
+		heap.insert(rand());
+	}
+	clock_t afterFill = clock();
+	for (int i = 0; i < ROUNDS; i++) {
+		heap.insert(heap.getMin() + rand() % 1000);
+		heap.extractMin();
+	}
+	clock_t afterRounds = clock();
+
+	cout << "fill and drain " << (afterDrain - initial) * 1000 / CLOCKS_PER_SEC << "ms, insert and extractMin "
+		<< (afterRounds - afterFill) * 1000 / CLOCKS_PER_SEC << "ms (" << (sum + heap.getMin()) % 10 << ")" << endl;
+}
+
+// Inserts count random keys and extracts them all, which the radix heap
+// takes as the keys are extracted in order
+template <typename Heap>
+void testRandom(const char* name, int count) {
+	Heap heap;
+	long long sum = 0;
+
+	clock_t initial = clock();
+	for (int i = 0; i < count; i++) {
+		heap.insert(random(numeric_limits<int>::max()));
+	}
+	while (!heap.isEmpty()) {
+		sum += heap.getMin();
+		heap.extractMin();
+	}
+	clock_t afterDrain = clock();
+
+	cout << name << " " << (afterDrain - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+// Inserts count random keys, then extracts them all while decreasing
+// DECREASES_PER_EXTRACT random keys still in the heap before every
+// extractMin. No key goes below the last extracted minimum, so the radix
+// heap takes the same operations.
+template <typename Heap>
+void testDecreaseKey(const char* name, int count) {
+	Heap heap;
+	vector<typename Heap::Element> elements;
+	vector<int> keys;
+	// The indices of the elements still in the heap, and the position of
+	// every index in it, so extracted ones are swapped out in O(1)
+	vector<int> alive;
+	vector<int> position;
+	long long sum = 0;
+
+	for (int i = 0; i < count; i++) {
+		keys.push_back(random(numeric_limits<int>::max()));
+		alive.push_back(i);
+		position.push_back(i);
+	}
+
+	clock_t initial = clock();
+	for (int i = 0; i < count; i++) {
+		elements.push_back(heap.insert(VertexDistance(i, keys[i])));
+	}
+
+	int lastExtracted = 0;
+	while (!heap.isEmpty()) {
+		for (int i = 0; i < DECREASES_PER_EXTRACT; i++) {
+			int index = alive[random(alive.size())];
+			int newKey = lastExtracted + (keys[index] - lastExtracted) / 2;
+
+			heap.decreaseKey(elements[index], VertexDistance(index, newKey));
+			keys[index] = newKey;
+		}
+
+		VertexDistance minimum = heap.getMin();
+		lastExtracted = minimum.distance;
+		sum += lastExtracted;
+		heap.extractMin();
+
+		int moved = alive.back();
+		alive[position[minimum.vertex]] = moved;
+		position[moved] = position[minimum.vertex];
+		alive.pop_back();
+	}
+	clock_t afterDrain = clock();
+
+	cout << name << " " << (afterDrain - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+int main() {
+	for (size_t i = 0; i < sizeof(RANDOM_SIZES)/sizeof(RANDOM_SIZES[0]); i++) {
+		cout << "Random, " << RANDOM_SIZES[i] << " keys" << endl;
+		testRandom<FibonacciHeap<int> >("FibonacciHeap       ", RANDOM_SIZES[i]);
+		testRandom<PairingHeap<int> >("PairingHeap         ", RANDOM_SIZES[i]);
+		testRandom<DaryHeap<int, 2> >("DaryHeap<2>         ", RANDOM_SIZES[i]);
+		testRandom<DaryHeap<int, 4> >("DaryHeap<4>         ", RANDOM_SIZES[i]);
+		testRandom<RadixHeap<int> >("RadixHeap           ", RANDOM_SIZES[i]);
+		testRandom<LazyPriorityQueue<int> >("std::priority_queue ", RANDOM_SIZES[i]);
+		cout << endl;
+	}
+
+	for (size_t i = 0; i < sizeof(RANDOM_SIZES)/sizeof(RANDOM_SIZES[0]); i++) {
+		cout << "Decrease-key heavy, " << RANDOM_SIZES[i] << " keys" << endl;
+		testDecreaseKey<FibonacciHeap<VertexDistance> >("FibonacciHeap       ", RANDOM_SIZES[i]);
+		testDecreaseKey<PairingHeap<VertexDistance> >("PairingHeap         ", RANDOM_SIZES[i]);
+		testDecreaseKey<DaryHeap<VertexDistance, 2> >("DaryHeap<2>         ", RANDOM_SIZES[i]);
+		testDecreaseKey<DaryHeap<VertexDistance, 4> >("DaryHeap<4>         ", RANDOM_SIZES[i]);
+		testDecreaseKey<RadixHeap<VertexDistance> >("RadixHeap           ", RANDOM_SIZES[i]);
+		testDecreaseKey<LazyPriorityQueue<VertexDistance> >("std::priority_queue ", RANDOM_SIZES[i]);
+		cout << endl;
+	}
+
+	for (size_t i = 0; i < sizeof(HEAP_SIZES)/sizeof(HEAP_SIZES[0]); i++) {
+		cout << "Heap of " << HEAP_SIZES[i] << " keys" << endl;
+		testExtractMin(HEAP_SIZES[i]);
+		cout << endl;
+	}
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		generateGraph(TEST_SIZES[i][0], TEST_SIZES[i][1]);
+
+		cout << "Dijkstra, " << TEST_SIZES[i][0] << " vertices, " << TEST_SIZES[i][1] << " edges" << endl;
+		testDijkstra<FibonacciHeap<VertexDistance, NewDeleteAllocator> >("FibonacciHeap with NewDeleteAllocator");
+		testDijkstra<FibonacciHeap<VertexDistance> >("FibonacciHeap                        ");
+		testIntrusiveDijkstra("IntrusiveFibonacciHeap               ");
+		testDijkstra<PairingHeap<VertexDistance> >("PairingHeap                          ");
+		testDijkstra<DaryHeap<VertexDistance, 2> >("DaryHeap<2>                          ");
+		testDijkstra<DaryHeap<VertexDistance, 4> >("DaryHeap<4>                          ");
+		testDijkstra<DaryHeap<VertexDistance, 8> >("DaryHeap<8>                          ");
+		testDijkstra<RadixHeap<VertexDistance> >("RadixHeap                            ");
+		testDijkstra<LazyPriorityQueue<VertexDistance> >("std::priority_queue                  ");
+		cout << endl;
+	}
+
+	return 0;
+}
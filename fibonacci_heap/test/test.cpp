@@ -1,7 +1,10 @@
-#include "fibheap.h "
+#include "fibheap.h"
+#include "intrusivefibheap.h"
 #include <cstdlib>
 #include <iostream>
 #include <queue>
+#include <set>
+#include <string>
 #include <vector>
 using namespace std;
 
@@ -109,8 +112,224 @@ void testDelete() {
 	}
 }
 
-int main2() {
+template <template <typename> class Allocator>
+void testMergeAndCopy() {
+	priority_queue<int> pq;
+	FibonacciHeap<int, Allocator> fh;
+
+	for (int j = 0; j < 100; j++) {
+		FibonacciHeap<int, Allocator> other;
+
+		for (int i = 0; i < 1000; i++) {
+			int key = rand();
+
+			pq.push(-key);
+			if (i % 2 == 0) {
+				fh.insert(key);
+			} else {
+				other.insert(key);
+			}
+		}
+
+		// Leaves freed nodes in both pools
+		other.insert(-1);
+		other.extractMin();
+		fh.insert(-1);
+		fh.extractMin();
+
+		fh.mergeWith(other);
+		if (!other.isEmpty()) {
+			cout << "Fail" << endl;
+		}
+	}
+
+	FibonacciHeap<int, Allocator> copy(fh);
+
+	while (!pq.empty()) {
+		if (-pq.top() != fh.getMin() || -pq.top() != copy.getMin()) {
+			cout << "Fail" << endl;
+		}
+
+		pq.pop();
+		fh.extractMin();
+		copy.extractMin();
+	}
+
+	if (!fh.isEmpty() || !copy.isEmpty()) {
+		cout << "Fail" << endl;
+	}
+}
+
+// Keys with destructors must be destroyed even though the pool frees the
+// nodes at once
+void testNonTrivialKeys() {
+	FibonacciHeap<string> fh;
+
+	for (int i = 0; i < 10000; i++) {
+		fh.insert(string(100, 'a' + rand() % 26));
+	}
+	for (int i = 0; i < 100; i++) {
+		fh.extractMin();
+	}
+
+	FibonacciHeap<string> copy(fh);
+	copy = fh;
+	if (copy.getSize() != fh.getSize() || copy.getMin() != fh.getMin()) {
+		cout << "Fail" << endl;
+	}
+}
+
+struct Task {
+	int priority;
+	int deadline;
+	FibonacciHeapHook<Task> byPriority;
+	FibonacciHeapHook<Task> byDeadline;
+
+	bool operator<(const Task& other) const {
+		return priority < other.priority;
+	}
+};
+
+struct EarlierDeadline {
+	bool operator()(const Task& first, const Task& second) const {
+		return first.deadline < second.deadline;
+	}
+};
+
+typedef IntrusiveFibonacciHeap<Task, &Task::byPriority> PriorityHeap;
+typedef IntrusiveFibonacciHeap<Task, &Task::byDeadline, EarlierDeadline> DeadlineHeap;
+
+// Decreases priorities in place, removes and extracts tasks and merges in
+// whole heaps, comparing every minimum with a multiset, while every task
+// is also in a second heap by deadline through its other hook
+void testIntrusive() {
+	vector<Task> tasks(20000);
+	PriorityHeap heap;
+	DeadlineHeap deadlines;
+	multiset<int> expected;
+
+	for (size_t i = 0; i < tasks.size(); i++) {
+		tasks[i].priority = rand();
+		tasks[i].deadline = rand();
+		deadlines.insert(tasks[i]);
+	}
+
+	size_t next = 0;
+	for (int round = 0; round < 40; round++) {
+		PriorityHeap other;
+		for (int i = 0; i < 500; i++, next++) {
+			(i % 4 == 0 ? other : heap).insert(tasks[next]);
+			expected.insert(tasks[next].priority);
+		}
+		heap.mergeWith(other);
+		if (!other.isEmpty() || other.getSize() != 0) {
+			cout << "Fail on intrusive merge test" << endl;
+		}
+
+		for (int i = 0; i < 300; i++) {
+			Task& task = tasks[rand() % next];
+			if (!task.byPriority.isLinked()) {
+				continue;
+			}
+
+			expected.erase(expected.find(task.priority));
+			if (rand() % 5 == 0) {
+				heap.remove(task);
+				if (task.byPriority.isLinked()) {
+					cout << "Fail on intrusive remove test" << endl;
+				}
+			} else {
+				task.priority = rand() % (task.priority + 1);
+				heap.decreaseKey(task);
+				expected.insert(task.priority);
+			}
+		}
+
+		for (int i = 0; i < 200; i++) {
+			if (heap.getMin().priority != *expected.begin()) {
+				cout << "Fail on intrusive minimum test" << endl;
+				return;
+			}
+
+			expected.erase(expected.begin());
+			heap.extractMin();
+		}
+
+		if (heap.getSize() != expected.size()) {
+			cout << "Fail on intrusive size test" << endl;
+		}
+	}
+
+	// Extracted tasks can go back in
+	for (size_t i = 0; i < next; i++) {
+		if (!tasks[i].byPriority.isLinked()) {
+			heap.insert(tasks[i]);
+			expected.insert(tasks[i].priority);
+		}
+	}
+
+	while (!expected.empty()) {
+		if (heap.getMin().priority != *expected.begin()) {
+			cout << "Fail on intrusive drain test" << endl;
+			return;
+		}
+
+		expected.erase(expected.begin());
+		heap.extractMin();
+	}
+
+	// The other hook was left alone
+	int lastDeadline = -1;
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (deadlines.getMin().deadline < lastDeadline) {
+			cout << "Fail on intrusive second hook test" << endl;
+			return;
+		}
+
+		lastDeadline = deadlines.getMin().deadline;
+		deadlines.extractMin();
+	}
+
+	if (!heap.isEmpty() || !deadlines.isEmpty()) {
+		cout << "Fail on intrusive empty test" << endl;
+	}
+}
+
+void testIntrusiveClear() {
+	vector<Task> tasks(1000);
+	PriorityHeap heap;
+
+	for (size_t i = 0; i < tasks.size(); i++) {
+		tasks[i].priority = rand();
+		heap.insert(tasks[i]);
+	}
+	heap.extractMin();
+	heap.clear();
+
+	for (size_t i = 0; i < tasks.size(); i++) {
+		if (tasks[i].byPriority.isLinked()) {
+			cout << "Fail on intrusive clear test" << endl;
+			return;
+		}
+	}
+
+	// A copy of a task in a heap is in none
+	heap.insert(tasks[0]);
+	Task copy = tasks[0];
+	if (!heap.isEmpty() && copy.byPriority.isLinked()) {
+		cout << "Fail on intrusive copy test" << endl;
+	}
+}
+
+int main() {
 	testInsertAndExtract();
 	testDecreaseKey();
 	testDelete();
+	testMergeAndCopy<PoolAllocator>();
+	testMergeAndCopy<NewDeleteAllocator>();
+	testNonTrivialKeys();
+	testIntrusive();
+	testIntrusiveClear();
+
+	return 0;
 }
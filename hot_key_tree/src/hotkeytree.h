@@ -0,0 +1,233 @@
+#ifndef HOTKEYTREE_H
+#define HOTKEYTREE_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "../../aa_tree/src/aatree.h"
+#include "../../eytzinger_layout/src/eytzinger.h"
+#include "../../tree_statistics/src/treestatistics.h"
+
+// Ordered map for skewed lookups: a Tree (AATree or RedBlackTree) behind a
+// small cache of the recently found keys. A hit costs one hash and a key
+// comparison instead of a descent of log n nodes, so with Zipfian lookups
+// the hot keys are found in a handful of steps wherever they lie in the
+// tree.
+//
+// The cache is 2-way set associative with LRU replacement: a key found in
+// the tree takes the least recently used way of its set, and a hit makes
+// its way the most recent one. A hot key thus survives any single cold
+// lookup that maps to its set. Entries point to the values in the tree,
+// which stay in place on put and getOrInsert; a remove may move values
+// between nodes, so it drops the whole cache in O(1) by advancing the
+// generation the entries are stamped with.
+//
+// Has the API of the trees, except that lookups update the cache and so
+// are not const. Keys need a default constructor, operator== and Hash.
+template <typename Key, typename Value, typename Tree = AATree<Key, Value>, typename Hash = std::hash<Key> >
+class HotKeyTree {
+	static const int WAYS = 2;
+
+	struct Slot {
+		Key key;
+		Value* value;
+		// The entry is valid only if this equals the generation of the tree
+		unsigned generation;
+
+		Slot()
+			: value(0), generation(0) {
+		}
+	};
+
+	struct Set {
+		Slot slots[WAYS];
+		int mostRecent;
+
+		Set()
+			: mostRecent(0) {
+		}
+	};
+
+	Tree tree;
+	std::vector<Set> sets;
+	unsigned generation;
+	Hash hash;
+
+	unsigned long long lookups;
+	unsigned long long hits;
+
+	std::size_t setIndex(const Key& key) const {
+		// Fibonacci hashing, so that hashes like those of integers, which
+		// are often the integer itself, still spread over all sets
+		unsigned long long mixed = static_cast<unsigned long long>(hash(key)) * 0x9E3779B97F4A7C15ULL;
+		return static_cast<std::size_t>(mixed >> 32) & (sets.size() - 1);
+	}
+
+	void invalidate() {
+		generation++;
+
+		if (generation == 0) {
+			for (std::size_t i = 0; i < sets.size(); i++) {
+				for (int way = 0; way < WAYS; way++) {
+					sets[i].slots[way].generation = 0;
+				}
+			}
+			generation = 1;
+		}
+	}
+
+	Value* findValue(const Key& key) {
+		lookups++;
+
+		Set& set = sets[setIndex(key)];
+		for (int way = 0; way < WAYS; way++) {
+			Slot& slot = set.slots[way];
+
+			if (slot.generation == generation && slot.key == key) {
+				set.mostRecent = way;
+				hits++;
+				return slot.value;
+			}
+		}
+
+		Value* value = tree.find(key);
+		if (value != 0) {
+			int way = WAYS - 1 - set.mostRecent;
+			Slot& slot = set.slots[way];
+
+			slot.key = key;
+			slot.value = value;
+			slot.generation = generation;
+			set.mostRecent = way;
+		}
+
+		return value;
+	}
+
+	static std::size_t roundUpToPowerOfTwo(std::size_t n) {
+		std::size_t result = 1;
+		while (result < n) {
+			result <<= 1;
+		}
+
+		return result;
+	}
+
+public:
+	static const std::size_t DEFAULT_CACHE_SETS = 4096;
+
+	// The cache holds 2 * cacheSets keys; cacheSets is rounded up to a
+	// power of two
+	explicit HotKeyTree(std::size_t cacheSets = DEFAULT_CACHE_SETS)
+		: sets(roundUpToPowerOfTwo(cacheSets)), generation(1), lookups(0), hits(0) {
+	}
+
+	// Copies the tree; the cache of the copy starts empty
+	HotKeyTree(const HotKeyTree& hotKeyTree)
+		: tree(hotKeyTree.tree), sets(hotKeyTree.sets.size()), generation(1), hash(hotKeyTree.hash), lookups(0), hits(0) {
+	}
+
+	void swap(HotKeyTree& hotKeyTree) {
+		tree.swap(hotKeyTree.tree);
+		sets.swap(hotKeyTree.sets);
+		std::swap(generation, hotKeyTree.generation);
+		std::swap(hash, hotKeyTree.hash);
+		std::swap(lookups, hotKeyTree.lookups);
+		std::swap(hits, hotKeyTree.hits);
+	}
+
+	HotKeyTree& operator=(const HotKeyTree& hotKeyTree) {
+		if (this != &hotKeyTree) {
+			HotKeyTree temp(hotKeyTree);
+			swap(temp);
+		}
+
+		return *this;
+	}
+
+	bool isEmpty() const {
+		return tree.isEmpty();
+	}
+
+	void put(const Key& key, const Value& value) {
+		tree.put(key, value);
+	}
+
+	void put(Key&& key, Value&& value) {
+		tree.put(std::move(key), std::move(value));
+	}
+
+	// Returns the value for key, inserting a default constructed one if key
+	// is absent
+	Value& getOrInsert(const Key& key) {
+		return tree.getOrInsert(key);
+	}
+
+	void remove(const Key& key) {
+		invalidate();
+		tree.remove(key);
+	}
+
+	// Removes key and returns whether it was present
+	bool tryRemove(const Key& key) {
+		if (!tree.tryRemove(key)) {
+			return false;
+		}
+		invalidate();
+
+		return true;
+	}
+
+	Value get(const Key& key) {
+		const Value* value = findValue(key);
+
+		if (value == 0) {
+			throw std::exception();
+		}
+
+		return *value;
+	}
+
+	// Pointer to the value for key, or 0 if there is none. Removing any key
+	// may invalidate it.
+	Value* find(const Key& key) {
+		return findValue(key);
+	}
+
+	bool contains(const Key& key) {
+		return findValue(key) != 0;
+	}
+
+	// Calls visitor(key, value) for every entry in increasing key order
+	template <typename Visitor>
+	void forEach(Visitor visitor) const {
+		tree.template forEach<Visitor&>(visitor);
+	}
+
+	EytzingerSnapshot<Key, Value, typename Tree::KeyCompare> snapshot() const {
+		return tree.snapshot();
+	}
+
+	// Statistics of the tree behind the cache. Its lookup counts only
+	// include the lookups the cache missed.
+	TreeStatistics statistics() const {
+		return tree.statistics();
+	}
+
+	// Fraction of the lookups since construction or the last resetCounters
+	// that the cache answered
+	double hitRate() const {
+		return lookups == 0 ? 0 : static_cast<double>(hits) / lookups;
+	}
+
+	void resetCounters() {
+		tree.resetCounters();
+		lookups = 0;
+		hits = 0;
+	}
+};
+
+#endif
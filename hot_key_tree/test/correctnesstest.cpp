@@ -0,0 +1,149 @@
+#include "hotkeytree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+using namespace std;
+
+const int OPERATIONS = 200000;
+const int KEY_RANGE = 5000;
+
+struct EntryChecker {
+	map<int, int>::const_iterator expected;
+	map<int, int>::const_iterator end;
+	bool ok;
+
+	void operator()(int key, int value) {
+		if (expected == end || expected->first != key || expected->second != value) {
+			ok = false;
+		} else {
+			++expected;
+		}
+	}
+};
+
+template <typename Tree>
+bool sameEntries(const Tree& tree, const map<int, int>& expected) {
+	EntryChecker checker = { expected.begin(), expected.end(), true };
+	tree.template forEach<EntryChecker&>(checker);
+
+	return checker.ok && checker.expected == expected.end();
+}
+
+// A small cache and few keys, so that entries are replaced and removes
+// move values between cached nodes all the time
+template <typename Tree>
+void testAgainstMap(const char* name) {
+	HotKeyTree<int, int, Tree> tree(16);
+	map<int, int> expected;
+
+	for (int i = 0; i < OPERATIONS; i++) {
+		// Half of the operations go to a few hot keys
+		int key = rand() % 2 == 0 ? rand() % 8 : rand() % KEY_RANGE;
+
+		switch (rand() % 6) {
+		case 0:
+			tree.put(key, i);
+			expected[key] = i;
+			break;
+		case 1:
+			if (tree.tryRemove(key) != (expected.erase(key) != 0)) {
+				cout << "Fail on " << name << " tryRemove test with number " << key << endl;
+			}
+			break;
+		case 2:
+			if (tree.getOrInsert(key) != expected[key]) {
+				cout << "Fail on " << name << " getOrInsert test with number " << key << endl;
+			}
+			break;
+		case 3:
+			if (expected.count(key) != 0) {
+				*tree.find(key) = i;
+				expected[key] = i;
+			}
+			break;
+		default:
+			const int* value = tree.find(key);
+			map<int, int>::const_iterator position = expected.find(key);
+			if (position == expected.end() ? value != 0 : value == 0 || *value != position->second) {
+				cout << "Fail on " << name << " find test with number " << key << endl;
+			}
+		}
+	}
+
+	if (!sameEntries(tree, expected)) {
+		cout << "Fail on " << name << " contents test\n";
+	}
+
+	HotKeyTree<int, int, Tree> copy(tree);
+	tree.put(-1, 0);
+	for (map<int, int>::const_iterator i = expected.begin(); i != expected.end(); ++i) {
+		if (copy.get(i->first) != i->second) {
+			cout << "Fail on " << name << " copy test with number " << i->first << endl;
+		}
+	}
+	if (copy.contains(-1)) {
+		cout << "Fail on " << name << " copy test\n";
+	}
+
+	copy = HotKeyTree<int, int, Tree>();
+	if (!copy.isEmpty() || copy.contains(0)) {
+		cout << "Fail on " << name << " assignment test\n";
+	}
+}
+
+void testHits() {
+	HotKeyTree<int, int> tree;
+	for (int i = 0; i < KEY_RANGE; i++) {
+		tree.put(i, i);
+	}
+
+	for (int i = 0; i < 1000; i++) {
+		tree.contains(i % 10);
+	}
+	if (tree.hitRate() != 0.99) {
+		cout << "Fail on hit rate test: " << tree.hitRate() << endl;
+	}
+
+	tree.resetCounters();
+	tree.put(0, 42);
+	tree.tryRemove(KEY_RANGE - 1);
+	if (tree.get(0) != 42 || tree.get(1) != 1 || tree.hitRate() != 0) {
+		cout << "Fail on invalidation test\n";
+	}
+}
+
+void testStringKeys() {
+	HotKeyTree<string, int, AATree<string, int, StringPrefixCompare> > tree;
+
+	tree.put("https://example.com/a", 1);
+	tree.put("https://example.com/b", 2);
+	tree.get("https://example.com/a");
+	tree.remove("https://example.com/a");
+
+	if (tree.contains("https://example.com/a") || tree.get("https://example.com/b") != 2) {
+		cout << "Fail on string key test\n";
+	}
+
+	try {
+		tree.remove("https://example.com/a");
+		cout << "Fail on remove of a missing key test\n";
+	} catch (const exception&) {
+	}
+
+	try {
+		tree.get("https://example.com/a");
+		cout << "Fail on get of a missing key test\n";
+	} catch (const exception&) {
+	}
+}
+
+int main() {
+	testAgainstMap<AATree<int, int> >("AATree");
+	testAgainstMap<RedBlackTree<int, int> >("RedBlackTree");
+	testHits();
+	testStringKeys();
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include "hotkeytree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000};
+const int LOOKUPS = 2000000;
+
+// Exponent of the Zipf distribution; the i-th most popular key is looked up
+// with probability proportional to 1 / i^ZIPF_EXPONENT
+const double ZIPF_EXPONENT = 0.99;
+
+vector<int> keys;
+// Popularity order of the keys, independent of the order they are put in
+vector<int> ranked;
+vector<int> zipfLookups;
+vector<int> uniformLookups;
+
+double uniform() {
+	return (rand() + 0.5) / (RAND_MAX + 1.0);
+}
+
+// Draws LOOKUPS ranks from the Zipf distribution over the first count keys
+// and maps rank i to ranked[i], so the hot keys lie anywhere in the key
+// order and were put at arbitrary times
+void generateLookups(size_t count) {
+	ranked.assign(keys.begin(), keys.begin() + count);
+	random_shuffle(ranked.begin(), ranked.end());
+
+	vector<double> cumulative(count);
+	double total = 0;
+	for (size_t i = 0; i < count; i++) {
+		total += 1 / pow(i + 1.0, ZIPF_EXPONENT);
+		cumulative[i] = total;
+	}
+
+	zipfLookups.clear();
+	uniformLookups.clear();
+	for (int i = 0; i < LOOKUPS; i++) {
+		size_t rank = lower_bound(cumulative.begin(), cumulative.end(), uniform() * total) - cumulative.begin();
+		zipfLookups.push_back(ranked[rank < count ? rank : count - 1]);
+		uniformLookups.push_back(keys[static_cast<size_t>(uniform() * count)]);
+	}
+}
+
+template <typename Tree>
+double hitRate(const Tree&) {
+	return 0;
+}
+
+template <typename Key, typename Value, typename Tree>
+double hitRate(const HotKeyTree<Key, Value, Tree>& tree) {
+	return tree.hitRate();
+}
+
+template <typename Tree>
+void testLookups(const char* name, size_t count) {
+	Tree* tree = new Tree();
+	for (size_t i = 0; i < count; i++) {
+		tree->put(keys[i], static_cast<int>(i));
+	}
+
+	long long found = 0;
+
+	clock_t initial = clock();
+	for (int i = 0; i < LOOKUPS; i++) {
+		found += tree->contains(zipfLookups[i]);
+	}
+	clock_t afterZipf = clock();
+	double zipfHitRate = hitRate(*tree);
+
+	for (int i = 0; i < LOOKUPS; i++) {
+		found += tree->contains(uniformLookups[i]);
+	}
+	clock_t afterUniform = clock();
+
+	delete tree;
+
+	cout << name << " zipf " << (afterZipf - initial) * 1000 / CLOCKS_PER_SEC << "ms (hit rate " << zipfHitRate
+		<< ") uniform " << (afterUniform - afterZipf) * 1000 / CLOCKS_PER_SEC << "ms (" << found % 10 << ")" << endl;
+}
+
+int main() {
+	int maxSize = TEST_SIZES[sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]) - 1];
+
+	for (int i = 0; i < maxSize; i++) {
+		keys.push_back(i);
+	}
+	random_shuffle(keys.begin(), keys.end());
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		generateLookups(TEST_SIZES[i]);
+
+		cout << LOOKUPS << " lookups, size " << TEST_SIZES[i] << endl;
+		testLookups<AATree<int, int> >("AATree                  ", TEST_SIZES[i]);
+		testLookups<HotKeyTree<int, int> >("HotKeyTree<AATree>      ", TEST_SIZES[i]);
+		testLookups<RedBlackTree<int, int> >("RedBlackTree            ", TEST_SIZES[i]);
+		testLookups<HotKeyTree<int, int, RedBlackTree<int, int> > >("HotKeyTree<RedBlackTree>", TEST_SIZES[i]);
+		cout << endl;
+	}
+
+	return 0;
+}
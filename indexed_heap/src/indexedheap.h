@@ -0,0 +1,196 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Implicit min heap of the integer ids 0..n-1, each with a priority, for
+// graph algorithms whose items are dense vertex ids. Needs no allocation
+// per item nor handles: the heap is kept as two parallel arrays of ids and
+// priorities, and a third array, by id, holds the position of every id in
+// them. Sifting thus compares adjacent priorities only, Arity at a time.
+// push, decreaseKey and remove take O(log n / log Arity), extractMin
+// O(Arity log n / log Arity) and clear time linear in the size of the heap
+// rather than in n.
+template <typename Priority, int Arity = 4>
+class IndexedHeap {
+	enum { ABSENT = -1 };
+
+	// The heap, in the order of its nodes
+	std::vector<int> ids;
+	std::vector<Priority> priorities;
+	// The position of every id in the heap, ABSENT if it is not in it
+	std::vector<int> positions;
+
+	void place(std::size_t position, int id, const Priority& priority) {
+		ids[position] = id;
+		priorities[position] = priority;
+		positions[id] = static_cast<int>(position);
+	}
+
+	// Moves id, with priority, up from position until its parent is not
+	// greater
+	void siftUp(std::size_t position, int id, Priority priority) {
+		while (position > 0) {
+			std::size_t parent = (position - 1) / Arity;
+			if (!(priority < priorities[parent])) {
+				break;
+			}
+
+			place(position, ids[parent], priorities[parent]);
+			position = parent;
+		}
+
+		place(position, id, priority);
+	}
+
+	// Moves id, with priority, down from position until no child is smaller
+	void siftDown(std::size_t position, int id, Priority priority) {
+		std::size_t count = ids.size();
+
+		for (;;) {
+			std::size_t firstChild = position * Arity + 1;
+			if (firstChild >= count) {
+				break;
+			}
+
+			std::size_t lastChild = firstChild + Arity < count ? firstChild + Arity : count;
+			std::size_t minChild = firstChild;
+			for (std::size_t child = firstChild + 1; child < lastChild; child++) {
+				if (priorities[child] < priorities[minChild]) {
+					minChild = child;
+				}
+			}
+
+			if (!(priorities[minChild] < priority)) {
+				break;
+			}
+
+			place(position, ids[minChild], priorities[minChild]);
+			position = minChild;
+		}
+
+		place(position, id, priority);
+	}
+
+	void removeAt(std::size_t position) {
+		positions[ids[position]] = ABSENT;
+
+		std::size_t last = ids.size() - 1;
+		int lastId = ids[last];
+		Priority lastPriority = priorities[last];
+		ids.pop_back();
+		priorities.pop_back();
+
+		if (position != last) {
+			if (lastPriority < priorities[position]) {
+				siftUp(position, lastId, lastPriority);
+			} else {
+				siftDown(position, lastId, lastPriority);
+			}
+		}
+	}
+
+public:
+	// A heap for the ids 0..idCount-1
+	explicit IndexedHeap(std::size_t idCount = 0)
+		: positions(idCount, ABSENT) {
+	}
+
+	// The number of ids the heap takes
+	std::size_t getIdCount() const {
+		return positions.size();
+	}
+
+	// Makes the heap take the ids 0..idCount-1 and empties it
+	void resize(std::size_t idCount) {
+		clear();
+		positions.resize(idCount, ABSENT);
+	}
+
+	// Reserves room for size ids in the heap at once
+	void reserve(std::size_t size) {
+		ids.reserve(size);
+		priorities.reserve(size);
+	}
+
+	bool contains(int id) const {
+		return positions[id] != ABSENT;
+	}
+
+	// id must not be in the heap
+	void push(int id, const Priority& priority) {
+		ids.push_back(id);
+		priorities.push_back(priority);
+		siftUp(ids.size() - 1, id, priority);
+	}
+
+	// id must be in the heap with a priority not smaller than priority
+	void decreaseKey(int id, const Priority& priority) {
+		siftUp(positions[id], id, priority);
+	}
+
+	// Pushes id if it is not in the heap and decreases its priority if it
+	// is greater than priority. Returns whether the heap changed.
+	bool pushOrDecrease(int id, const Priority& priority) {
+		if (!contains(id)) {
+			push(id, priority);
+			return true;
+		}
+
+		if (priority < priorities[positions[id]]) {
+			decreaseKey(id, priority);
+			return true;
+		}
+
+		return false;
+	}
+
+	// The priority of id, which must be in the heap
+	const Priority& getPriority(int id) const {
+		return priorities[positions[id]];
+	}
+
+	int getMinId() const {
+		return ids[0];
+	}
+
+	const Priority& getMinPriority() const {
+		return priorities[0];
+	}
+
+	void extractMin() {
+		removeAt(0);
+	}
+
+	// id must be in the heap
+	void remove(int id) {
+		removeAt(positions[id]);
+	}
+
+	bool isEmpty() const {
+		return ids.empty();
+	}
+
+	std::size_t getSize() const {
+		return ids.size();
+	}
+
+	// Empties the heap in time linear in its size
+	void clear() {
+		for (std::size_t i = 0; i < ids.size(); i++) {
+			positions[ids[i]] = ABSENT;
+		}
+		ids.clear();
+		priorities.clear();
+	}
+
+	void swap(IndexedHeap& heap) {
+		ids.swap(heap.ids);
+		priorities.swap(heap.priorities);
+		positions.swap(heap.positions);
+	}
+};
+
+#endif
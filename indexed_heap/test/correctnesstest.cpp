@@ -0,0 +1,109 @@
+#include "indexedheap.h"
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+using namespace std;
+
+const int ID_COUNT = 5000;
+const int ROUNDS = 200;
+
+// Pushes, decreases, removes and extracts random ids, comparing every
+// minimum with a set of (priority, id) pairs
+template <int Arity>
+void testAgainstSet(const char* name) {
+	IndexedHeap<int, Arity> heap(ID_COUNT);
+	set<pair<int, int> > expected;
+	vector<int> priority(ID_COUNT);
+
+	for (int round = 0; round < ROUNDS; round++) {
+		for (int i = 0; i < 300; i++) {
+			int id = rand() % ID_COUNT;
+			int newPriority = rand() % 100000;
+
+			if (heap.contains(id)) {
+				if (newPriority < priority[id]) {
+					heap.decreaseKey(id, newPriority);
+				} else if (rand() % 3 == 0) {
+					heap.remove(id);
+					expected.erase(make_pair(priority[id], id));
+					continue;
+				} else if (heap.pushOrDecrease(id, newPriority)) {
+					cout << "Fail on " << name << " pushOrDecrease test" << endl;
+					return;
+				} else {
+					continue;
+				}
+				expected.erase(make_pair(priority[id], id));
+			} else {
+				heap.push(id, newPriority);
+			}
+
+			priority[id] = newPriority;
+			expected.insert(make_pair(newPriority, id));
+		}
+
+		for (int i = 0; i < 150 && !expected.empty(); i++) {
+			if (heap.getMinPriority() != expected.begin()->first
+					|| heap.getPriority(heap.getMinId()) != expected.begin()->first) {
+				cout << "Fail on " << name << " minimum test" << endl;
+				return;
+			}
+
+			expected.erase(make_pair(heap.getMinPriority(), heap.getMinId()));
+			heap.extractMin();
+		}
+
+		if (heap.getSize() != expected.size()) {
+			cout << "Fail on " << name << " size test" << endl;
+			return;
+		}
+	}
+
+	for (int id = 0; id < ID_COUNT; id++) {
+		if (heap.contains(id) != (expected.count(make_pair(priority[id], id)) != 0)) {
+			cout << "Fail on " << name << " contains test" << endl;
+			return;
+		}
+	}
+
+	heap.clear();
+	for (int id = 0; id < ID_COUNT; id++) {
+		if (heap.contains(id)) {
+			cout << "Fail on " << name << " clear test" << endl;
+			return;
+		}
+	}
+	if (!heap.isEmpty()) {
+		cout << "Fail on " << name << " clear test" << endl;
+	}
+}
+
+void testResize() {
+	IndexedHeap<double> heap;
+
+	heap.resize(10);
+	heap.push(9, 2.5);
+	heap.push(3, 1.5);
+	heap.resize(20);
+
+	if (!heap.isEmpty() || heap.contains(3) || heap.getIdCount() != 20) {
+		cout << "Fail on resize test" << endl;
+	}
+
+	heap.push(19, 0.5);
+	heap.pushOrDecrease(19, 0.25);
+	if (heap.getMinId() != 19 || heap.getMinPriority() != 0.25) {
+		cout << "Fail on resize test" << endl;
+	}
+}
+
+int main() {
+	testAgainstSet<2>("IndexedHeap<2>");
+	testAgainstSet<4>("IndexedHeap<4>");
+	testAgainstSet<8>("IndexedHeap<8>");
+	testResize();
+
+	return 0;
+}
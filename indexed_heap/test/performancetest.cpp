@@ -0,0 +1,194 @@
+#include "indexedheap.h"
+#include "../../dary_heap/src/daryheap.h"
+#include "../../fibonacci_heap/src/fibheap.h"
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <vector>
+using namespace std;
+
+// Vertices and edges of the random graphs
+const int TEST_SIZES[][2] = {{10000, 100000}, {100000, 1000000}, {1000000, 4000000}};
+// Searches of the short query test and the vertices each settles
+const int QUERIES = 1000;
+const int SETTLED_PER_QUERY = 100;
+
+struct Edge {
+	int dest;
+	int weight;
+};
+
+struct VertexDistance {
+	int vertex;
+	int distance;
+
+	VertexDistance(int vertex, int distance)
+		: vertex(vertex), distance(distance) {
+	}
+
+	bool operator<(const VertexDistance& other) const {
+		return distance < other.distance;
+	}
+};
+
+vector<vector<Edge> > neighbors;
+
+int random(int bound) {
+	return static_cast<int>((static_cast<long long>(rand()) * (RAND_MAX + 1LL) + rand()) % bound);
+}
+
+void generateGraph(int vertices, int edges) {
+	neighbors.assign(vertices, vector<Edge>());
+
+	for (int i = 0; i < edges; i++) {
+		Edge edge = { random(vertices), 1 + random(1000) };
+		neighbors[random(vertices)].push_back(edge);
+	}
+}
+
+// Dijkstra from source that stops after settling limit vertices, with a
+// heap of vertex ids. Appends the settled vertices to settledVertices.
+template <int Arity>
+long long indexedDijkstra(IndexedHeap<int, Arity>& heap, vector<int>& distance, int source, int limit,
+		vector<int>& settledVertices) {
+	long long sum = 0;
+
+	heap.push(source, 0);
+	for (int settled = 0; settled < limit && !heap.isEmpty(); settled++) {
+		int vertex = heap.getMinId();
+		int vertexDistance = heap.getMinPriority();
+		heap.extractMin();
+		distance[vertex] = vertexDistance;
+		settledVertices.push_back(vertex);
+		sum += vertexDistance;
+
+		for (size_t i = 0; i < neighbors[vertex].size(); i++) {
+			const Edge& edge = neighbors[vertex][i];
+			if (distance[edge.dest] == numeric_limits<int>::max()) {
+				heap.pushOrDecrease(edge.dest, vertexDistance + edge.weight);
+			}
+		}
+	}
+
+	return sum;
+}
+
+// The same with a heap of (vertex, distance) keys and an Element for
+// every vertex reached
+template <typename Heap>
+long long handleDijkstra(vector<int>& distance, int source, int limit) {
+	vector<typename Heap::Element> elements(neighbors.size());
+	vector<bool> inHeap(neighbors.size(), false);
+	Heap heap;
+	long long sum = 0;
+
+	elements[source] = heap.insert(VertexDistance(source, 0));
+	inHeap[source] = true;
+	for (int settled = 0; settled < limit && !heap.isEmpty(); settled++) {
+		VertexDistance current = heap.getMin();
+		heap.extractMin();
+		inHeap[current.vertex] = false;
+		distance[current.vertex] = current.distance;
+		sum += current.distance;
+
+		for (size_t i = 0; i < neighbors[current.vertex].size(); i++) {
+			const Edge& edge = neighbors[current.vertex][i];
+			int newDistance = current.distance + edge.weight;
+
+			if (inHeap[edge.dest]) {
+				if (newDistance < elements[edge.dest].getKey().distance) {
+					heap.decreaseKey(elements[edge.dest], VertexDistance(edge.dest, newDistance));
+				}
+			} else if (distance[edge.dest] == numeric_limits<int>::max()) {
+				elements[edge.dest] = heap.insert(VertexDistance(edge.dest, newDistance));
+				inHeap[edge.dest] = true;
+			}
+		}
+	}
+
+	return sum;
+}
+
+template <int Arity>
+void testIndexedDijkstra(const char* name) {
+	clock_t initial = clock();
+
+	IndexedHeap<int, Arity> heap(neighbors.size());
+	vector<int> distance(neighbors.size(), numeric_limits<int>::max());
+	vector<int> settledVertices;
+	long long sum = indexedDijkstra(heap, distance, 0, neighbors.size(), settledVertices);
+
+	clock_t afterDijkstra = clock();
+
+	cout << name << " " << (afterDijkstra - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+template <typename Heap>
+void testHandleDijkstra(const char* name) {
+	clock_t initial = clock();
+
+	vector<int> distance(neighbors.size(), numeric_limits<int>::max());
+	long long sum = handleDijkstra<Heap>(distance, 0, neighbors.size());
+
+	clock_t afterDijkstra = clock();
+
+	cout << name << " " << (afterDijkstra - initial) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+// QUERIES searches from random sources that each settle
+// SETTLED_PER_QUERY vertices. The indexed heap and the distances are
+// reused and reset in time linear in the vertices the search reached,
+// while the Elements of the Fibonacci heap take an array of all vertices.
+void testShortQueries() {
+	vector<int> sources;
+	for (int i = 0; i < QUERIES; i++) {
+		sources.push_back(random(neighbors.size()));
+	}
+
+	clock_t initial = clock();
+
+	IndexedHeap<int> heap(neighbors.size());
+	vector<int> distance(neighbors.size(), numeric_limits<int>::max());
+	vector<int> settledVertices;
+	long long indexedSum = 0;
+	for (int i = 0; i < QUERIES; i++) {
+		indexedSum += indexedDijkstra(heap, distance, sources[i], SETTLED_PER_QUERY, settledVertices);
+
+		for (size_t j = 0; j < settledVertices.size(); j++) {
+			distance[settledVertices[j]] = numeric_limits<int>::max();
+		}
+		settledVertices.clear();
+		heap.clear();
+	}
+
+	clock_t afterIndexed = clock();
+
+	long long handleSum = 0;
+	for (int i = 0; i < QUERIES; i++) {
+		vector<int> distance(neighbors.size(), numeric_limits<int>::max());
+		handleSum += handleDijkstra<FibonacciHeap<VertexDistance> >(distance, sources[i], SETTLED_PER_QUERY);
+	}
+
+	clock_t afterHandle = clock();
+
+	cout << QUERIES << " short queries: IndexedHeap " << (afterIndexed - initial) * 1000 / CLOCKS_PER_SEC
+		<< "ms, FibonacciHeap " << (afterHandle - afterIndexed) * 1000 / CLOCKS_PER_SEC
+		<< "ms (" << (indexedSum + handleSum) % 10 << ")" << endl;
+}
+
+int main() {
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		generateGraph(TEST_SIZES[i][0], TEST_SIZES[i][1]);
+
+		cout << "Dijkstra, " << TEST_SIZES[i][0] << " vertices, " << TEST_SIZES[i][1] << " edges" << endl;
+		testIndexedDijkstra<4>("IndexedHeap<4>     ");
+		testIndexedDijkstra<8>("IndexedHeap<8>     ");
+		testHandleDijkstra<DaryHeap<VertexDistance, 4> >("DaryHeap<4>        ");
+		testHandleDijkstra<FibonacciHeap<VertexDistance> >("FibonacciHeap      ");
+		testShortQueries();
+		cout << endl;
+	}
+
+	return 0;
+}
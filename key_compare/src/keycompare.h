@@ -0,0 +1,95 @@
+#ifndef KEYCOMPARE_H
+#define KEYCOMPARE_H
+
+#include <cstddef>
+#include <string>
+
+// Key ordering policies for the search trees. A policy provides
+//
+//   struct Cache;
+//   static Cache cache(const Key& key);
+//   static int compare(const Key& a, const Cache& aCache, const Key& b, const Cache& bCache);
+//
+// compare returns a negative number, zero or a positive number as a is less
+// than, equal to or greater than b, so a tree decides every node it visits
+// with one call. Every node stores the cache of its key next to it and a
+// search computes the cache of the key it looks for once, which lets a
+// policy answer most comparisons from the caches alone.
+
+// Orders keys by operator< and caches nothing
+template <typename Key>
+struct ThreeWayCompare {
+	struct Cache {
+	};
+
+	static Cache cache(const Key&) {
+		return Cache();
+	}
+
+	static int compare(const Key& a, const Cache&, const Key& b, const Cache&) {
+		if (a < b) {
+			return -1;
+		} else if (b < a) {
+			return 1;
+		} else {
+			return 0;
+		}
+	}
+};
+
+template <>
+struct ThreeWayCompare<std::string> {
+	struct Cache {
+	};
+
+	static Cache cache(const std::string&) {
+		return Cache();
+	}
+
+	static int compare(const std::string& a, const Cache&, const std::string& b, const Cache&) {
+		return a.compare(b);
+	}
+};
+
+// Orders strings like ThreeWayCompare<std::string>, but caches their first
+// PREFIX_SIZE bytes as a big-endian integer, zero padded. Integers compare
+// like the prefixes they hold, so keys that differ within the prefix are
+// ordered without touching their buffers, and the others only compare the
+// bytes after it. Worth it for keys that usually differ early; keys that
+// share a long constant head (a URL scheme and host, say) should be stored
+// without it.
+struct StringPrefixCompare {
+	static const std::size_t PREFIX_SIZE = sizeof(unsigned long long);
+
+	struct Cache {
+		unsigned long long prefix;
+	};
+
+	static Cache cache(const std::string& key) {
+		Cache result;
+		result.prefix = 0;
+
+		std::size_t length = key.size() < PREFIX_SIZE ? key.size() : PREFIX_SIZE;
+		for (std::size_t i = 0; i < length; i++) {
+			result.prefix |= static_cast<unsigned long long>(static_cast<unsigned char>(key[i])) << (8 * (PREFIX_SIZE - 1 - i));
+		}
+
+		return result;
+	}
+
+	static int compare(const std::string& a, const Cache& aCache, const std::string& b, const Cache& bCache) {
+		if (aCache.prefix != bCache.prefix) {
+			return aCache.prefix < bCache.prefix ? -1 : 1;
+		}
+
+		// A short key may have been padded with zeros that equal real bytes
+		// of the other key, so only skip the prefix when both are full
+		if (a.size() < PREFIX_SIZE || b.size() < PREFIX_SIZE) {
+			return a.compare(b);
+		}
+
+		return a.compare(PREFIX_SIZE, std::string::npos, b, PREFIX_SIZE, std::string::npos);
+	}
+};
+
+#endif
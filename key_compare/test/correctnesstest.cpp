@@ -0,0 +1,79 @@
+#include "keycompare.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+vector<string> keys;
+
+int sign(int n) {
+	return (n > 0) - (n < 0);
+}
+
+void testPrefixOrder() {
+	StringPrefixCompare::Cache aCache;
+	StringPrefixCompare::Cache bCache;
+
+	for (size_t i = 0; i < keys.size(); i++) {
+		const string& a = keys[i];
+		const string& b = keys[(i * 7919 + 1) % keys.size()];
+		aCache = StringPrefixCompare::cache(a);
+		bCache = StringPrefixCompare::cache(b);
+
+		if (sign(StringPrefixCompare::compare(a, aCache, b, bCache)) != sign(a.compare(b))) {
+			cout << "Fail on prefix order with \"" << a << "\" and \"" << b << "\"" << endl;
+		}
+	}
+}
+
+template <typename Tree>
+void testTree(const char* name) {
+	Tree tree;
+	map<string, int> expected;
+
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (i % 3 == 2) {
+			if (tree.tryRemove(keys[i / 2]) != (expected.erase(keys[i / 2]) > 0)) {
+				cout << "Fail on " << name << " remove of \"" << keys[i / 2] << "\"" << endl;
+			}
+		} else {
+			tree.put(keys[i], static_cast<int>(i));
+			expected[keys[i]] = static_cast<int>(i);
+		}
+	}
+
+	for (size_t i = 0; i < keys.size(); i++) {
+		const int* value = tree.find(keys[i]);
+		map<string, int>::const_iterator entry = expected.find(keys[i]);
+
+		if ((value == 0) != (entry == expected.end()) || (value != 0 && *value != entry->second)) {
+			cout << "Fail on " << name << " lookup of \"" << keys[i] << "\"" << endl;
+		}
+	}
+}
+
+int main() {
+	// Short keys, keys with embedded zeros and keys sharing prefixes of
+	// every length around PREFIX_SIZE
+	const char alphabet[] = {'a', 'b', '\0', '\xff'};
+	for (int i = 0; i < 20000; i++) {
+		string key = i % 2 == 0 ? "prefix/" : "";
+		int length = rand() % 12;
+		for (int j = 0; j < length; j++) {
+			key += alphabet[rand() % sizeof(alphabet)];
+		}
+		keys.push_back(key);
+	}
+
+	testPrefixOrder();
+	testTree<AATree<string, int> >("AATree");
+	testTree<AATree<string, int, StringPrefixCompare> >("AATree with prefixes");
+	testTree<RedBlackTree<string, int> >("RedBlackTree");
+	testTree<RedBlackTree<string, int, true, StringPrefixCompare> >("RedBlackTree with prefixes");
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include "keycompare.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000};
+
+vector<string> keys;
+
+// Host and path of a URL, with the scheme left out as StringPrefixCompare
+// suggests
+string randomUrl() {
+	static const char* const WORDS[] = {"news", "shop", "blog", "img", "static", "api", "docs", "video"};
+	string url = WORDS[rand() % 8];
+	url += to_string(rand() % 100000) + ".example.com";
+
+	int segments = 1 + rand() % 4;
+	for (int i = 0; i < segments; i++) {
+		url += "/";
+		url += WORDS[rand() % 8];
+		url += to_string(rand() % 1000);
+	}
+
+	return url;
+}
+
+template <typename Tree>
+void testTree(const char* name, size_t count) {
+	Tree* tree = new Tree();
+
+	clock_t initial = clock();
+	for (size_t i = 0; i < count; i++) {
+		tree->put(keys[i], static_cast<int>(i));
+	}
+	clock_t afterPut = clock();
+
+	long long sum = 0;
+	for (size_t i = 0; i < count; i++) {
+		sum += *tree->find(keys[(i * 7919) % count]);
+	}
+	clock_t afterGet = clock();
+
+	delete tree;
+
+	cout << name << " put " << (afterPut - initial) * 1000 / CLOCKS_PER_SEC << "ms get "
+		<< (afterGet - afterPut) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+int main() {
+	int maxSize = TEST_SIZES[sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]) - 1];
+
+	for (int i = 0; i < maxSize; i++) {
+		keys.push_back(randomUrl());
+	}
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		cout << "URL keys, size " << TEST_SIZES[i] << endl;
+		testTree<AATree<string, int> >("AATree                          ", TEST_SIZES[i]);
+		testTree<AATree<string, int, StringPrefixCompare> >("AATree with prefixes            ", TEST_SIZES[i]);
+		testTree<RedBlackTree<string, int> >("RedBlackTree                    ", TEST_SIZES[i]);
+		testTree<RedBlackTree<string, int, false, StringPrefixCompare> >("RedBlackTree with prefixes      ", TEST_SIZES[i]);
+		cout << endl;
+	}
+
+	return 0;
+}
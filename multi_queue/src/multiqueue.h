@@ -0,0 +1,217 @@
+#ifndef MULTIQUEUE_H
+#define MULTIQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../dary_heap/src/daryheap.h"
+#include "../../redblack_tree/src/redblacktree.h"
+
+// Relaxed priority queue that many threads may use at once, made of several
+// sequential heaps, each behind its own mutex:
+//  - insert adds the key to a random heap whose lock is free.
+//  - tryExtractMin picks two random heaps and extracts the minimum of the
+//    one with the smaller minimum. The minimums are read from a copy every
+//    heap publishes, so only the chosen heap is locked.
+// With queuesPerThread heaps per thread a thread rarely finds a lock taken,
+// and an extracted key is expected to rank within a small multiple of the
+// heap count among the keys in the queue, instead of being the smallest.
+// Heap is any heap with the interface of FibonacciHeap. Key must be
+// trivially copyable, for the published minimums.
+template <typename Key, typename Heap = DaryHeap<Key, 4> >
+class MultiQueue {
+	static_assert(std::is_trivially_copyable<Key>::value, "MultiQueue requires a trivially copyable Key");
+
+	struct TraceEvent {
+		unsigned long long sequence;
+		Key key;
+		bool isInsert;
+	};
+
+	// On its own cache lines, so threads locking neighbouring heaps do not
+	// contend for them
+	struct alignas(64) Queue {
+		std::mutex mutex;
+		Heap heap;
+		// Copies of the size and the minimum of heap, for reading without
+		// the lock. top is stale when size is 0.
+		std::atomic<std::size_t> size;
+		std::atomic<Key> top;
+		// The operations on heap while tracing
+		std::vector<TraceEvent> trace;
+
+		Queue()
+			: size(0) {
+		}
+	};
+
+	std::size_t queueCount;
+	std::unique_ptr<Queue[]> queues;
+	bool isTracing;
+	// The order of all traced operations, taken under the lock of the heap
+	// each one is on
+	std::atomic<unsigned long long> sequence;
+
+	MultiQueue(const MultiQueue&);
+	MultiQueue& operator=(const MultiQueue&);
+
+	// xorshift64, with a state per thread
+	static std::size_t random(std::size_t bound) {
+		static thread_local unsigned long long state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+
+		return state % bound;
+	}
+
+	// Whether first holds a smaller minimum than second, as last published
+	static bool isBetter(const Queue& first, const Queue& second) {
+		if (first.size.load(std::memory_order_relaxed) == 0) {
+			return false;
+		}
+
+		return second.size.load(std::memory_order_relaxed) == 0
+			|| first.top.load(std::memory_order_relaxed) < second.top.load(std::memory_order_relaxed);
+	}
+
+	static void publish(Queue& queue) {
+		queue.size.store(queue.heap.getSize(), std::memory_order_relaxed);
+		if (!queue.heap.isEmpty()) {
+			queue.top.store(queue.heap.getMin(), std::memory_order_relaxed);
+		}
+	}
+
+	void trace(Queue& queue, const Key& key, bool isInsert) {
+		TraceEvent event = { sequence.fetch_add(1, std::memory_order_relaxed), key, isInsert };
+		queue.trace.push_back(event);
+	}
+
+	// The queue must be locked and not empty
+	void extractFrom(Queue& queue, Key& key) {
+		key = queue.heap.getMin();
+		if (isTracing) {
+			trace(queue, key, false);
+		}
+		queue.heap.extractMin();
+		publish(queue);
+	}
+
+public:
+	// With isTracing set every operation is logged for getRankErrors, which
+	// adds a shared counter to every operation, so only measure with it
+	explicit MultiQueue(int threads, int queuesPerThread = 2, bool isTracing = false)
+		: queueCount(std::max(threads * queuesPerThread, 1)), queues(new Queue[queueCount]), isTracing(isTracing),
+			sequence(1) {
+	}
+
+	void insert(const Key& key) {
+		// Gives up on finding a free lock after a round of tries, so a
+		// queue with few heaps blocks instead of spinning
+		Queue* queue = 0;
+		bool isLocked = false;
+		for (std::size_t attempt = 0; attempt < queueCount && !isLocked; attempt++) {
+			queue = &queues[random(queueCount)];
+			isLocked = queue->mutex.try_lock();
+		}
+		if (!isLocked) {
+			queue->mutex.lock();
+		}
+		std::lock_guard<std::mutex> lock(queue->mutex, std::adopt_lock);
+
+		queue->heap.insert(key);
+		if (isTracing) {
+			trace(*queue, key, true);
+		}
+		publish(*queue);
+	}
+
+	// Stores a key that was among the smallest in key and returns true, or
+	// returns false if every heap was empty when it was looked at. After a
+	// round of random choices that found nothing, looks at every heap in
+	// turn, so a queue drained by one thread is seen empty only when it is.
+	bool tryExtractMin(Key& key) {
+		for (std::size_t attempt = 0; attempt < queueCount; attempt++) {
+			Queue* first = &queues[random(queueCount)];
+			Queue* second = &queues[random(queueCount)];
+			if (isBetter(*second, *first)) {
+				std::swap(first, second);
+			}
+
+			if (first->size.load(std::memory_order_relaxed) == 0 || !first->mutex.try_lock()) {
+				continue;
+			}
+			std::lock_guard<std::mutex> lock(first->mutex, std::adopt_lock);
+
+			if (!first->heap.isEmpty()) {
+				extractFrom(*first, key);
+				return true;
+			}
+		}
+
+		for (std::size_t i = 0; i < queueCount; i++) {
+			std::lock_guard<std::mutex> lock(queues[i].mutex);
+
+			if (!queues[i].heap.isEmpty()) {
+				extractFrom(queues[i], key);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Exact only while no operation is in progress
+	std::size_t getSize() const {
+		std::size_t result = 0;
+		for (std::size_t i = 0; i < queueCount; i++) {
+			result += queues[i].size.load(std::memory_order_relaxed);
+		}
+
+		return result;
+	}
+
+	std::size_t getQueueCount() const {
+		return queueCount;
+	}
+
+	// Stores in errors the rank error of every traced extraction in the
+	// order they happened: the number of keys in the queue smaller than
+	// the extracted one at that moment, 0 for an exact priority queue.
+	// Replays the trace on an order statistics tree in O(n log n); call it
+	// while no operation is in progress.
+	void getRankErrors(std::vector<std::size_t>& errors) const {
+		std::vector<TraceEvent> events;
+		for (std::size_t i = 0; i < queueCount; i++) {
+			events.insert(events.end(), queues[i].trace.begin(), queues[i].trace.end());
+		}
+		std::sort(events.begin(), events.end(), [](const TraceEvent& first, const TraceEvent& second) {
+			return first.sequence < second.sequence;
+		});
+
+		// Equal keys are told apart by the sequence of their insert, which
+		// is never 0
+		RedBlackTree<std::pair<Key, unsigned long long>, char, true> keys;
+		errors.clear();
+		for (std::size_t i = 0; i < events.size(); i++) {
+			if (events[i].isInsert) {
+				keys.put(std::make_pair(events[i].key, events[i].sequence), 0);
+			} else {
+				std::size_t rank = keys.rank(std::make_pair(events[i].key, 0ULL));
+				errors.push_back(rank);
+				keys.remove(keys.select(rank));
+			}
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "multiqueue.h"
+#include "../../fibonacci_heap/src/fibheap.h"
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int THREADS = 4;
+const int KEYS_PER_THREAD = 20000;
+
+// With a single heap the queue is exact
+void testSingleHeap() {
+	MultiQueue<int> queue(1, 1, true);
+	multiset<int> expected;
+
+	for (int round = 0; round < 100; round++) {
+		for (int i = 0; i < 200; i++) {
+			int key = rand() % 1000;
+			queue.insert(key);
+			expected.insert(key);
+		}
+
+		for (int i = 0; i < 150; i++) {
+			int key;
+			if (!queue.tryExtractMin(key) || key != *expected.begin()) {
+				cout << "Fail on single heap test" << endl;
+				return;
+			}
+			expected.erase(expected.begin());
+		}
+	}
+
+	vector<size_t> errors;
+	queue.getRankErrors(errors);
+	if (errors.size() != 100 * 150) {
+		cout << "Fail on single heap trace test" << endl;
+	}
+	for (size_t i = 0; i < errors.size(); i++) {
+		if (errors[i] != 0) {
+			cout << "Fail on single heap rank error test" << endl;
+			return;
+		}
+	}
+}
+
+// The rank errors of the trace match those counted on a multiset
+void testRankErrors() {
+	MultiQueue<int> queue(4, 2, true);
+	multiset<int> keys;
+	vector<size_t> expected;
+
+	for (int i = 0; i < 20000; i++) {
+		if (rand() % 3 != 0) {
+			int key = rand() % 5000;
+			queue.insert(key);
+			keys.insert(key);
+		} else {
+			int key;
+			if (queue.tryExtractMin(key) != !keys.empty()) {
+				cout << "Fail on rank errors extract test" << endl;
+				return;
+			}
+			if (!keys.empty()) {
+				multiset<int>::iterator found = keys.lower_bound(key);
+				expected.push_back(distance(keys.begin(), found));
+				keys.erase(found);
+			}
+		}
+	}
+
+	vector<size_t> errors;
+	queue.getRankErrors(errors);
+	if (errors != expected) {
+		cout << "Fail on rank errors test" << endl;
+	}
+	if (queue.getSize() != keys.size()) {
+		cout << "Fail on rank errors size test" << endl;
+	}
+}
+
+// Every thread inserts keys of its own and extracts as many; together
+// with a final drain, every key comes out exactly once
+template <typename Heap>
+void work(MultiQueue<int, Heap>* queue, int index, vector<int>* extracted) {
+	for (int i = 0; i < KEYS_PER_THREAD; i++) {
+		queue->insert(i * THREADS + index);
+
+		int key;
+		if (i % 2 == 1) {
+			for (int j = 0; j < 2; j++) {
+				if (queue->tryExtractMin(key)) {
+					extracted->push_back(key);
+				}
+			}
+		}
+	}
+}
+
+template <typename Heap>
+void testConcurrent(const char* name) {
+	MultiQueue<int, Heap> queue(THREADS, 2, true);
+	vector<vector<int> > extracted(THREADS + 1);
+	vector<thread> workers;
+
+	for (int i = 0; i < THREADS; i++) {
+		workers.push_back(thread(work<Heap>, &queue, i, &extracted[i]));
+	}
+	for (int i = 0; i < THREADS; i++) {
+		workers[i].join();
+	}
+
+	int key;
+	while (queue.tryExtractMin(key)) {
+		extracted[THREADS].push_back(key);
+	}
+	if (queue.getSize() != 0) {
+		cout << "Fail on " << name << " size test" << endl;
+	}
+
+	vector<bool> isSeen(THREADS * KEYS_PER_THREAD, false);
+	size_t count = 0;
+	for (size_t i = 0; i < extracted.size(); i++) {
+		for (size_t j = 0; j < extracted[i].size(); j++) {
+			int key = extracted[i][j];
+			if (key < 0 || key >= THREADS * KEYS_PER_THREAD || isSeen[key]) {
+				cout << "Fail on " << name << " duplicate test" << endl;
+				return;
+			}
+			isSeen[key] = true;
+			count++;
+		}
+	}
+	if (count != isSeen.size()) {
+		cout << "Fail on " << name << " lost key test" << endl;
+	}
+
+	vector<size_t> errors;
+	queue.getRankErrors(errors);
+	if (errors.size() != count) {
+		cout << "Fail on " << name << " trace test" << endl;
+	}
+}
+
+int main() {
+	testSingleHeap();
+	testRankErrors();
+	testConcurrent<DaryHeap<int, 4> >("DaryHeap");
+	testConcurrent<FibonacciHeap<int> >("FibonacciHeap");
+
+	return 0;
+}
@@ -0,0 +1,134 @@
+#include "multiqueue.h"
+#include "../../fibonacci_heap/src/fibheap.h"
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+using namespace std;
+
+const int THREAD_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+// Keys in the queue before the threads start, which every insert and
+// extraction pair keeps the size at
+const int PREFILL = 1000000;
+const int KEY_RANGE = 100000000;
+// Pairs of insert and tryExtractMin over all threads
+const int OPERATIONS = 4000000;
+// Pairs in the traced runs that measure rank errors
+const int TRACED_OPERATIONS = 400000;
+
+// The baseline: one heap behind a single mutex
+template <typename Heap>
+class GlobalLockQueue {
+	Heap heap;
+	mutex heapMutex;
+public:
+	explicit GlobalLockQueue(int) {
+	}
+
+	void insert(int key) {
+		lock_guard<mutex> lock(heapMutex);
+		heap.insert(key);
+	}
+
+	bool tryExtractMin(int& key) {
+		lock_guard<mutex> lock(heapMutex);
+		if (heap.isEmpty()) {
+			return false;
+		}
+
+		key = heap.getMin();
+		heap.extractMin();
+		return true;
+	}
+};
+
+template <typename Queue>
+void work(Queue* queue, int operations, unsigned seed, long long* sum) {
+	mt19937 random(seed);
+	long long result = 0;
+
+	for (int i = 0; i < operations; i++) {
+		queue->insert(random() % KEY_RANGE);
+
+		int key;
+		if (queue->tryExtractMin(key)) {
+			result += key;
+		}
+	}
+
+	*sum = result;
+}
+
+template <typename Queue>
+void prefill(Queue& queue) {
+	mt19937 random(0);
+	for (int i = 0; i < PREFILL; i++) {
+		queue.insert(random() % KEY_RANGE);
+	}
+}
+
+template <typename Queue>
+void runThreads(Queue& queue, int threads, int operations) {
+	vector<thread> workers;
+	vector<long long> sums(threads);
+
+	for (int i = 0; i < threads; i++) {
+		workers.push_back(thread(work<Queue>, &queue, operations / threads, i + 1, &sums[i]));
+	}
+	for (int i = 0; i < threads; i++) {
+		workers[i].join();
+	}
+}
+
+template <typename Queue>
+void testQueue(const char* name, int threads) {
+	Queue queue(threads);
+	prefill(queue);
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	runThreads(queue, threads, OPERATIONS);
+	chrono::steady_clock::time_point current = chrono::steady_clock::now();
+
+	double seconds = chrono::duration<double>(current - initial).count();
+	cout << name << " " << static_cast<long long>(2 * OPERATIONS / seconds) << " ops/s" << endl;
+}
+
+// The rank errors of a traced run. Tracing adds a shared counter to every
+// operation, so these runs are not timed.
+template <typename Heap>
+void testRankErrors(const char* name, int threads) {
+	MultiQueue<int, Heap> queue(threads, 2, true);
+	prefill(queue);
+	runThreads(queue, threads, TRACED_OPERATIONS);
+
+	vector<size_t> errors;
+	queue.getRankErrors(errors);
+
+	double sum = 0;
+	size_t maximum = 0;
+	for (size_t i = 0; i < errors.size(); i++) {
+		sum += errors[i];
+		maximum = errors[i] > maximum ? errors[i] : maximum;
+	}
+
+	cout << name << " rank error mean " << (errors.empty() ? 0 : sum / errors.size()) << ", max " << maximum
+		<< " (" << queue.getQueueCount() << " heaps)" << endl;
+}
+
+int main() {
+	for (size_t t = 0; t < sizeof(THREAD_COUNTS)/sizeof(THREAD_COUNTS[0]); t++) {
+		int threads = THREAD_COUNTS[t];
+		cout << "Testing with " << threads << " threads" << endl;
+
+		testQueue<GlobalLockQueue<FibonacciHeap<int> > >("Global mutex FibonacciHeap  ", threads);
+		testQueue<GlobalLockQueue<DaryHeap<int, 4> > >("Global mutex DaryHeap<4>    ", threads);
+		testQueue<MultiQueue<int, FibonacciHeap<int> > >("MultiQueue of FibonacciHeap ", threads);
+		testQueue<MultiQueue<int, DaryHeap<int, 4> > >("MultiQueue of DaryHeap<4>   ", threads);
+		testRankErrors<DaryHeap<int, 4> >("MultiQueue of DaryHeap<4>   ", threads);
+		cout << endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,311 @@
+#ifndef PAIRINGHEAP_H
+#define PAIRINGHEAP_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../../fibonacci_heap/src/poolallocator.h"
+
+// Min pairing heap with the interface of FibonacciHeap. insert, getMin and
+// mergeWith take O(1), extractMin and remove amortized O(log n) and
+// decreaseKey amortized o(log n), with much smaller constants than a
+// Fibonacci heap: a node has three links and the heap one tree.
+//
+// Nodes are allocated with Allocator<Node> (see poolallocator.h).
+template <typename Key, template <typename> class Allocator = PoolAllocator>
+class PairingHeap {
+	struct Node {
+		Node* child;
+		Node* next;
+		// The previous sibling, or the parent for the first child
+		Node* previous;
+		Key key;
+
+		Node(const Key& key)
+			: child(0), next(0), previous(0), key(key) {
+		}
+	};
+
+	Node* root;
+	std::size_t size;
+	Allocator<Node> allocator;
+
+	Node* createNode(const Key& key) {
+		Node* node = allocator.allocate();
+
+		try {
+			return new (node) Node(key);
+		} catch (...) {
+			allocator.deallocate(node);
+			throw;
+		}
+	}
+
+	void destroyNode(Node* node) {
+		node->~Node();
+		allocator.deallocate(node);
+	}
+
+	// Makes the root with the larger key the first child of the other one
+	// and returns that one. Leaves its next and previous links as they were.
+	static Node* link(Node* first, Node* second) {
+		if (second->key < first->key) {
+			std::swap(first, second);
+		}
+
+		second->next = first->child;
+		if (first->child != 0) {
+			first->child->previous = second;
+		}
+		second->previous = first;
+		first->child = second;
+
+		return first;
+	}
+
+	// Detaches the tree of node, which is not the root, from its parent
+	static void cut(Node* node) {
+		if (node->previous->child == node) {
+			node->previous->child = node->next;
+		} else {
+			node->previous->next = node->next;
+		}
+		if (node->next != 0) {
+			node->next->previous = node->previous;
+		}
+
+		node->next = 0;
+		node->previous = 0;
+	}
+
+	// Links the trees of the sibling list first into one tree: first pairs
+	// from left to right, then the pairs from right to left into the last
+	// one. Returns its root, or 0 for an empty list.
+	static Node* combineSiblings(Node* first) {
+		if (first == 0) {
+			return 0;
+		}
+
+		// The linked pairs, chained through next with the last one first
+		Node* pairs = 0;
+		while (first != 0) {
+			Node* second = first->next;
+			Node* rest = second != 0 ? second->next : 0;
+
+			Node* linked = second != 0 ? link(first, second) : first;
+			linked->next = pairs;
+			pairs = linked;
+
+			first = rest;
+		}
+
+		Node* result = pairs;
+		pairs = pairs->next;
+		while (pairs != 0) {
+			Node* nextPair = pairs->next;
+			result = link(result, pairs);
+			pairs = nextPair;
+		}
+
+		result->next = 0;
+		result->previous = 0;
+
+		return result;
+	}
+
+	void linkWithRoot(Node* tree) {
+		if (root == 0) {
+			root = tree;
+		} else {
+			root = link(root, tree);
+			root->next = 0;
+			root->previous = 0;
+		}
+	}
+
+	// Calls visitor(node) for every node of the tree of root; visitor may
+	// destroy the node
+	template <typename Visitor>
+	static void forEachNode(Node* root, Visitor visitor) {
+		std::vector<Node*> pending;
+		if (root != 0) {
+			pending.push_back(root);
+		}
+
+		while (!pending.empty()) {
+			Node* node = pending.back();
+			pending.pop_back();
+
+			if (node->child != 0) {
+				pending.push_back(node->child);
+			}
+			if (node->next != 0) {
+				pending.push_back(node->next);
+			}
+			visitor(node);
+		}
+	}
+
+	struct NodeDestroyer {
+		PairingHeap* heap;
+
+		void operator()(Node* node) {
+			heap->destroyNode(node);
+		}
+	};
+
+	struct KeyInserter {
+		PairingHeap* heap;
+
+		void operator()(const Node* node) {
+			heap->insert(node->key);
+		}
+	};
+
+	void deleteTree() {
+		NodeDestroyer destroyer = { this };
+		forEachNode(root, destroyer);
+		root = 0;
+		size = 0;
+	}
+
+public:
+	class Element {
+		Node* node;
+
+		Element(Node* node)
+			: node(node) {
+		}
+	public:
+		// An element of no heap, to be assigned later
+		Element()
+			: node(0) {
+		}
+
+		const Key& getKey() const {
+			return node->key;
+		}
+
+	friend class PairingHeap;
+	};
+
+	PairingHeap()
+		: root(0), size(0) {
+	}
+
+	// A pooling allocator frees all nodes at once, so they are only visited
+	// when their keys need destroying
+	~PairingHeap() {
+		if (!Allocator<Node>::OWNS_STORAGE || !std::is_trivially_destructible<Key>::value) {
+			deleteTree();
+		}
+	}
+
+	PairingHeap(const PairingHeap& heap)
+		: root(0), size(0) {
+			KeyInserter inserter = { this };
+			try {
+				forEachNode(heap.root, inserter);
+			} catch (...) {
+				deleteTree();
+				throw;
+			}
+	}
+
+	void swap(PairingHeap& heap) {
+		std::swap(root, heap.root);
+		std::swap(size, heap.size);
+		allocator.swap(heap.allocator);
+	}
+
+	PairingHeap& operator=(const PairingHeap& heap) {
+		if (this != &heap) {
+			PairingHeap temp(heap);
+			swap(temp);
+		}
+
+		return *this;
+	}
+
+	Element insert(const Key& key) {
+		Node* node = createNode(key);
+
+		linkWithRoot(node);
+		size++;
+
+		return Element(node);
+	}
+
+	Element getMinElement() const {
+		return Element(root);
+	}
+
+	const Key& getMin() const {
+		return root->key;
+	}
+
+	// Moves the elements of heap, and the allocator storage holding them,
+	// to this heap
+	void mergeWith(PairingHeap& heap) {
+		if (heap.root != 0) {
+			linkWithRoot(heap.root);
+		}
+
+		size += heap.size;
+		allocator.absorb(heap.allocator);
+
+		heap.root = 0;
+		heap.size = 0;
+	}
+
+	bool isEmpty() const {
+		return root == 0;
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+	void extractMin() {
+		Node* oldRoot = root;
+
+		root = combineSiblings(root->child);
+		destroyNode(oldRoot);
+		size--;
+	}
+
+	// newKey must not be greater than the key of element
+	void decreaseKey(Element element, const Key& newKey) {
+		Node* node = element.node;
+
+		node->key = newKey;
+
+		if (node != root) {
+			cut(node);
+			linkWithRoot(node);
+		}
+	}
+
+	void remove(Element element) {
+		Node* node = element.node;
+
+		if (node == root) {
+			extractMin();
+			return;
+		}
+
+		cut(node);
+		Node* children = combineSiblings(node->child);
+		if (children != 0) {
+			linkWithRoot(children);
+		}
+
+		destroyNode(node);
+		size--;
+	}
+};
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef PARALLELSORT_H
+#define PARALLELSORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+// Ranges smaller than this are sorted or merged on the calling thread
+const std::size_t PARALLEL_SORT_GRAIN = 1 << 14;
+
+// Runs first on a new thread and second on the calling one, and returns
+// once both are done; first runs on the calling thread too if no thread can
+// be started. An exception from either is rethrown after both have
+// finished, that of first if both throw.
+template <typename First, typename Second>
+void parallelInvoke(First first, Second second) {
+	std::exception_ptr firstError;
+	auto runFirst = [&]() {
+		try {
+			first();
+		} catch (...) {
+			firstError = std::current_exception();
+		}
+	};
+
+	std::thread firstRunner;
+	bool isStarted = true;
+	try {
+		firstRunner = std::thread(runFirst);
+	} catch (...) {
+		isStarted = false;
+	}
+	if (!isStarted) {
+		runFirst();
+	}
+
+	std::exception_ptr secondError;
+	try {
+		second();
+	} catch (...) {
+		secondError = std::current_exception();
+	}
+
+	if (isStarted) {
+		firstRunner.join();
+	}
+	if (firstError != 0) {
+		std::rethrow_exception(firstError);
+	}
+	if (secondError != 0) {
+		std::rethrow_exception(secondError);
+	}
+}
+
+// Moves the sorted ranges [first1, last1) and [first2, last2) to out in
+// sorted order; of equal elements those of the first range come first.
+// Splits the larger range at its middle and the other one at the matching
+// position, and merges the two halves on two threads, depth levels deep.
+template <typename RandomAccessIterator, typename OutputIterator, typename Less>
+void parallelMerge(RandomAccessIterator first1, RandomAccessIterator last1,
+		RandomAccessIterator first2, RandomAccessIterator last2, OutputIterator out, Less less, int depth) {
+	std::size_t count1 = last1 - first1;
+	std::size_t count2 = last2 - first2;
+
+	if (depth <= 0 || count1 + count2 < PARALLEL_SORT_GRAIN) {
+		std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+			std::make_move_iterator(first2), std::make_move_iterator(last2), out, less);
+		return;
+	}
+
+	// Elements of the second range equal to the splitting one of the first
+	// go after it and those of the first range equal to the splitting one
+	// of the second go before it, which keeps the merge stable
+	RandomAccessIterator middle1;
+	RandomAccessIterator middle2;
+	if (count1 >= count2) {
+		middle1 = first1 + count1 / 2;
+		middle2 = std::lower_bound(first2, last2, *middle1, less);
+	} else {
+		middle2 = first2 + count2 / 2;
+		middle1 = std::upper_bound(first1, last1, *middle2, less);
+	}
+	OutputIterator middleOut = out + (middle1 - first1) + (middle2 - first2);
+
+	parallelInvoke([=]() {
+		parallelMerge(first1, middle1, first2, middle2, out, less, depth - 1);
+	}, [=]() {
+		parallelMerge(middle1, last1, middle2, last2, middleOut, less, depth - 1);
+	});
+}
+
+// Stably sorts [first, last), using [buffer, buffer + (last - first)) as
+// scratch space, and leaves the result in buffer when toBuffer is set.
+// Sorts the halves into the other array on two threads and merges them
+// back, depth levels deep.
+template <typename RandomAccessIterator, typename BufferIterator, typename Less>
+void parallelMergeSort(RandomAccessIterator first, RandomAccessIterator last, BufferIterator buffer,
+		Less less, int depth, bool toBuffer) {
+	std::size_t count = last - first;
+
+	if (depth <= 0 || count < PARALLEL_SORT_GRAIN) {
+		std::stable_sort(first, last, less);
+		if (toBuffer) {
+			std::move(first, last, buffer);
+		}
+		return;
+	}
+
+	std::size_t half = count / 2;
+	parallelInvoke([=]() {
+		parallelMergeSort(first, first + half, buffer, less, depth - 1, !toBuffer);
+	}, [=]() {
+		parallelMergeSort(first + half, last, buffer + half, less, depth - 1, !toBuffer);
+	});
+
+	if (toBuffer) {
+		parallelMerge(first, first + half, first + half, last, buffer, less, depth);
+	} else {
+		parallelMerge(buffer, buffer + half, buffer + half, buffer + count, first, less, depth);
+	}
+}
+
+// Stably sorts [first, last) by less on up to threads threads. Takes
+// O(n log n / threads + n) time and O(n) extra space. If less or moving an
+// element throws, the exception reaches the caller once every thread has
+// stopped, with the elements of the range left valid but unspecified.
+template <typename RandomAccessIterator, typename Less>
+void parallelStableSort(RandomAccessIterator first, RandomAccessIterator last, Less less,
+		unsigned threads = std::thread::hardware_concurrency()) {
+	typedef typename std::iterator_traits<RandomAccessIterator>::value_type Element;
+
+	int depth = 0;
+	while ((1u << depth) < threads) {
+		depth++;
+	}
+
+	if (depth == 0 || static_cast<std::size_t>(last - first) < PARALLEL_SORT_GRAIN) {
+		std::stable_sort(first, last, less);
+		return;
+	}
+
+	// The elements are moved to the buffer and sorted back, so they need
+	// not be default constructible
+	std::vector<Element> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+	parallelMergeSort(buffer.begin(), buffer.end(), first, less, depth, true);
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "parallelsort.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace std;
+
+const unsigned THREAD_COUNTS[] = {1, 2, 3, 8};
+
+struct FirstLess {
+	bool operator()(const pair<int, int>& a, const pair<int, int>& b) const {
+		return a.first < b.first;
+	}
+};
+
+// Few distinct keys, so that stability matters
+void testStableSort(size_t size, unsigned threads) {
+	vector<pair<int, int> > elements;
+	for (size_t i = 0; i < size; i++) {
+		elements.push_back(make_pair(rand() % 100, static_cast<int>(i)));
+	}
+
+	vector<pair<int, int> > expected = elements;
+	stable_sort(expected.begin(), expected.end(), FirstLess());
+	parallelStableSort(elements.begin(), elements.end(), FirstLess(), threads);
+
+	if (elements != expected) {
+		cout << "Fail on stable sort test with size " << size << " and " << threads << " threads" << endl;
+	}
+}
+
+// Throws once it has been called limit times over all threads
+struct ThrowingLess {
+	atomic<long long>* calls;
+	long long limit;
+
+	bool operator()(int a, int b) const {
+		if (calls->fetch_add(1) == limit) {
+			throw std::exception();
+		}
+
+		return a < b;
+	}
+};
+
+// A comparison that throws in the sorting or the merging phase must reach
+// the caller, with the range still holding as many elements
+void testThrowingLess() {
+	const long long LIMITS[] = {0, 100000, 1000000, 2500000};
+
+	for (size_t i = 0; i < sizeof(LIMITS)/sizeof(LIMITS[0]); i++) {
+		vector<int> elements;
+		for (int j = 0; j < 200000; j++) {
+			elements.push_back(rand());
+		}
+
+		atomic<long long> calls(0);
+		ThrowingLess less = { &calls, LIMITS[i] };
+		bool thrown = false;
+		try {
+			parallelStableSort(elements.begin(), elements.end(), less, 4);
+		} catch (std::exception&) {
+			thrown = true;
+		}
+
+		if (!thrown || elements.size() != 200000) {
+			cout << "Fail on throwing comparison test with limit " << LIMITS[i] << endl;
+		}
+	}
+}
+
+void testStrings() {
+	vector<string> strings;
+	for (int i = 0; i < 100000; i++) {
+		strings.push_back(string(rand() % 20, 'a' + rand() % 26));
+	}
+
+	vector<string> expected = strings;
+	stable_sort(expected.begin(), expected.end());
+	parallelStableSort(strings.begin(), strings.end(), less<string>(), 4);
+
+	if (strings != expected) {
+		cout << "Fail on string sort test\n";
+	}
+}
+
+template <typename Tree>
+void testBuildFrom(const char* name, unsigned threads) {
+	vector<pair<int, int> > entries;
+	map<int, int> expected;
+	for (int i = 0; i < 200000; i++) {
+		entries.push_back(make_pair(rand() % 50000, i));
+		expected[entries.back().first] = i;
+	}
+
+	Tree tree;
+	tree.put(-1, 0);
+	tree.buildFrom(entries.begin(), entries.end(), threads);
+
+	if (tree.contains(-1) || tree.statistics().nodeCount != expected.size()) {
+		cout << "Fail on " << name << " buildFrom size test with " << threads << " threads" << endl;
+	}
+
+	for (map<int, int>::const_iterator i = expected.begin(); i != expected.end(); ++i) {
+		if (tree.get(i->first) != i->second) {
+			cout << "Fail on " << name << " buildFrom test with number " << i->first << endl;
+			break;
+		}
+	}
+
+	// The tree must stay balanced under further changes
+	for (int i = 0; i < 50000; i++) {
+		tree.put(rand() % 100000, i);
+		tree.tryRemove(rand() % 100000);
+	}
+	double nodeCount = static_cast<double>(tree.statistics().nodeCount);
+	if (tree.statistics().height > 2 * log2(nodeCount + 1)) {
+		cout << "Fail on " << name << " buildFrom balance test\n";
+	}
+
+	tree.buildFrom(entries.begin(), entries.begin(), threads);
+	if (!tree.isEmpty()) {
+		cout << "Fail on " << name << " empty buildFrom test\n";
+	}
+}
+
+int main() {
+	const size_t sizes[] = {0, 1, 1000, PARALLEL_SORT_GRAIN, PARALLEL_SORT_GRAIN + 1, 100000, 1000003};
+
+	for (size_t i = 0; i < sizeof(THREAD_COUNTS)/sizeof(THREAD_COUNTS[0]); i++) {
+		for (size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++) {
+			testStableSort(sizes[j], THREAD_COUNTS[i]);
+		}
+
+		testBuildFrom<AATree<int, int> >("AATree", THREAD_COUNTS[i]);
+		testBuildFrom<RedBlackTree<int, int> >("RedBlackTree", THREAD_COUNTS[i]);
+	}
+	testStrings();
+	testThrowingLess();
+
+	return 0;
+}
@@ -0,0 +1,89 @@
+#include "parallelsort.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {100000, 1000000, 10000000};
+
+vector<pair<int, int> > entries;
+
+struct FirstLess {
+	bool operator()(const pair<int, int>& a, const pair<int, int>& b) const {
+		return a.first < b.first;
+	}
+};
+
+// Wall clock time, since clock() adds up the time of all threads
+long long milliseconds(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+	return chrono::duration_cast<chrono::milliseconds>(to - from).count();
+}
+
+void testSort(size_t count, unsigned threads) {
+	vector<pair<int, int> > elements(entries.begin(), entries.begin() + count);
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	parallelStableSort(elements.begin(), elements.end(), FirstLess(), threads);
+	chrono::steady_clock::time_point afterSort = chrono::steady_clock::now();
+
+	cout << "parallelStableSort, " << threads << " threads " << milliseconds(initial, afterSort) << "ms" << endl;
+}
+
+template <typename Tree>
+void testBuild(const char* name, size_t count, unsigned threads) {
+	Tree* tree = new Tree();
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	if (threads == 0) {
+		for (size_t i = 0; i < count; i++) {
+			tree->put(entries[i].first, entries[i].second);
+		}
+	} else {
+		tree->buildFrom(entries.begin(), entries.begin() + count, threads);
+	}
+	chrono::steady_clock::time_point afterBuild = chrono::steady_clock::now();
+
+	delete tree;
+
+	if (threads == 0) {
+		cout << name << " put          ";
+	} else {
+		cout << name << " buildFrom, " << threads << " threads ";
+	}
+	cout << milliseconds(initial, afterBuild) << "ms" << endl;
+}
+
+int main() {
+	int maxSize = TEST_SIZES[sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]) - 1];
+	unsigned hardwareThreads = thread::hardware_concurrency();
+	unsigned threads = hardwareThreads > 1 ? hardwareThreads : 1;
+
+	for (int i = 0; i < maxSize; i++) {
+		entries.push_back(make_pair(rand(), i));
+	}
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		cout << "Random keys, size " << TEST_SIZES[i] << endl;
+		testSort(TEST_SIZES[i], 1);
+		if (threads > 1) {
+			testSort(TEST_SIZES[i], threads);
+		}
+		testBuild<AATree<int, int> >("AATree      ", TEST_SIZES[i], 0);
+		testBuild<AATree<int, int> >("AATree      ", TEST_SIZES[i], 1);
+		if (threads > 1) {
+			testBuild<AATree<int, int> >("AATree      ", TEST_SIZES[i], threads);
+		}
+		testBuild<RedBlackTree<int, int> >("RedBlackTree", TEST_SIZES[i], 0);
+		testBuild<RedBlackTree<int, int> >("RedBlackTree", TEST_SIZES[i], 1);
+		if (threads > 1) {
+			testBuild<RedBlackTree<int, int> >("RedBlackTree", TEST_SIZES[i], threads);
+		}
+		cout << endl;
+	}
+
+	return 0;
+}
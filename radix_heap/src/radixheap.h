@@ -0,0 +1,376 @@
+#ifndef RADIXHEAP_H
+#define RADIXHEAP_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../../fibonacci_heap/src/poolallocator.h"
+
+// The unsigned integer RadixHeap orders a key by. Signed integers have
+// their sign bit flipped, so negative keys come before positive ones.
+// Specialize it for other key types, like NegativeInfinity in fibheap.h.
+template <typename T>
+class RadixKey {
+	static unsigned long long get(const T& key, std::false_type) {
+		return static_cast<unsigned long long>(key);
+	}
+
+	static unsigned long long get(const T& key, std::true_type) {
+		return static_cast<unsigned long long>(static_cast<long long>(key)) ^ (1ULL << 63);
+	}
+
+public:
+	static unsigned long long get(const T& key) {
+		return get(key, std::integral_constant<bool, std::is_integral<T>::value && std::is_signed<T>::value>());
+	}
+};
+
+// Monotone min heap for integer keys with the interface of FibonacciHeap:
+// keys inserted or decreased to must not be smaller than the last extracted
+// minimum, as in Dijkstra's algorithm. Elements sit in buckets by the
+// highest bit in which their key differs from that minimum, and only move
+// to lower buckets, so each moves at most 64 times. insert and decreaseKey
+// take O(1). extractMin, and remove of the minimum, scan the first
+// nonempty bucket for the next minimum, which makes extractMin O(log C)
+// amortized for keys below C.
+//
+// Nodes are allocated with Allocator<Node> (see poolallocator.h).
+template <typename Key, template <typename> class Allocator = PoolAllocator>
+class RadixHeap {
+	struct Node {
+		Node* next;
+		Node* previous;
+		int bucket;
+		unsigned long long radix;
+		Key key;
+
+		Node(const Key& key)
+			: next(0), previous(0), bucket(0), radix(RadixKey<Key>::get(key)), key(key) {
+		}
+	};
+
+	// Bucket 0 holds the keys equal to last and bucket i > 0 those that
+	// first differ from it in bit i - 1. Since no key is below last, every
+	// key of a bucket is smaller than those of the buckets after it.
+	static const int BUCKET_COUNT = 65;
+
+	// Doubly linked lists of the nodes in every bucket
+	Node* buckets[BUCKET_COUNT];
+	// The radix of the last extracted minimum
+	unsigned long long last;
+	// 0 if the heap is empty
+	Node* minimum;
+	std::size_t size;
+	Allocator<Node> allocator;
+
+	Node* createNode(const Key& key) {
+		Node* node = allocator.allocate();
+
+		try {
+			return new (node) Node(key);
+		} catch (...) {
+			allocator.deallocate(node);
+			throw;
+		}
+	}
+
+	void destroyNode(Node* node) {
+		node->~Node();
+		allocator.deallocate(node);
+	}
+
+	static int bitLength(unsigned long long bits) {
+#ifdef __GNUC__
+		return bits == 0 ? 0 : 64 - __builtin_clzll(bits);
+#else
+		int result = 0;
+		for (; bits != 0; bits >>= 1) {
+			result++;
+		}
+
+		return result;
+#endif
+	}
+
+	void pushToBucket(Node* node) {
+		int bucket = bitLength(node->radix ^ last);
+
+		node->bucket = bucket;
+		node->previous = 0;
+		node->next = buckets[bucket];
+		if (node->next != 0) {
+			node->next->previous = node;
+		}
+		buckets[bucket] = node;
+	}
+
+	void unlink(Node* node) {
+		if (node->previous != 0) {
+			node->previous->next = node->next;
+		} else {
+			buckets[node->bucket] = node->next;
+		}
+		if (node->next != 0) {
+			node->next->previous = node->previous;
+		}
+	}
+
+	// The minimum is in the first nonempty bucket
+	Node* findMinimum() const {
+		if (size == 0) {
+			return 0;
+		}
+
+		int bucket = 0;
+		while (buckets[bucket] == 0) {
+			bucket++;
+		}
+
+		Node* result = buckets[bucket];
+		if (bucket != 0) {
+			for (Node* node = result->next; node != 0; node = node->next) {
+				if (node->radix < result->radix) {
+					result = node;
+				}
+			}
+		}
+
+		return result;
+	}
+
+	// Makes the radix of the minimum the new last. The rest of its bucket
+	// agrees with it above their highest differing bit, so moves to lower
+	// buckets.
+	void advanceLast() {
+		int bucket = minimum->bucket;
+		if (bucket == 0) {
+			return;
+		}
+
+		Node* list = buckets[bucket];
+		buckets[bucket] = 0;
+		last = minimum->radix;
+
+		while (list != 0) {
+			Node* next = list->next;
+			pushToBucket(list);
+			list = next;
+		}
+	}
+
+	void updateMinimum(Node* node) {
+		if (minimum == 0 || node->radix < minimum->radix) {
+			minimum = node;
+		}
+	}
+
+	// Calls visitor(node) for every node; visitor may destroy the node
+	template <typename Visitor>
+	void forEachNode(Visitor visitor) const {
+		for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+			Node* node = buckets[bucket];
+
+			while (node != 0) {
+				Node* next = node->next;
+				visitor(node);
+				node = next;
+			}
+		}
+	}
+
+	struct NodeDestroyer {
+		RadixHeap* heap;
+
+		void operator()(Node* node) {
+			heap->destroyNode(node);
+		}
+	};
+
+	struct NodeCopier {
+		RadixHeap* heap;
+
+		void operator()(const Node* node) {
+			heap->pushToBucket(heap->createNode(node->key));
+			heap->size++;
+		}
+	};
+
+	// Moves the nodes of heap to the buckets of this heap
+	struct NodeMover {
+		RadixHeap* heap;
+
+		void operator()(Node* node) {
+			heap->pushToBucket(node);
+		}
+	};
+
+	void deleteNodes() {
+		NodeDestroyer destroyer = { this };
+		forEachNode(destroyer);
+
+		for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+			buckets[bucket] = 0;
+		}
+		minimum = 0;
+		size = 0;
+	}
+
+public:
+	class Element {
+		Node* node;
+
+		Element(Node* node)
+			: node(node) {
+		}
+	public:
+		// An element of no heap, to be assigned later
+		Element()
+			: node(0) {
+		}
+
+		const Key& getKey() const {
+			return node->key;
+		}
+
+	friend class RadixHeap;
+	};
+
+	RadixHeap()
+		: buckets(), last(0), minimum(0), size(0) {
+	}
+
+	// A pooling allocator frees all nodes at once, so they are only visited
+	// when their keys need destroying
+	~RadixHeap() {
+		if (!Allocator<Node>::OWNS_STORAGE || !std::is_trivially_destructible<Key>::value) {
+			deleteNodes();
+		}
+	}
+
+	RadixHeap(const RadixHeap& heap)
+		: buckets(), last(heap.last), minimum(0), size(0) {
+			NodeCopier copier = { this };
+			try {
+				heap.forEachNode(copier);
+			} catch (...) {
+				deleteNodes();
+				throw;
+			}
+			minimum = findMinimum();
+	}
+
+	void swap(RadixHeap& heap) {
+		for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+			std::swap(buckets[bucket], heap.buckets[bucket]);
+		}
+		std::swap(last, heap.last);
+		std::swap(minimum, heap.minimum);
+		std::swap(size, heap.size);
+		allocator.swap(heap.allocator);
+	}
+
+	RadixHeap& operator=(const RadixHeap& heap) {
+		if (this != &heap) {
+			RadixHeap temp(heap);
+			swap(temp);
+		}
+
+		return *this;
+	}
+
+	// key must not be smaller than the last extracted minimum unless the
+	// heap is empty
+	Element insert(const Key& key) {
+		Node* node = createNode(key);
+
+		// Later keys are only bounded by the last extracted minimum, so
+		// last may go down but not up
+		if (size == 0 && node->radix < last) {
+			last = node->radix;
+		}
+		pushToBucket(node);
+		updateMinimum(node);
+		size++;
+
+		return Element(node);
+	}
+
+	Element getMinElement() const {
+		return Element(minimum);
+	}
+
+	const Key& getMin() const {
+		return minimum->key;
+	}
+
+	// Moves the elements of heap, and the allocator storage holding them,
+	// to this heap. The nodes of the heap with the larger last extracted
+	// minimum change buckets, so this takes time linear in its size.
+	void mergeWith(RadixHeap& heap) {
+		if (heap.size != 0) {
+			// Keys inserted later are bounded by the smaller of the two lasts
+			if (heap.last < last) {
+				swap(heap);
+			}
+
+			if (heap.size != 0) {
+				NodeMover mover = { this };
+				heap.forEachNode(mover);
+				updateMinimum(heap.minimum);
+				size += heap.size;
+			}
+
+			for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+				heap.buckets[bucket] = 0;
+			}
+			heap.minimum = 0;
+			heap.size = 0;
+		}
+
+		allocator.absorb(heap.allocator);
+	}
+
+	bool isEmpty() const {
+		return size == 0;
+	}
+
+	std::size_t getSize() const {
+		return size;
+	}
+
+	void extractMin() {
+		advanceLast();
+
+		unlink(minimum);
+		destroyNode(minimum);
+		size--;
+		minimum = findMinimum();
+	}
+
+	// newKey must not be greater than the key of element nor smaller than
+	// the last extracted minimum
+	void decreaseKey(Element element, const Key& newKey) {
+		Node* node = element.node;
+
+		unlink(node);
+		node->key = newKey;
+		node->radix = RadixKey<Key>::get(newKey);
+		pushToBucket(node);
+		updateMinimum(node);
+	}
+
+	void remove(Element element) {
+		Node* node = element.node;
+
+		unlink(node);
+		destroyNode(node);
+		size--;
+		if (node == minimum) {
+			minimum = findMinimum();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,194 @@
+#include "radixheap.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+using namespace std;
+
+const int ROUNDS = 200;
+const int KEY_RANGE = 100000;
+
+// Inserts, extracts, decreases and removes random elements, and merges in
+// and copies whole heaps, comparing every minimum with a multiset. When
+// monotone is set, no key is ever below the last extracted minimum.
+template <typename Heap>
+void testAgainstMultiset(const char* name, bool monotone) {
+	Heap heap;
+	multiset<int> expected;
+	vector<typename Heap::Element> elements;
+	vector<bool> isAlive;
+	// Elements by the address of their key, which stays put
+	map<const int*, size_t> indexOf;
+	int lastExtracted = 0;
+
+	for (int round = 0; round < ROUNDS; round++) {
+		Heap other;
+		for (int i = 0; i < 500; i++) {
+			int key = (monotone ? lastExtracted : 0) + rand() % KEY_RANGE;
+			elements.push_back(i % 4 == 0 ? other.insert(key) : heap.insert(key));
+			isAlive.push_back(true);
+			indexOf[&elements.back().getKey()] = elements.size() - 1;
+			expected.insert(key);
+		}
+		heap.mergeWith(other);
+
+		for (int i = 0; i < 300; i++) {
+			size_t index = rand() % elements.size();
+			if (!isAlive[index]) {
+				continue;
+			}
+
+			int key = elements[index].getKey();
+			expected.erase(expected.find(key));
+
+			if (rand() % 5 == 0) {
+				indexOf.erase(&elements[index].getKey());
+				heap.remove(elements[index]);
+				isAlive[index] = false;
+			} else {
+				int lowest = monotone ? lastExtracted : 0;
+				int newKey = lowest + rand() % (key - lowest + 1);
+				heap.decreaseKey(elements[index], newKey);
+				expected.insert(newKey);
+			}
+		}
+
+		for (int i = 0; i < 200 && !expected.empty(); i++) {
+			if (heap.getMin() != *expected.begin() || heap.getMinElement().getKey() != *expected.begin()) {
+				cout << "Fail on " << name << " minimum test" << endl;
+				return;
+			}
+
+			map<const int*, size_t>::iterator extracted = indexOf.find(&heap.getMinElement().getKey());
+			if (extracted == indexOf.end()) {
+				cout << "Fail on " << name << " getMinElement test" << endl;
+				return;
+			}
+			isAlive[extracted->second] = false;
+			indexOf.erase(extracted);
+
+			lastExtracted = heap.getMin();
+			expected.erase(expected.begin());
+			heap.extractMin();
+		}
+
+		if (heap.getSize() != expected.size()) {
+			cout << "Fail on " << name << " size test" << endl;
+			return;
+		}
+	}
+
+	Heap copy(heap);
+	copy = heap;
+	while (!expected.empty()) {
+		if (heap.getMin() != *expected.begin() || copy.getMin() != *expected.begin()) {
+			cout << "Fail on " << name << " drain test" << endl;
+			return;
+		}
+
+		expected.erase(expected.begin());
+		heap.extractMin();
+		copy.extractMin();
+	}
+
+	if (!heap.isEmpty() || !copy.isEmpty()) {
+		cout << "Fail on " << name << " empty test" << endl;
+	}
+}
+
+// Keys between the last extracted minimum and the current one, as
+// Dijkstra's algorithm inserts them, must go before the current one
+void testKeysBelowMinimum() {
+	RadixHeap<unsigned> heap;
+
+	heap.insert(5);
+	heap.insert(1000);
+	heap.extractMin();
+	heap.insert(7);
+	heap.insert(5);
+
+	if (heap.getMin() != 5) {
+		cout << "Fail on keys below minimum test" << endl;
+	}
+	heap.extractMin();
+	if (heap.getMin() != 7) {
+		cout << "Fail on keys below minimum test" << endl;
+	}
+	heap.extractMin();
+	if (heap.getMin() != 1000 || heap.getSize() != 1) {
+		cout << "Fail on keys below minimum test" << endl;
+	}
+}
+
+void testMergeIntoEmpty() {
+	RadixHeap<unsigned> heap;
+	RadixHeap<unsigned> other;
+
+	heap.insert(50);
+	heap.extractMin();
+	other.insert(20);
+	other.insert(30);
+	heap.mergeWith(other);
+	heap.insert(25);
+
+	if (heap.getSize() != 3 || heap.getMin() != 20 || !other.isEmpty()) {
+		cout << "Fail on merge into empty test" << endl;
+	}
+	heap.extractMin();
+	if (heap.getMin() != 25) {
+		cout << "Fail on merge into empty test" << endl;
+	}
+}
+
+// Signed keys must order negative ones first, including across the
+// minimum, and keep the extremes of the type apart
+void testNegativeKeys() {
+	RadixHeap<int> heap;
+	vector<int> keys;
+	for (int i = 0; i < 2000; i++) {
+		keys.push_back(rand() % (2 * KEY_RANGE) - KEY_RANGE);
+		heap.insert(keys.back());
+	}
+	sort(keys.begin(), keys.end());
+
+	for (size_t i = 0; i < keys.size() / 2; i++) {
+		if (heap.getMin() != keys[i]) {
+			cout << "Fail on negative keys test" << endl;
+			return;
+		}
+		heap.extractMin();
+	}
+
+	int minimum = keys[keys.size() / 2];
+	heap.insert(minimum);
+	if (heap.getMin() != minimum) {
+		cout << "Fail on negative keys insert test" << endl;
+	}
+
+	RadixHeap<long long> extremes;
+	extremes.insert(LLONG_MAX);
+	extremes.insert(0);
+	extremes.insert(-1);
+	extremes.insert(LLONG_MIN);
+	const long long EXPECTED[] = {LLONG_MIN, -1, 0, LLONG_MAX};
+	for (int i = 0; i < 4; i++) {
+		if (extremes.getMin() != EXPECTED[i]) {
+			cout << "Fail on extreme keys test" << endl;
+			return;
+		}
+		extremes.extractMin();
+	}
+}
+
+int main() {
+	testAgainstMultiset<RadixHeap<int> >("RadixHeap", true);
+	testAgainstMultiset<RadixHeap<int, NewDeleteAllocator> >("RadixHeap with NewDeleteAllocator", true);
+	testKeysBelowMinimum();
+	testMergeIntoEmpty();
+	testNegativeKeys();
+
+	return 0;
+}
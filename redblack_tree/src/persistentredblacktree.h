@@ -0,0 +1,289 @@
+#ifndef PERSISTENTREDBLACKTREE_H
+#define PERSISTENTREDBLACKTREE_H
+
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+// Red-black tree whose versions share nodes. Nodes are reference counted
+// and a node is changed in place only while a single version references
+// it; otherwise put and remove copy it first, which copies no more than the
+// O(log n) nodes on the path they walk. Taking a snapshot or copying the tree
+// is therefore O(1).
+//
+// A version never observes changes made through another one, so a
+// snapshot handed to another thread can be read there without locks while
+// the original tree keeps being updated. A single tree object must still
+// not be used by several threads at once.
+template <typename Key, typename Value>
+class PersistentRedBlackTree {
+	struct Node {
+		Key key;
+		Value value;
+		bool isRed;
+		Node* links[2];
+		std::atomic<int> references;
+
+		static const int LEFT_INDEX = 0;
+		static const int RIGHT_INDEX = 1;
+		static int opposite(int dirIndex) {
+			if (dirIndex == LEFT_INDEX) {
+				return RIGHT_INDEX;
+			} else {
+				return LEFT_INDEX;
+			}
+		}
+
+		Node(const Key& key, const Value& value)
+			: key(key), value(value), isRed(true), references(1) {
+				links[LEFT_INDEX] = 0;
+				links[RIGHT_INDEX] = 0;
+		}
+
+		// The copy shares the children of node
+		Node(const Node& node)
+			: key(node.key), value(node.value), isRed(node.isRed), references(1) {
+				links[LEFT_INDEX] = retain(node.links[LEFT_INDEX]);
+				links[RIGHT_INDEX] = retain(node.links[RIGHT_INDEX]);
+		}
+	};
+
+	Node* root;
+
+	static Node* retain(Node* node) {
+		if (node != 0) {
+			node->references.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		return node;
+	}
+
+	static void release(Node* node) {
+		if (node != 0 && node->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			release(node->links[Node::LEFT_INDEX]);
+			release(node->links[Node::RIGHT_INDEX]);
+			delete node;
+		}
+	}
+
+	// Makes link point to a node that no other version references, copying
+	// the node if needed. link itself must belong to such a node (or be the
+	// root of this version).
+	static Node* own(Node*& link) {
+		if (link->references.load(std::memory_order_acquire) != 1) {
+			Node* copy = new Node(*link);
+			release(link);
+			link = copy;
+		}
+
+		return link;
+	}
+
+	bool isRed(const Node* node) const {
+		return node != 0 && node->isRed;
+	}
+
+	// root must already be owned
+	void rotate(Node*& root, int dirIndex) const {
+		Node* newRoot = own(root->links[Node::opposite(dirIndex)]);
+
+		root->links[Node::opposite(dirIndex)] = newRoot->links[dirIndex];
+		newRoot->links[dirIndex] = root;
+
+		root->isRed = true;
+		newRoot->isRed = false;
+
+		root = newRoot;
+	}
+
+	void insert(Node*& root, const Key& key, const Value& value) {
+		if (root == 0) {
+			root = new Node(key, value);
+			return;
+		}
+
+		own(root);
+		if (key == root->key) {
+			root->value = value;
+		} else {
+			int dirIndex = key < root->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX;
+
+			insert(root->links[dirIndex], key, value);
+			if (isRed(root->links[dirIndex])) {
+				if (isRed(root->links[Node::opposite(dirIndex)])) {
+					root->isRed = true;
+					own(root->links[Node::LEFT_INDEX])->isRed = false;
+					own(root->links[Node::RIGHT_INDEX])->isRed = false;
+				} else if (isRed(root->links[dirIndex]->links[dirIndex])) {
+					rotate(root, Node::opposite(dirIndex));
+				} else if (isRed(root->links[dirIndex]->links[Node::opposite(dirIndex)])) {
+					rotate(root->links[dirIndex], dirIndex);
+					rotate(root, Node::opposite(dirIndex));
+				}
+			}
+		}
+	}
+
+	// Restores the black height of root after its dirIndex subtree lost one
+	// black node. Sets done once the loss has been absorbed.
+	void removeBalance(Node*& root, int dirIndex, bool& done) {
+		Node* parent = root;
+
+		if (isRed(root->links[Node::opposite(dirIndex)])) {
+			rotate(root, dirIndex);
+			parent = root->links[dirIndex];
+		}
+
+		if (parent->links[Node::opposite(dirIndex)] == 0) {
+			return;
+		}
+
+		Node* sibling = own(parent->links[Node::opposite(dirIndex)]);
+		if (!isRed(sibling->links[Node::LEFT_INDEX]) && !isRed(sibling->links[Node::RIGHT_INDEX])) {
+			if (isRed(parent)) {
+				done = true;
+			}
+
+			parent->isRed = false;
+			sibling->isRed = true;
+		} else {
+			bool wasRed = parent->isRed;
+			Node*& parentLink = root == parent ? root : root->links[dirIndex];
+
+			if (isRed(sibling->links[Node::opposite(dirIndex)])) {
+				rotate(parentLink, dirIndex);
+			} else {
+				rotate(parentLink->links[Node::opposite(dirIndex)], Node::opposite(dirIndex));
+				rotate(parentLink, dirIndex);
+			}
+
+			parentLink->isRed = wasRed;
+			own(parentLink->links[Node::LEFT_INDEX])->isRed = false;
+			own(parentLink->links[Node::RIGHT_INDEX])->isRed = false;
+			done = true;
+		}
+	}
+
+	// Bottom-up removal; key must be present in the subtree of root
+	void remove(Node*& root, const Key& key, bool& done) {
+		own(root);
+
+		int dirIndex;
+		if (key == root->key) {
+			if (root->links[Node::LEFT_INDEX] == 0 || root->links[Node::RIGHT_INDEX] == 0) {
+				Node*& heirLink = root->links[root->links[Node::LEFT_INDEX] == 0 ? Node::RIGHT_INDEX : Node::LEFT_INDEX];
+
+				if (isRed(root)) {
+					done = true;
+				} else if (isRed(heirLink)) {
+					own(heirLink)->isRed = false;
+					done = true;
+				}
+
+				Node* heir = heirLink;
+				root->links[Node::LEFT_INDEX] = root->links[Node::RIGHT_INDEX] = 0;
+				release(root);
+				root = heir;
+
+				return;
+			}
+
+			Node* predecessor = root->links[Node::LEFT_INDEX];
+			while (predecessor->links[Node::RIGHT_INDEX] != 0) {
+				predecessor = predecessor->links[Node::RIGHT_INDEX];
+			}
+
+			root->key = predecessor->key;
+			root->value = predecessor->value;
+			dirIndex = Node::LEFT_INDEX;
+			remove(root->links[dirIndex], root->key, done);
+		} else {
+			dirIndex = key < root->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX;
+			remove(root->links[dirIndex], key, done);
+		}
+
+		if (!done) {
+			removeBalance(root, dirIndex, done);
+		}
+	}
+
+public:
+	PersistentRedBlackTree()
+		: root(0) {
+	}
+
+	// Shares every node of tree, O(1)
+	PersistentRedBlackTree(const PersistentRedBlackTree& tree)
+		: root(retain(tree.root)) {
+	}
+
+	~PersistentRedBlackTree() {
+		release(root);
+	}
+
+	void swap(PersistentRedBlackTree& tree) {
+		std::swap(root, tree.root);
+	}
+
+	PersistentRedBlackTree& operator=(const PersistentRedBlackTree& tree) {
+		if (this != &tree) {
+			PersistentRedBlackTree temp(tree);
+			swap(temp);
+		}
+
+		return *this;
+	}
+
+	// The current version, O(1). Changes to either tree are not visible
+	// through the other.
+	PersistentRedBlackTree snapshot() const {
+		return *this;
+	}
+
+	bool isEmpty() const {
+		return root == 0;
+	}
+
+	void put(const Key& key, const Value& value) {
+		insert(root, key, value);
+		own(root)->isRed = false;
+	}
+
+	void remove(const Key& key) {
+		if (!contains(key)) {
+			throw std::exception();
+		}
+
+		bool done = false;
+		remove(root, key, done);
+		if (root != 0 && root->isRed) {
+			own(root)->isRed = false;
+		}
+	}
+
+	Value get(const Key& key) const {
+		Node* current = root;
+
+		while (current != 0 && current->key != key) {
+			current = current->links[key < current->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX];
+		}
+
+		if (current == 0) {
+			throw std::exception();
+		}
+
+		return current->value;
+	}
+
+	bool contains(const Key& key) const {
+		Node* current = root;
+
+		while (current != 0 && current->key != key) {
+			current = current->links[key < current->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX];
+		}
+
+		return current != 0;
+	}
+};
+
+#endif
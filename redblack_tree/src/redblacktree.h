@@ -1,15 +1,68 @@
 #ifndef REDBLACKTREE_H
 #define REDBLACKTREE_H
 
+#include <cstddef>
 #include <exception>
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
 
-template <typename Key, typename Value>
+#include "../../eytzinger_layout/src/eytzinger.h"
+#include "../../key_compare/src/keycompare.h"
+#include "../../parallel_sort/src/parallelsort.h"
+#include "../../tree_statistics/src/treestatistics.h"
+
+// Subtree size kept in every node when order statistics are enabled.
+// The disabled variant is empty so plain trees pay nothing for it.
+template <bool Enabled>
+struct RedBlackTreeSubtreeSize {
+	std::size_t get() const {
+		return 0;
+	}
+
+	void set(std::size_t) {
+	}
+};
+
+template <>
+struct RedBlackTreeSubtreeSize<true> {
+	std::size_t value;
+
+	RedBlackTreeSubtreeSize()
+		: value(1) {
+	}
+
+	std::size_t get() const {
+		return value;
+	}
+
+	void set(std::size_t newValue) {
+		value = newValue;
+	}
+};
+
+// With OrderStatistics set every node also stores the size of its subtree,
+// which enables rank, select and countInRange in O(log n). Keys are ordered
+// by the Compare policy (see keycompare.h) with one three-way comparison per
+// visited node.
+template <typename Key, typename Value, bool OrderStatistics = false, typename Compare = ThreeWayCompare<Key> >
 class RedBlackTree {
-	struct Node {
-		Key key;
-		Value value;
+	typedef typename Compare::Cache KeyCache;
+
+	struct Node;
+
+	// The part of a node the top-down remove needs above the root
+	struct NodeBase {
 		bool isRed;
 		Node* links[2];
+	};
+
+	struct Node : NodeBase {
+		Key key;
+		Value value;
+		KeyCache cache;
+		RedBlackTreeSubtreeSize<OrderStatistics> size;
 
 		static const int LEFT_INDEX = 0;
 		static const int RIGHT_INDEX = 1;
@@ -21,19 +74,99 @@ class RedBlackTree {
 			}
 		}
 
-		Node(const Key& key, const Value& value)
-			: key(key), value(value), isRed(true) {
-				links[LEFT_INDEX] = 0;
-				links[RIGHT_INDEX] = 0;
+		template <typename K, typename V>
+		Node(K&& key, V&& value)
+			: key(std::forward<K>(key)), value(std::forward<V>(value)), cache(Compare::cache(this->key)) {
+				this->isRed = true;
+				this->links[LEFT_INDEX] = 0;
+				this->links[RIGHT_INDEX] = 0;
 		}
 	};
 
 	Node* root;
 
-	bool isRed(const Node* node) const {
+	// The right spine of the tree: finger[0] is the root and every other
+	// entry is the right child of the one before it. Empty when it has to be
+	// rebuilt, i.e. after any change other than putNearEnd.
+	std::vector<Node*> finger;
+
+	// Operation counts, kept only when TREE_STATISTICS is defined
+	mutable TreeCounters counters;
+
+	// Compares key, whose cache is keyCache, with the key of node
+	int compare(const Key& key, const KeyCache& keyCache, const Node* node) const {
+		return Compare::compare(key, keyCache, node->key, node->cache);
+	}
+
+	bool isRed(const NodeBase* node) const {
 		return node != 0 && node->isRed;
 	}
 
+	std::size_t subtreeSize(const Node* node) const {
+		return node == 0 ? 0 : node->size.get();
+	}
+
+	void updateSize(Node* node) const {
+		if (OrderStatistics) {
+			node->size.set(subtreeSize(node->links[Node::LEFT_INDEX]) + subtreeSize(node->links[Node::RIGHT_INDEX]) + 1);
+		}
+	}
+
+	// Recomputes the sizes on the path from root to the node holding key
+	void updateSizesOnPath(Node* root, const Key& key, const KeyCache& keyCache) const {
+		if (root == 0) {
+			return;
+		}
+
+		int comparison = compare(key, keyCache, root);
+		if (comparison != 0) {
+			updateSizesOnPath(root->links[comparison < 0 ? Node::LEFT_INDEX : Node::RIGHT_INDEX], key, keyCache);
+		}
+		updateSize(root);
+	}
+
+	std::size_t countLess(const Key& key, bool inclusive) const {
+		KeyCache keyCache = Compare::cache(key);
+		std::size_t count = 0;
+		Node* current = root;
+
+		while (current != 0) {
+			int comparison = compare(key, keyCache, current);
+
+			if (comparison > 0 || (inclusive && comparison == 0)) {
+				count += subtreeSize(current->links[Node::LEFT_INDEX]) + 1;
+				current = current->links[Node::RIGHT_INDEX];
+			} else {
+				current = current->links[Node::LEFT_INDEX];
+			}
+		}
+
+		return count;
+	}
+
+	// The black height of node if it roots a valid subtree with keys between
+	// those of low and high (either 0 for no bound), -1 otherwise
+	int checkSubtree(const Node* node, const Node* low, const Node* high) const {
+		if (node == 0) {
+			return 0;
+		}
+
+		if ((low != 0 && compare(node->key, node->cache, low) <= 0)
+				|| (high != 0 && compare(node->key, node->cache, high) >= 0)
+				|| (node->isRed && (isRed(node->links[Node::LEFT_INDEX]) || isRed(node->links[Node::RIGHT_INDEX])))) {
+			return -1;
+		}
+
+		int leftHeight = checkSubtree(node->links[Node::LEFT_INDEX], low, node);
+		int rightHeight = checkSubtree(node->links[Node::RIGHT_INDEX], node, high);
+		if (leftHeight < 0 || leftHeight != rightHeight
+				|| subtreeSize(node) != (OrderStatistics ? subtreeSize(node->links[Node::LEFT_INDEX]) + subtreeSize(node->links[Node::RIGHT_INDEX]) + 1 : 0)) {
+			return -1;
+		}
+
+		return leftHeight + (node->isRed ? 0 : 1);
+	}
+
 	void rotate(Node*& root, int dirIndex) const {
 		Node* newRoot = root->links[Node::opposite(dirIndex)];
 
@@ -42,56 +175,143 @@ class RedBlackTree {
 
 		root->isRed = true;
 		newRoot->isRed = false;
+		counters.rotations.add(1);
+
+		updateSize(root);
+		updateSize(newRoot);
 
 		root = newRoot;
 	}
 
-	void insert(Node*& root, const Key& key, const Value& value) {
+	// Returns the node holding key. An existing value is only replaced when
+	// overwrite is set.
+	template <typename K, typename V>
+	Node* insert(Node*& root, K&& key, const KeyCache& keyCache, V&& value, bool overwrite) {
+		Node* node;
+		int comparison;
+
 		if (root == 0) {
-			root = new Node(key, value);
-		} else if (key == root->key) {
-			root->value = value;
+			root = node = new Node(std::forward<K>(key), std::forward<V>(value));
+		} else if ((comparison = compare(key, keyCache, root)) == 0) {
+			if (overwrite) {
+				root->value = std::forward<V>(value);
+			}
+			node = root;
 		} else {
-			int dirIndex = key < root->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX;
-
-			insert(root->links[dirIndex], key, value);
-			if (isRed(root->links[dirIndex])) {
-				if (isRed(root->links[Node::opposite(dirIndex)])) {
-					root->isRed = true;
-					root->links[Node::LEFT_INDEX]->isRed = false;
-					root->links[Node::RIGHT_INDEX]->isRed = false;
-				} else if (isRed(root->links[dirIndex]->links[dirIndex])) {
-					rotate(root, Node::opposite(dirIndex));
-				} else if (isRed(root->links[dirIndex]->links[Node::opposite(dirIndex)])) {
-					rotate(root->links[dirIndex], dirIndex);
-					rotate(root, Node::opposite(dirIndex));
+			int dirIndex = comparison < 0 ? Node::LEFT_INDEX : Node::RIGHT_INDEX;
+
+			node = insert(root->links[dirIndex], std::forward<K>(key), keyCache, std::forward<V>(value), overwrite);
+			fixInsert(root, dirIndex);
+			updateSize(root);
+		}
+
+		return node;
+	}
+
+	// Rebalances root after an insertion into its dirIndex subtree
+	void fixInsert(Node*& root, int dirIndex) const {
+		if (isRed(root->links[dirIndex])) {
+			if (isRed(root->links[Node::opposite(dirIndex)])) {
+				root->isRed = true;
+				root->links[Node::LEFT_INDEX]->isRed = false;
+				root->links[Node::RIGHT_INDEX]->isRed = false;
+				counters.colorFlips.add(1);
+			} else if (isRed(root->links[dirIndex]->links[dirIndex])) {
+				rotate(root, Node::opposite(dirIndex));
+			} else if (isRed(root->links[dirIndex]->links[Node::opposite(dirIndex)])) {
+				rotate(root->links[dirIndex], dirIndex);
+				rotate(root, Node::opposite(dirIndex));
+			}
+		}
+	}
+
+	// The link that points to finger[level]
+	Node*& fingerLink(std::size_t level) {
+		return level == 0 ? root : finger[level - 1]->links[Node::RIGHT_INDEX];
+	}
+
+	void rebuildFinger(std::size_t level) {
+		finger.resize(level);
+		for (Node* node = fingerLink(level); node != 0; node = node->links[Node::RIGHT_INDEX]) {
+			finger.push_back(node);
+		}
+	}
+
+	template <typename K, typename V>
+	void insertNearEnd(K&& key, V&& value) {
+		if (finger.empty()) {
+			rebuildFinger(0);
+		}
+
+		KeyCache keyCache = Compare::cache(key);
+		std::size_t level = finger.size();
+		int comparison = 1;
+		while (level > 0 && (comparison = compare(key, keyCache, finger[level - 1])) < 0) {
+			level--;
+		}
+
+		if (level > 0 && comparison == 0) {
+			finger[level - 1]->value = std::forward<V>(value);
+			return;
+		}
+
+		// key is greater than every spine node above level and less than
+		// finger[level], so it goes into the left part of that subtree
+		insert(fingerLink(level), std::forward<K>(key), keyCache, std::forward<V>(value), true);
+
+		// A red-red violation can only be above a red spine node, so the walk
+		// up stops at the first black one. Sizes change all the way to the
+		// root, though.
+		std::size_t changedLevel = level;
+		bool mayBeViolated = true;
+		while (level > 0 && (mayBeViolated || OrderStatistics)) {
+			level--;
+			if (mayBeViolated) {
+				Node* child = finger[level]->links[Node::RIGHT_INDEX];
+				mayBeViolated = isRed(child);
+				if (isRed(child) && (isRed(child->links[Node::LEFT_INDEX]) || isRed(child->links[Node::RIGHT_INDEX]))) {
+					fixInsert(fingerLink(level), Node::RIGHT_INDEX);
+					changedLevel = level;
 				}
 			}
+
+			updateSize(fingerLink(level));
 		}
+
+		root->isRed = false;
+		rebuildFinger(changedLevel);
 	}
 
-	void remove(Node*& root, const Key& key) {
-		Node temp(root->key, root->value);
-		temp.isRed = false;
-		Node* current;
-		Node* parent;
-		Node* grandparent;
+	// Top-down removal in a single pass. Returns whether key was found; the
+	// tree stays valid either way.
+	bool remove(Node*& root, const Key& key) {
+		if (root == 0) {
+			return false;
+		}
+
+		KeyCache keyCache = Compare::cache(key);
+		NodeBase head;
+		head.isRed = false;
+		head.links[Node::LEFT_INDEX] = 0;
+		head.links[Node::RIGHT_INDEX] = root;
+
+		NodeBase* position = &head;
+		NodeBase* parent = 0;
+		NodeBase* grandparent = 0;
+		Node* current = 0;
 		Node* founded = 0;
 		int dirIndex = Node::RIGHT_INDEX;
 		int lastDirIndex;
 
-		current = &temp;
-		current->links[dirIndex] = root;
-		grandparent = parent = 0;
-
-		while (current->links[dirIndex] != 0) {
+		while (position->links[dirIndex] != 0) {
 			grandparent = parent;
-			parent = current;
-			current = current->links[dirIndex];
+			parent = position;
+			position = current = position->links[dirIndex];
 			lastDirIndex = dirIndex;
-			dirIndex = current->key < key ? Node::RIGHT_INDEX : Node::LEFT_INDEX;
+			int comparison = compare(key, keyCache, current);
+			dirIndex = comparison > 0 ? Node::RIGHT_INDEX : Node::LEFT_INDEX;
 
-			if (current->key == key) {
+			if (comparison == 0) {
 				founded = current;
 			}
 
@@ -108,16 +328,17 @@ class RedBlackTree {
 							parent->isRed = false;
 							sibling->isRed = true;
 							current->isRed = true;
+							counters.colorFlips.add(1);
 						} else {
 							int beforeLastDirIndex = grandparent->links[Node::LEFT_INDEX] == parent ? Node::LEFT_INDEX : Node::RIGHT_INDEX;
 						
 							if (isRed(sibling->links[lastDirIndex])) {
-								Node* tempParent = parent;
+								Node* tempParent = static_cast<Node*>(parent);
 								rotate(tempParent->links[Node::opposite(lastDirIndex)], Node::opposite(lastDirIndex));
 								rotate(tempParent, lastDirIndex);
 								grandparent->links[beforeLastDirIndex] = tempParent;
 							} else if (isRed(sibling->links[Node::opposite(lastDirIndex)])) {
-								Node* tempParent = parent;
+								Node* tempParent = static_cast<Node*>(parent);
 								rotate(tempParent, lastDirIndex);
 								grandparent->links[beforeLastDirIndex] = tempParent;
 							}
@@ -131,17 +352,157 @@ class RedBlackTree {
 			}
 		}
 
-		founded->key = current->key;
-		founded->value = current->value;
-		parent->links[parent->links[Node::RIGHT_INDEX] == current ? Node::RIGHT_INDEX : Node::LEFT_INDEX] = current->links[current->links[Node::LEFT_INDEX] == 0 ? Node::RIGHT_INDEX : Node::LEFT_INDEX];
-		delete current;
+		if (founded != 0) {
+			if (founded != current) {
+				founded->key = std::move(current->key);
+				founded->value = std::move(current->value);
+				founded->cache = current->cache;
+			}
+			parent->links[parent->links[Node::RIGHT_INDEX] == current ? Node::RIGHT_INDEX : Node::LEFT_INDEX] = current->links[current->links[Node::LEFT_INDEX] == 0 ? Node::RIGHT_INDEX : Node::LEFT_INDEX];
+			delete current;
+		}
 
-		root = temp.links[Node::RIGHT_INDEX];
+		root = head.links[Node::RIGHT_INDEX];
 		if (root != 0) {
 			root->isRed = false;
 		}
+
+		// Rotations on the way down kept the sizes consistent, so only the
+		// ancestors of the unlinked node are stale
+		if (OrderStatistics && founded != 0 && parent != &head) {
+			updateSizesOnPath(root, static_cast<Node*>(parent)->key, static_cast<Node*>(parent)->cache);
+		}
+
+		return founded != 0;
+	}
+
+	const Value* find(const Node* root, const Key& key) const {
+		KeyCache keyCache = Compare::cache(key);
+		const Node* current = root;
+		unsigned long long comparisons = 0;
+
+		while (current != 0) {
+			int comparison = compare(key, keyCache, current);
+			comparisons++;
+
+			if (comparison == 0) {
+				break;
+			}
+			current = current->links[comparison < 0 ? Node::LEFT_INDEX : Node::RIGHT_INDEX];
+		}
+
+		counters.lookups.add(1);
+		counters.lookupComparisons.add(comparisons);
+
+		return current != 0 ? &current->value : 0;
 	}
 
+	struct EntryLess {
+		bool operator()(const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) const {
+			return Compare::compare(a.first, Compare::cache(a.first), b.first, Compare::cache(b.first)) < 0;
+		}
+	};
+
+	static void prefetch(const Node* node) {
+#ifdef __GNUC__
+		if (node != 0) {
+			__builtin_prefetch(node);
+		}
+#endif
+	}
+
+	// Number of searches findGroup runs side by side
+	static const std::size_t BATCH_GROUP_SIZE = 16;
+
+	// Searches for up to BATCH_GROUP_SIZE keys in lockstep, one level of each
+	// search per round, and prefetches every next node. The cache misses of
+	// the searches then overlap instead of following one another. Stores a
+	// pointer to the value of keys[i], or 0, in results[i].
+	void findGroup(const Key* const* keys, std::size_t count, const Value** results) const {
+		const Node* current[BATCH_GROUP_SIZE];
+		KeyCache caches[BATCH_GROUP_SIZE];
+		std::size_t active = root != 0 ? count : 0;
+		unsigned long long comparisons = 0;
+
+		for (std::size_t i = 0; i < count; i++) {
+			current[i] = root;
+			caches[i] = Compare::cache(*keys[i]);
+			results[i] = 0;
+		}
+
+		while (active > 0) {
+			for (std::size_t i = 0; i < count; i++) {
+				const Node* node = current[i];
+				if (node == 0) {
+					continue;
+				}
+
+				int comparison = compare(*keys[i], caches[i], node);
+				comparisons++;
+				if (comparison == 0) {
+					results[i] = &node->value;
+					node = 0;
+				} else {
+					node = node->links[comparison < 0 ? Node::LEFT_INDEX : Node::RIGHT_INDEX];
+					prefetch(node);
+				}
+
+				if (node == 0) {
+					active--;
+				}
+				current[i] = node;
+			}
+		}
+
+		counters.lookups.add(count);
+		counters.lookupComparisons.add(comparisons);
+	}
+
+	// Sorts entries by key on up to threads threads and keeps only the last
+	// of equal keys
+	static void sortBatch(std::vector<std::pair<Key, Value> >& entries, unsigned threads = 1) {
+		parallelStableSort(entries.begin(), entries.end(), EntryLess(), threads);
+
+		std::size_t count = 0;
+		for (std::size_t i = 0; i < entries.size(); i++) {
+			if (i + 1 < entries.size() && !EntryLess()(entries[i], entries[i + 1])) {
+				continue;
+			}
+
+			if (count != i) {
+				entries[count] = std::move(entries[i]);
+			}
+			count++;
+		}
+
+		entries.erase(entries.begin() + count, entries.end());
+	}
+
+	void collectStatistics(const Node* root, int depth, TreeStatistics& statistics) const {
+		if (root != 0) {
+			statistics.addNode(depth);
+			collectStatistics(root->links[Node::LEFT_INDEX], depth + 1, statistics);
+			collectStatistics(root->links[Node::RIGHT_INDEX], depth + 1, statistics);
+		}
+	}
+
+	template <typename Visitor>
+	void forEach(const Node* root, Visitor& visitor) const {
+		if (root != 0) {
+			forEach(root->links[Node::LEFT_INDEX], visitor);
+			visitor(root->key, root->value);
+			forEach(root->links[Node::RIGHT_INDEX], visitor);
+		}
+	}
+
+	struct EntryCollector {
+		std::vector<std::pair<Key, Value> >* entries;
+
+		void operator()(const Key& key, const Value& value) {
+			entries->push_back(std::make_pair(key, value));
+		}
+	};
+
 	void deleteTree(Node*& root) const {
 		if (root == 0) {
 			return;
@@ -151,16 +512,347 @@ class RedBlackTree {
 		delete root;
 	}
 
-	void buildFromTree(Node*& root, Node*& from) {
+	void buildFromTree(Node*& root, Node* from) {
 		if (from != 0) {
 			root = new Node(from->key, from->value);
+			root->isRed = from->isRed;
+			root->size = from->size;
+
+			buildFromTree(root->links[Node::LEFT_INDEX], from->links[Node::LEFT_INDEX]);
+			buildFromTree(root->links[Node::RIGHT_INDEX], from->links[Node::RIGHT_INDEX]);
+		}
+	}
+
+	static int floorLog2(std::size_t n) {
+		int result = 0;
+		while (n > 1) {
+			n >>= 1;
+			result++;
+		}
+
+		return result;
+	}
+
+	// Builds a tree from count sorted entries by always taking the lower middle
+	// as the root. Every level but the last is then full, so coloring the nodes
+	// of an incomplete last level (redDepth) red gives a valid red-black tree.
+	// If copying an entry throws, the nodes built so far are freed.
+	template <typename RandomAccessIterator>
+	Node* buildFromSorted(RandomAccessIterator first, std::size_t count, int depth, int redDepth, int parallelDepth) {
+		if (count == 0) {
+			return 0;
+		}
 
-			buildFromTree(root->left, from->left);
-			buildFromTree(root->right, from->right);
+		std::size_t leftCount = (count - 1) / 2;
+		RandomAccessIterator middle = first + leftCount;
+		Node* node = new Node(middle->first, middle->second);
+		node->isRed = depth == redDepth;
+		node->size.set(count);
+
+		try {
+			if (parallelDepth > 0 && count >= PARALLEL_BUILD_GRAIN) {
+				parallelInvoke([=]() {
+					node->links[Node::LEFT_INDEX] = buildFromSorted(first, leftCount, depth + 1, redDepth, parallelDepth - 1);
+				}, [=]() {
+					node->links[Node::RIGHT_INDEX] = buildFromSorted(middle + 1, count - leftCount - 1, depth + 1, redDepth,
+						parallelDepth - 1);
+				});
+			} else {
+				node->links[Node::LEFT_INDEX] = buildFromSorted(first, leftCount, depth + 1, redDepth, 0);
+				node->links[Node::RIGHT_INDEX] = buildFromSorted(middle + 1, count - leftCount - 1, depth + 1, redDepth, 0);
+			}
+		} catch (...) {
+			deleteTree(node);
+			throw;
 		}
+
+		return node;
+	}
+
+	template <typename RandomAccessIterator>
+	void buildFromSorted(RandomAccessIterator first, RandomAccessIterator last, int parallelDepth) {
+		std::size_t count = last - first;
+		bool isPerfect = ((count + 1) & count) == 0;
+
+		RedBlackTree temp;
+		temp.root = buildFromSorted(first, count, 0, isPerfect ? -1 : floorLog2(count), parallelDepth);
+		swap(temp);
+	}
+
+	// Subtrees smaller than this are not worth a thread of their own
+	static const std::size_t PARALLEL_BUILD_GRAIN = 1 << 14;
+
+	// Number of black nodes on any path from node down to a leaf
+	int blackHeight(const Node* node) const {
+		int height = 0;
+
+		while (node != 0) {
+			if (!node->isRed) {
+				height++;
+			}
+			node = node->links[Node::LEFT_INDEX];
+		}
+
+		return height;
+	}
+
+	// Hangs small on the dirIndex side of big around middle. big must be at
+	// least as black-high as small, and small must have a black root. The
+	// result has the black height of big but may have a red root with a red
+	// child, which the caller fixes.
+	Node* joinInto(Node* big, int bigHeight, Node* middle, Node* small, int smallHeight, int dirIndex) {
+		if (!isRed(big) && bigHeight == smallHeight) {
+			middle->isRed = true;
+			middle->links[Node::opposite(dirIndex)] = big;
+			middle->links[dirIndex] = small;
+			updateSize(middle);
+
+			return middle;
+		}
+
+		int childHeight = isRed(big) ? bigHeight : bigHeight - 1;
+		big->links[dirIndex] = joinInto(big->links[dirIndex], childHeight, middle, small, smallHeight, dirIndex);
+		updateSize(big);
+
+		if (!isRed(big) && isRed(big->links[dirIndex]) && isRed(big->links[dirIndex]->links[dirIndex])) {
+			big->links[dirIndex]->links[dirIndex]->isRed = false;
+			rotate(big, Node::opposite(dirIndex));
+			big->isRed = true;
+			big->links[Node::opposite(dirIndex)]->isRed = false;
+		}
+
+		return big;
+	}
+
+	// Joins left, middle and right, where every key in left is less than
+	// middle's key and every key in right is greater. Takes O(|leftHeight - rightHeight|)
+	// and returns a tree with a black root.
+	Node* join(Node* left, int leftHeight, Node* middle, Node* right, int rightHeight, int& height) {
+		if (isRed(left)) {
+			left->isRed = false;
+			leftHeight++;
+		}
+		if (isRed(right)) {
+			right->isRed = false;
+			rightHeight++;
+		}
+
+		Node* result;
+		if (leftHeight > rightHeight) {
+			result = joinInto(left, leftHeight, middle, right, rightHeight, Node::RIGHT_INDEX);
+			height = leftHeight;
+		} else if (rightHeight > leftHeight) {
+			result = joinInto(right, rightHeight, middle, left, leftHeight, Node::LEFT_INDEX);
+			height = rightHeight;
+		} else {
+			middle->links[Node::LEFT_INDEX] = left;
+			middle->links[Node::RIGHT_INDEX] = right;
+			middle->isRed = false;
+			updateSize(middle);
+			height = leftHeight + 1;
+
+			return middle;
+		}
+
+		if (result->isRed) {
+			result->isRed = false;
+			height++;
+		}
+
+		return result;
+	}
+
+	// Same as join but without a middle node
+	Node* join(Node* left, int leftHeight, Node* right, int rightHeight, int& height) {
+		if (left == 0) {
+			height = rightHeight;
+			return right;
+		}
+
+		Node* maximum = left;
+		while (maximum->links[Node::RIGHT_INDEX] != 0) {
+			maximum = maximum->links[Node::RIGHT_INDEX];
+		}
+
+		Node* rest;
+		Node* empty;
+		int restHeight;
+		int emptyHeight;
+		Node* middle = split(left, leftHeight, maximum->key, maximum->cache, rest, restHeight, empty, emptyHeight);
+
+		return join(rest, restHeight, middle, right, rightHeight, height);
+	}
+
+	// Splits root into the keys less than key and the keys greater than key.
+	// Returns the detached node holding key, or 0 if there is none.
+	Node* split(Node* root, int height, const Key& key, const KeyCache& keyCache, Node*& left, int& leftHeight, Node*& right, int& rightHeight) {
+		if (root == 0) {
+			left = right = 0;
+			leftHeight = rightHeight = 0;
+
+			return 0;
+		}
+
+		int childHeight = root->isRed ? height : height - 1;
+		Node* rootLeft = root->links[Node::LEFT_INDEX];
+		Node* rootRight = root->links[Node::RIGHT_INDEX];
+		Node* found;
+		int comparison = compare(key, keyCache, root);
+
+		if (comparison == 0) {
+			left = rootLeft;
+			leftHeight = childHeight;
+			right = rootRight;
+			rightHeight = childHeight;
+
+			root->links[Node::LEFT_INDEX] = root->links[Node::RIGHT_INDEX] = 0;
+			updateSize(root);
+
+			return root;
+		} else if (comparison < 0) {
+			Node* between;
+			int betweenHeight;
+			found = split(rootLeft, childHeight, key, keyCache, left, leftHeight, between, betweenHeight);
+			right = join(between, betweenHeight, root, rootRight, childHeight, rightHeight);
+		} else {
+			Node* between;
+			int betweenHeight;
+			found = split(rootRight, childHeight, key, keyCache, between, betweenHeight, right, rightHeight);
+			left = join(rootLeft, childHeight, root, between, betweenHeight, leftHeight);
+		}
+
+		return found;
+	}
+
+	// The set operations below expose the root of second, split first by its
+	// key and recurse on both sides, forking the left side onto a new thread
+	// while parallelDepth is positive.
+
+	Node* unite(Node* first, int firstHeight, Node* second, int secondHeight, int parallelDepth, int& height) {
+		if (first == 0) {
+			height = secondHeight;
+			return second;
+		} else if (second == 0) {
+			height = firstHeight;
+			return first;
+		}
+
+		int childHeight = second->isRed ? secondHeight : secondHeight - 1;
+		Node* firstLeft;
+		Node* firstRight;
+		int firstLeftHeight;
+		int firstRightHeight;
+		delete split(first, firstHeight, second->key, second->cache, firstLeft, firstLeftHeight, firstRight, firstRightHeight);
+
+		Node* left;
+		Node* right;
+		int leftHeight;
+		int rightHeight;
+		if (parallelDepth > 0) {
+			parallelInvoke([&]() {
+				left = unite(firstLeft, firstLeftHeight, second->links[Node::LEFT_INDEX], childHeight, parallelDepth - 1, leftHeight);
+			}, [&]() {
+				right = unite(firstRight, firstRightHeight, second->links[Node::RIGHT_INDEX], childHeight, parallelDepth - 1, rightHeight);
+			});
+		} else {
+			left = unite(firstLeft, firstLeftHeight, second->links[Node::LEFT_INDEX], childHeight, 0, leftHeight);
+			right = unite(firstRight, firstRightHeight, second->links[Node::RIGHT_INDEX], childHeight, 0, rightHeight);
+		}
+
+		return join(left, leftHeight, second, right, rightHeight, height);
+	}
+
+	Node* intersect(Node* first, int firstHeight, Node* second, int secondHeight, int parallelDepth, int& height) {
+		if (first == 0 || second == 0) {
+			deleteTree(first);
+			deleteTree(second);
+			height = 0;
+
+			return 0;
+		}
+
+		int childHeight = second->isRed ? secondHeight : secondHeight - 1;
+		Node* firstLeft;
+		Node* firstRight;
+		int firstLeftHeight;
+		int firstRightHeight;
+		Node* found = split(first, firstHeight, second->key, second->cache, firstLeft, firstLeftHeight, firstRight, firstRightHeight);
+
+		Node* left;
+		Node* right;
+		int leftHeight;
+		int rightHeight;
+		if (parallelDepth > 0) {
+			parallelInvoke([&]() {
+				left = intersect(firstLeft, firstLeftHeight, second->links[Node::LEFT_INDEX], childHeight, parallelDepth - 1, leftHeight);
+			}, [&]() {
+				right = intersect(firstRight, firstRightHeight, second->links[Node::RIGHT_INDEX], childHeight, parallelDepth - 1, rightHeight);
+			});
+		} else {
+			left = intersect(firstLeft, firstLeftHeight, second->links[Node::LEFT_INDEX], childHeight, 0, leftHeight);
+			right = intersect(firstRight, firstRightHeight, second->links[Node::RIGHT_INDEX], childHeight, 0, rightHeight);
+		}
+		delete second;
+
+		if (found != 0) {
+			return join(left, leftHeight, found, right, rightHeight, height);
+		} else {
+			return join(left, leftHeight, right, rightHeight, height);
+		}
+	}
+
+	Node* subtract(Node* first, int firstHeight, Node* second, int secondHeight, int parallelDepth, int& height) {
+		if (first == 0 || second == 0) {
+			deleteTree(second);
+			height = firstHeight;
+
+			return first;
+		}
+
+		int childHeight = second->isRed ? secondHeight : secondHeight - 1;
+		Node* firstLeft;
+		Node* firstRight;
+		int firstLeftHeight;
+		int firstRightHeight;
+		delete split(first, firstHeight, second->key, second->cache, firstLeft, firstLeftHeight, firstRight, firstRightHeight);
+
+		Node* left;
+		Node* right;
+		int leftHeight;
+		int rightHeight;
+		if (parallelDepth > 0) {
+			parallelInvoke([&]() {
+				left = subtract(firstLeft, firstLeftHeight, second->links[Node::LEFT_INDEX], childHeight, parallelDepth - 1, leftHeight);
+			}, [&]() {
+				right = subtract(firstRight, firstRightHeight, second->links[Node::RIGHT_INDEX], childHeight, parallelDepth - 1, rightHeight);
+			});
+		} else {
+			left = subtract(firstLeft, firstLeftHeight, second->links[Node::LEFT_INDEX], childHeight, 0, leftHeight);
+			right = subtract(firstRight, firstRightHeight, second->links[Node::RIGHT_INDEX], childHeight, 0, rightHeight);
+		}
+		delete second;
+
+		return join(left, leftHeight, right, rightHeight, height);
+	}
+
+	// Set operations fork only when both trees have at least this black
+	// height, i.e. at least 2^PARALLEL_SET_BLACK_HEIGHT - 1 nodes each
+	static const int PARALLEL_SET_BLACK_HEIGHT = 12;
+
+	int setOperationParallelDepth(const RedBlackTree& other, unsigned threads) const {
+		if (std::min(blackHeight(root), blackHeight(other.root)) < PARALLEL_SET_BLACK_HEIGHT) {
+			return 0;
+		}
+
+		return floorLog2(threads) + ((threads & (threads - 1)) != 0);
 	}
 
 public:
+	typedef Key KeyType;
+	typedef Value ValueType;
+	// The ordering of the keys, which snapshots share
+	typedef Compare KeyCompare;
+
 	RedBlackTree()
 		: root(0) {
 	}
@@ -175,7 +867,8 @@ public:
 	}
 
 	void swap(RedBlackTree& tree) {
-		std::swap(root, tree->root);
+		std::swap(root, tree.root);
+		finger.swap(tree.finger);
 	}
 
 	RedBlackTree& operator=(const RedBlackTree& tree) {
@@ -191,40 +884,339 @@ public:
 		return root == 0;
 	}
 
-	void put(const Key& key, const Key& value) {
-		insert(root, key, value);
+	// Replaces the contents with the (key, value) pairs of [first, last), whose
+	// keys must be strictly increasing. Runs in O(n) without any rebalancing.
+	template <typename RandomAccessIterator>
+	void buildFromSorted(RandomAccessIterator first, RandomAccessIterator last) {
+		buildFromSorted(first, last, 0);
+	}
+
+	// Same as buildFromSorted but builds independent subtrees on up to threads threads
+	template <typename RandomAccessIterator>
+	void buildFromSortedParallel(RandomAccessIterator first, RandomAccessIterator last,
+			unsigned threads = std::thread::hardware_concurrency()) {
+		buildFromSorted(first, last, floorLog2(threads) + ((threads & (threads - 1)) != 0));
+	}
+
+	// Replaces the contents with the (key, value) pairs of [first, last) in
+	// any order; of equal keys the last one wins, as with put. Sorts with a
+	// parallel merge sort and builds like buildFromSortedParallel, both on
+	// up to threads threads, in O(n log n / threads + n).
+	template <typename InputIterator>
+	void buildFrom(InputIterator first, InputIterator last, unsigned threads = std::thread::hardware_concurrency()) {
+		std::vector<std::pair<Key, Value> > entries(first, last);
+		sortBatch(entries, threads);
+		buildFromSortedParallel(entries.begin(), entries.end(), threads);
+	}
+
+	void put(const Key& key, const Value& value) {
+		finger.clear();
+		insert(root, key, Compare::cache(key), value, true);
 		root->isRed = false;
 	}
 
+	void put(Key&& key, Value&& value) {
+		finger.clear();
+		KeyCache keyCache = Compare::cache(key);
+		insert(root, std::move(key), keyCache, std::move(value), true);
+		root->isRed = false;
+	}
+
+	// Same as put, but searches up the right spine from the largest key
+	// instead of down from the root and rebalances only as far up as needed.
+	// A key among the d largest costs O(log d) plus amortized O(1)
+	// rebalancing (sizes are still updated up to the root with
+	// OrderStatistics), so streams of mostly increasing keys insert in nearly
+	// constant time. The first call after any other change rebuilds the
+	// spine in O(log n).
+	void putNearEnd(const Key& key, const Value& value) {
+		insertNearEnd(key, value);
+	}
+
+	void putNearEnd(Key&& key, Value&& value) {
+		insertNearEnd(std::move(key), std::move(value));
+	}
+
+	// Returns the value for key, inserting a default constructed one at the
+	// position the search ended on if key is absent
+	Value& getOrInsert(const Key& key) {
+		finger.clear();
+		Node* node = insert(root, key, Compare::cache(key), Value(), false);
+		root->isRed = false;
+
+		return node->value;
+	}
+
 	void remove(const Key& key) {
-		if (!contains(key)) {
+		finger.clear();
+		if (!remove(root, key)) {
 			throw std::exception();
 		}
-		remove(root, key);
 	}
 
-	Value get(const Key& key) {
-		Node* current = root;
+	// Removes key in a single pass and returns whether it was present
+	bool tryRemove(const Key& key) {
+		finger.clear();
+		return remove(root, key);
+	}
 
-		while(current != 0 && current->key != key) {
-			current = current->links[key < current->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX];
-		}
+	Value get(const Key& key) const {
+		const Value* value = find(root, key);
 
-		if (current == 0) {
+		if (value == 0) {
 			throw std::exception();
 		}
 
-		return current->value;
+		return *value;
+	}
+
+	// Pointer to the value for key, or 0 if there is none. Removing any key
+	// may invalidate it.
+	Value* find(const Key& key) {
+		return const_cast<Value*>(find(root, key));
+	}
+
+	const Value* find(const Key& key) const {
+		return find(root, key);
+	}
+
+	bool contains(const Key& key) const {
+		return find(root, key) != 0;
+	}
+
+	// Looks up the keys [first, last) and stores a pointer to the value of
+	// the i-th one, or 0 if it is absent, in results[i]. The searches run in
+	// interleaved groups so their cache misses overlap, which on large trees
+	// is several times faster than calling find for each key. The pointers
+	// are invalidated like those of find.
+	template <typename RandomAccessIterator>
+	void findBatch(RandomAccessIterator first, RandomAccessIterator last, const Value** results) const {
+		std::size_t count = last - first;
+
+		for (std::size_t base = 0; base < count; base += BATCH_GROUP_SIZE) {
+			std::size_t groupSize = count - base < BATCH_GROUP_SIZE ? count - base : BATCH_GROUP_SIZE;
+			const Key* keys[BATCH_GROUP_SIZE];
+
+			for (std::size_t i = 0; i < groupSize; i++) {
+				keys[i] = &first[base + i];
+			}
+			findGroup(keys, groupSize, results + base);
+		}
+	}
+
+	// Puts the (key, value) pairs of [first, last); of equal keys the last
+	// one wins. A batch of at least 2^black height entries, which lies
+	// between about sqrt(n) and n depending on the shape of the tree, is
+	// sorted, built into a tree in O(m) and united with this one. A smaller
+	// batch is first looked up in interleaved groups like findBatch: present
+	// keys get their new values in place and only the absent ones are
+	// inserted, along paths that are then cached.
+	template <typename RandomAccessIterator>
+	void putBatch(RandomAccessIterator first, RandomAccessIterator last) {
+		std::size_t count = last - first;
+
+		if (count >= static_cast<std::size_t>(1) << blackHeight(root)) {
+			std::vector<std::pair<Key, Value> > entries(first, last);
+			sortBatch(entries);
+
+			RedBlackTree batch;
+			batch.buildFromSorted(entries.begin(), entries.end());
+			unionWith(batch);
+			return;
+		}
+
+		finger.clear();
+		for (std::size_t base = 0; base < count; base += BATCH_GROUP_SIZE) {
+			std::size_t groupSize = count - base < BATCH_GROUP_SIZE ? count - base : BATCH_GROUP_SIZE;
+			const Key* keys[BATCH_GROUP_SIZE];
+			const Value* values[BATCH_GROUP_SIZE];
+
+			for (std::size_t i = 0; i < groupSize; i++) {
+				keys[i] = &first[base + i].first;
+			}
+			findGroup(keys, groupSize, values);
+
+			// Inserting never moves a node, so the pointers stay valid
+			for (std::size_t i = 0; i < groupSize; i++) {
+				if (values[i] != 0) {
+					*const_cast<Value*>(values[i]) = first[base + i].second;
+				} else {
+					insert(root, first[base + i].first, Compare::cache(first[base + i].first), first[base + i].second, true);
+					root->isRed = false;
+				}
+			}
+		}
+	}
+
+	// Appends key and the contents of greater to this tree. Every key here must
+	// be less than key and every key in greater must be greater than it.
+	// Leaves greater empty. Takes O(log n).
+	void join(const Key& key, const Value& value, RedBlackTree& greater) {
+		int height;
+		finger.clear();
+		greater.finger.clear();
+		root = join(root, blackHeight(root), new Node(key, value), greater.root, blackHeight(greater.root), height);
+		greater.root = 0;
+	}
+
+	// Same as the above but without a key in between
+	void join(RedBlackTree& greater) {
+		int height;
+		finger.clear();
+		greater.finger.clear();
+		root = join(root, blackHeight(root), greater.root, blackHeight(greater.root), height);
+		greater.root = 0;
+	}
+
+	// Keeps the keys less than key in this tree and moves the keys greater
+	// than key to greater, replacing its contents. Returns whether key was
+	// present; its entry is dropped. Takes O(log n).
+	bool split(const Key& key, RedBlackTree& greater) {
+		Node* left;
+		Node* right;
+		int leftHeight;
+		int rightHeight;
+		finger.clear();
+		Node* found = split(root, blackHeight(root), key, Compare::cache(key), left, leftHeight, right, rightHeight);
+		delete found;
+
+		RedBlackTree temp;
+		temp.root = right;
+		greater.swap(temp);
+		root = left;
+		if (root != 0) {
+			root->isRed = false;
+		}
+		if (greater.root != 0) {
+			greater.root->isRed = false;
+		}
+
+		return found != 0;
 	}
 
-	bool contains(const Key& key) {
+	// Adds every entry of other to this tree, with other's value winning for
+	// keys present in both. Reuses other's nodes and leaves it empty. Takes
+	// O(m log(n/m + 1)) work for trees of sizes m <= n, spread over up to
+	// threads threads for large trees.
+	void unionWith(RedBlackTree& other, unsigned threads = std::thread::hardware_concurrency()) {
+		int height;
+		finger.clear();
+		other.finger.clear();
+		root = unite(root, blackHeight(root), other.root, blackHeight(other.root), setOperationParallelDepth(other, threads), height);
+		other.root = 0;
+		if (root != 0) {
+			root->isRed = false;
+		}
+	}
+
+	// Keeps only the keys also present in other. Leaves other empty.
+	void intersectWith(RedBlackTree& other, unsigned threads = std::thread::hardware_concurrency()) {
+		int height;
+		finger.clear();
+		other.finger.clear();
+		root = intersect(root, blackHeight(root), other.root, blackHeight(other.root), setOperationParallelDepth(other, threads), height);
+		other.root = 0;
+		if (root != 0) {
+			root->isRed = false;
+		}
+	}
+
+	// Removes every key present in other. Leaves other empty.
+	void differenceWith(RedBlackTree& other, unsigned threads = std::thread::hardware_concurrency()) {
+		int height;
+		finger.clear();
+		other.finger.clear();
+		root = subtract(root, blackHeight(root), other.root, blackHeight(other.root), setOperationParallelDepth(other, threads), height);
+		other.root = 0;
+		if (root != 0) {
+			root->isRed = false;
+		}
+	}
+
+	// Whether the tree keeps the red-black invariants: keys in order, a black
+	// root, no red node with a red child and as many black nodes on every
+	// path down, and with OrderStatistics the right subtree sizes. Takes
+	// O(n); meant for tests.
+	bool isValid() const {
+		return !isRed(root) && checkSubtree(root, 0, 0) >= 0;
+	}
+
+	std::size_t getSize() const {
+		static_assert(OrderStatistics, "getSize requires OrderStatistics");
+
+		return subtreeSize(root);
+	}
+
+	// Number of keys strictly less than key
+	std::size_t rank(const Key& key) const {
+		static_assert(OrderStatistics, "rank requires OrderStatistics");
+
+		return countLess(key, false);
+	}
+
+	// The key with the given zero-based position in sorted order
+	Key select(std::size_t index) const {
+		static_assert(OrderStatistics, "select requires OrderStatistics");
+
 		Node* current = root;
 
-		while(current != 0 && current->key != key) {
-			current = current->links[key < current->key ? Node::LEFT_INDEX : Node::RIGHT_INDEX];
+		while (current != 0) {
+			std::size_t leftSize = subtreeSize(current->links[Node::LEFT_INDEX]);
+
+			if (index < leftSize) {
+				current = current->links[Node::LEFT_INDEX];
+			} else if (index > leftSize) {
+				index -= leftSize + 1;
+				current = current->links[Node::RIGHT_INDEX];
+			} else {
+				return current->key;
+			}
+		}
+
+		throw std::exception();
+	}
+
+	// Number of keys in the closed range [low, high]
+	std::size_t countInRange(const Key& low, const Key& high) const {
+		static_assert(OrderStatistics, "countInRange requires OrderStatistics");
+
+		if (Compare::compare(high, Compare::cache(high), low, Compare::cache(low)) < 0) {
+			return 0;
 		}
 
-		return current != 0;
+		return countLess(high, true) - countLess(low, false);
+	}
+
+	// Calls visitor(key, value) for every entry in increasing key order
+	template <typename Visitor>
+	void forEach(Visitor visitor) const {
+		forEach(root, visitor);
+	}
+
+	// Immutable copy of the current contents laid out for fast lookups,
+	// ordered by the same Compare. Takes O(n); the snapshot does not see
+	// later changes to the tree.
+	EytzingerSnapshot<Key, Value, Compare> snapshot() const {
+		std::vector<std::pair<Key, Value> > entries;
+		EntryCollector collector = { &entries };
+		forEach(root, collector);
+
+		return EytzingerSnapshot<Key, Value, Compare>(entries.begin(), entries.end());
+	}
+
+	// Shape of the tree, computed in O(n), and the operation counts since
+	// construction or the last resetCounters
+	TreeStatistics statistics() const {
+		TreeStatistics result;
+		collectStatistics(root, 0, result);
+		result.bytesUsed = result.nodeCount * sizeof(Node) + sizeof(*this) + finger.capacity() * sizeof(Node*);
+		result.setCounters(counters);
+
+		return result;
+	}
+
+	void resetCounters() {
+		counters.reset();
 	}
 };
 
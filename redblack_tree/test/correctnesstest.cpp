@@ -0,0 +1,557 @@
+#include "redblacktree.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+using namespace std;
+
+typedef RedBlackTree<int, int> Tree;
+typedef RedBlackTree<int, int, true> OrderTree;
+
+struct EntryCollector {
+	vector<pair<int, int> >* entries;
+
+	void operator()(int key, int value) {
+		entries->push_back(make_pair(key, value));
+	}
+};
+
+// Whether tree is a valid red-black tree holding exactly the entries of
+// expected
+template <typename T>
+bool matches(const T& tree, const map<int, int>& expected) {
+	vector<pair<int, int> > entries;
+	EntryCollector collector = { &entries };
+	tree.forEach(collector);
+
+	return tree.isValid() && tree.isEmpty() == expected.empty()
+		&& entries == vector<pair<int, int> >(expected.begin(), expected.end());
+}
+
+// Whether getSize, rank, select and countInRange agree with the sorted
+// keys of expected for every key in [-1, range]
+bool matchesOrder(const OrderTree& tree, const map<int, int>& expected, int range) {
+	vector<int> keys;
+	for (map<int, int>::const_iterator i = expected.begin(); i != expected.end(); ++i) {
+		keys.push_back(i->first);
+	}
+
+	if (!matches(tree, expected) || tree.getSize() != keys.size()) {
+		return false;
+	}
+
+	for (size_t i = 0; i < keys.size(); i++) {
+		if (tree.select(i) != keys[i]) {
+			return false;
+		}
+	}
+
+	try {
+		tree.select(keys.size());
+		return false;
+	} catch (std::exception&) {
+	}
+
+	for (int key = -1; key <= range; key++) {
+		if (tree.rank(key) != static_cast<size_t>(lower_bound(keys.begin(), keys.end(), key) - keys.begin())) {
+			return false;
+		}
+	}
+
+	// Endpoints in the tree or not, and low > high
+	for (int i = 0; i < 100; i++) {
+		int low = rand() % (range + 2) - 1;
+		int high = rand() % (range + 2) - 1;
+		size_t count = low > high ? 0 : upper_bound(keys.begin(), keys.end(), high) - lower_bound(keys.begin(), keys.end(), low);
+
+		if (tree.countInRange(low, high) != count) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Interleaves every kind of update and checks the order statistics after
+// each one
+void testOrderStatistics() {
+	const int RANGE = 2000;
+	OrderTree t;
+	map<int, int> m;
+
+	for (int step = 0; step < 3000; step++) {
+		int key = rand() % RANGE;
+
+		switch (rand() % 6) {
+		case 0:
+			t.put(key, step);
+			m[key] = step;
+			break;
+		case 1:
+			if (t.tryRemove(key) != (m.erase(key) != 0)) {
+				cout << "Fail on order statistics tryRemove test" << endl;
+				return;
+			}
+			break;
+		case 2: {
+			// Runs of keys around the largest
+			int largest = m.empty() ? 0 : m.rbegin()->first;
+			for (int i = 0; i < 10; i++) {
+				int nearKey = min(RANGE - 1, max(0, largest - 5 + rand() % 8));
+				t.putNearEnd(nearKey, step);
+				m[nearKey] = step;
+				largest = max(largest, nearKey);
+			}
+			break;
+		}
+		case 3: {
+			// Mostly small batches, sometimes one large enough to be united
+			vector<pair<int, int> > batch(rand() % 4 == 0 ? 400 : 1 + rand() % 20);
+			for (size_t i = 0; i < batch.size(); i++) {
+				batch[i] = make_pair(rand() % RANGE, step * 1000 + static_cast<int>(i));
+				m[batch[i].first] = batch[i].second;
+			}
+			t.putBatch(batch.begin(), batch.end());
+			break;
+		}
+		case 4: {
+			OrderTree greater;
+			bool isPresent = m.count(key) != 0;
+			if (t.split(key, greater) != isPresent) {
+				cout << "Fail on order statistics split test" << endl;
+				return;
+			}
+			m.erase(key);
+
+			map<int, int> low(m.begin(), m.lower_bound(key));
+			map<int, int> high(m.lower_bound(key), m.end());
+			if (!matchesOrder(t, low, RANGE) || !matchesOrder(greater, high, RANGE)) {
+				cout << "Fail on order statistics split parts test" << endl;
+				return;
+			}
+
+			if (rand() % 2 == 0) {
+				t.unionWith(greater);
+			} else {
+				t.join(greater);
+			}
+			break;
+		}
+		default: {
+			OrderTree other;
+			for (int i = 0; i < 50; i++) {
+				int otherKey = rand() % RANGE;
+				other.put(otherKey, -step);
+				m[otherKey] = -step;
+			}
+			t.unionWith(other);
+			break;
+		}
+		}
+
+		if (step % 50 == 0 && !matchesOrder(t, m, RANGE)) {
+			cout << "Fail on order statistics test at step " << step << endl;
+			return;
+		}
+	}
+
+	if (!matchesOrder(t, m, RANGE)) {
+		cout << "Fail on order statistics test" << endl;
+	}
+}
+
+void testEmptyOrderStatistics() {
+	OrderTree t;
+
+	if (t.getSize() != 0 || t.rank(5) != 0 || t.countInRange(0, 10) != 0 || !t.isValid()) {
+		cout << "Fail on empty order statistics test" << endl;
+	}
+
+	try {
+		t.select(0);
+		cout << "Fail on empty select test" << endl;
+	} catch (std::exception&) {
+	}
+}
+
+// buildFromSorted for 0, 1, 2^k - 1, 2^k and 2^k + 1 entries must give a
+// valid tree, and buildFromSortedParallel one of the same shape
+template <typename T>
+void testBuildFromSorted(const char* name) {
+	vector<size_t> sizes;
+	for (int k = 0; k <= 16; k++) {
+		sizes.push_back((static_cast<size_t>(1) << k) - 1);
+		sizes.push_back(static_cast<size_t>(1) << k);
+		sizes.push_back((static_cast<size_t>(1) << k) + 1);
+	}
+
+	for (size_t i = 0; i < sizes.size(); i++) {
+		vector<pair<int, int> > entries;
+		for (size_t j = 0; j < sizes[i]; j++) {
+			entries.push_back(make_pair(static_cast<int>(2 * j), static_cast<int>(j)));
+		}
+		map<int, int> expected(entries.begin(), entries.end());
+
+		T serial;
+		T parallel;
+		serial.buildFromSorted(entries.begin(), entries.end());
+		parallel.buildFromSortedParallel(entries.begin(), entries.end(), 4);
+
+		if (!matches(serial, expected) || !matches(parallel, expected)) {
+			cout << "Fail on " << name << " buildFromSorted test with " << sizes[i] << " entries" << endl;
+			return;
+		}
+		if (serial.statistics().depthHistogram != parallel.statistics().depthHistogram) {
+			cout << "Fail on " << name << " buildFromSortedParallel shape test with " << sizes[i] << " entries" << endl;
+			return;
+		}
+
+		// The built tree must stay valid under updates
+		for (int j = 0; j < 100; j++) {
+			int key = rand() % (2 * static_cast<int>(sizes[i]) + 2);
+			if (rand() % 2 == 0) {
+				serial.put(key, j);
+				expected[key] = j;
+			} else if (serial.tryRemove(key) != (expected.erase(key) != 0)) {
+				cout << "Fail on " << name << " buildFromSorted update test with " << sizes[i] << " entries" << endl;
+				return;
+			}
+		}
+		if (!matches(serial, expected)) {
+			cout << "Fail on " << name << " buildFromSorted update test with " << sizes[i] << " entries" << endl;
+			return;
+		}
+	}
+}
+
+// A tree and the map it must match, of count random keys below range,
+// built by put for small counts and by buildFrom otherwise
+template <typename T>
+void randomTree(T& tree, map<int, int>& expected, int count, int range, int valueBase) {
+	vector<pair<int, int> > entries;
+	for (int i = 0; i < count; i++) {
+		entries.push_back(make_pair(rand() % range, valueBase + i));
+		expected[entries.back().first] = entries.back().second;
+	}
+
+	if (count < 1000) {
+		for (size_t i = 0; i < entries.size(); i++) {
+			tree.put(entries[i].first, entries[i].second);
+		}
+	} else {
+		tree.buildFrom(entries.begin(), entries.end(), 1);
+	}
+}
+
+// unionWith, intersectWith and differenceWith on trees of the given sizes
+// against the same operations on maps. Keys in both trees have different
+// values in each, which shows whose value is kept.
+template <typename T>
+bool testSetOperations(int firstCount, int secondCount, int range, unsigned threads) {
+	for (int operation = 0; operation < 3; operation++) {
+		T first;
+		T second;
+		map<int, int> firstExpected;
+		map<int, int> secondExpected;
+		randomTree(first, firstExpected, firstCount, range, 0);
+		randomTree(second, secondExpected, secondCount, range, firstCount);
+
+		map<int, int> expected;
+		if (operation == 0) {
+			// other's value wins
+			expected = firstExpected;
+			for (map<int, int>::const_iterator i = secondExpected.begin(); i != secondExpected.end(); ++i) {
+				expected[i->first] = i->second;
+			}
+			first.unionWith(second, threads);
+		} else if (operation == 1) {
+			// this tree's value is kept
+			for (map<int, int>::const_iterator i = firstExpected.begin(); i != firstExpected.end(); ++i) {
+				if (secondExpected.count(i->first) != 0) {
+					expected.insert(*i);
+				}
+			}
+			first.intersectWith(second, threads);
+		} else {
+			for (map<int, int>::const_iterator i = firstExpected.begin(); i != firstExpected.end(); ++i) {
+				if (secondExpected.count(i->first) == 0) {
+					expected.insert(*i);
+				}
+			}
+			first.differenceWith(second, threads);
+		}
+
+		if (!matches(first, expected) || !matches(second, map<int, int>())) {
+			cout << "Fail on set operation " << operation << " with " << firstCount << " and " << secondCount
+				<< " keys below " << range << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void testSetOperations() {
+	// Small and large, disjoint-ish and overlapping, both orders of sizes
+	const int SIZES[][3] = {{0, 0, 10}, {0, 100, 1000}, {100, 0, 1000}, {1, 1, 2}, {50, 3000, 200},
+		{3000, 50, 200}, {500, 500, 100000}, {2000, 2000, 2500}};
+	for (size_t i = 0; i < sizeof(SIZES)/sizeof(SIZES[0]); i++) {
+		if (!testSetOperations<Tree>(SIZES[i][0], SIZES[i][1], SIZES[i][2], 1)
+				|| !testSetOperations<OrderTree>(SIZES[i][0], SIZES[i][1], SIZES[i][2], 1)) {
+			return;
+		}
+	}
+
+	// buildFrom gives trees of n keys a black height of floor(log2(n + 1)),
+	// here at least 14, so both trees are black-high enough (at least
+	// PARALLEL_SET_BLACK_HEIGHT = 12) for the set operations to fork threads
+	testSetOperations<Tree>(40000, 40000, 100000, 4);
+	testSetOperations<OrderTree>(40000, 40000, 60000, 4);
+	testSetOperations<OrderTree>(40000, 20000, 10000000, 8);
+}
+
+// Splits at present, absent and out of range keys and joins the parts back
+// with and without a middle key
+template <typename T>
+void testSplitAndJoin(const char* name) {
+	for (int round = 0; round < 200; round++) {
+		T tree;
+		map<int, int> expected;
+		int count = round < 100 ? rand() % 100 : rand() % 5000;
+		randomTree(tree, expected, count, 2 * count + 10, 0);
+
+		int key = rand() % (2 * count + 14) - 2;
+		bool isPresent = expected.count(key) != 0;
+		int value = isPresent ? expected[key] : -1;
+		T greater;
+		greater.put(-100, -100);
+
+		if (tree.split(key, greater) != isPresent) {
+			cout << "Fail on " << name << " split result test" << endl;
+			return;
+		}
+		map<int, int> low(expected.begin(), expected.lower_bound(key));
+		map<int, int> high(expected.upper_bound(key), expected.end());
+		if (!matches(tree, low) || !matches(greater, high)) {
+			cout << "Fail on " << name << " split test" << endl;
+			return;
+		}
+
+		if (isPresent && rand() % 2 == 0) {
+			tree.join(key, value, greater);
+		} else {
+			tree.join(greater);
+			expected.erase(key);
+		}
+		if (!matches(tree, expected) || !matches(greater, map<int, int>())) {
+			cout << "Fail on " << name << " join test" << endl;
+			return;
+		}
+	}
+
+	// Trees of very different heights, each side
+	T small;
+	T big;
+	map<int, int> expected;
+	for (int i = 0; i < 10000; i++) {
+		big.put(i, i);
+		expected[i] = i;
+	}
+	small.put(-1, -1);
+	expected[-1] = -1;
+	small.join(big);
+	if (!matches(small, expected) || !matches(big, map<int, int>())) {
+		cout << "Fail on " << name << " short left join test" << endl;
+	}
+
+	T last;
+	last.put(20000, 0);
+	expected[10000] = 1;
+	expected[20000] = 0;
+	small.join(10000, 1, last);
+	if (!matches(small, expected) || !matches(last, map<int, int>())) {
+		cout << "Fail on " << name << " short right join test" << endl;
+	}
+}
+
+// putNearEnd on keys near the largest, interleaved with the updates that
+// invalidate its cached spine
+template <typename T>
+void testPutNearEnd(const char* name) {
+	T tree;
+	map<int, int> expected;
+	int largest = 0;
+
+	for (int i = 0; i < 20000; i++) {
+		if (expected.empty()) {
+			tree.putNearEnd(largest, i);
+			expected[largest] = i;
+		}
+		int step = rand() % 10;
+
+		if (step < 6) {
+			int key = largest - rand() % 20 + rand() % 5;
+			tree.putNearEnd(key, i);
+			expected[key] = i;
+			largest = max(largest, key);
+		} else if (step == 6) {
+			int key = rand() % (largest + 1);
+			tree.put(key, i);
+			expected[key] = i;
+		} else if (step == 7) {
+			// Often the largest key, whose node the cached spine ends on
+			int key = rand() % 2 == 0 ? expected.rbegin()->first : rand() % (largest + 1);
+			if (tree.tryRemove(key) != (expected.erase(key) != 0)) {
+				cout << "Fail on " << name << " putNearEnd remove test" << endl;
+				return;
+			}
+		} else if (step == 8) {
+			int key = largest - rand() % 10;
+			tree.getOrInsert(key) += 1;
+			expected[key] += 1;
+		} else {
+			int key = largest - rand() % 30;
+			if (expected.count(key) != 0) {
+				tree.remove(key);
+				expected.erase(key);
+			}
+		}
+
+		if (i % 500 == 0 && !matches(tree, expected)) {
+			cout << "Fail on " << name << " putNearEnd test" << endl;
+			return;
+		}
+	}
+
+	if (!matches(tree, expected)) {
+		cout << "Fail on " << name << " putNearEnd test" << endl;
+	}
+}
+
+// Batches far below and far above the size at which putBatch switches to
+// the sorted path, with repeated keys in them; the last of equal keys wins.
+// findBatch must agree with find on every key.
+template <typename T>
+void testPutBatch(const char* name) {
+	// A tree of 10000 entries has height between 13 and 27, so the threshold
+	// lies between 2^7 and 2^13
+	const int SIZES[] = {0, 1, 16, 17, 50, 10000, 20000};
+	const int RANGE = 30000;
+
+	for (size_t s = 0; s < sizeof(SIZES)/sizeof(SIZES[0]); s++) {
+		for (int initial = 0; initial <= 10000; initial += 10000) {
+			T tree;
+			map<int, int> expected;
+			for (int i = 0; i < initial; i++) {
+				int key = rand() % RANGE;
+				tree.put(key, -1);
+				expected[key] = -1;
+			}
+
+			vector<pair<int, int> > batch;
+			for (int i = 0; i < SIZES[s]; i++) {
+				// Every third entry repeats an earlier key of the batch
+				int key = i % 3 == 2 ? batch[rand() % i].first : rand() % RANGE;
+				batch.push_back(make_pair(key, i));
+				expected[key] = i;
+			}
+
+			tree.putBatch(batch.begin(), batch.end());
+			if (!matches(tree, expected)) {
+				cout << "Fail on " << name << " putBatch test with " << SIZES[s] << " entries into " << initial << endl;
+				return;
+			}
+
+			vector<int> keys;
+			for (int i = 0; i < SIZES[s] + 40; i++) {
+				keys.push_back(rand() % (RANGE + 10) - 5);
+			}
+			vector<const int*> results(keys.size());
+			tree.findBatch(keys.begin(), keys.end(), results.data());
+			for (size_t i = 0; i < keys.size(); i++) {
+				map<int, int>::const_iterator found = expected.find(keys[i]);
+				if (found == expected.end() ? results[i] != 0 : results[i] == 0 || *results[i] != found->second) {
+					cout << "Fail on " << name << " findBatch test" << endl;
+					return;
+				}
+			}
+		}
+	}
+}
+
+// Counts its copies over all threads and throws on the copy numbered
+// throwingCopy, so a build can be made to fail partway
+atomic<long long> copies(0);
+atomic<long long> throwingCopy(-1);
+
+struct ThrowingValue {
+	int value;
+
+	explicit ThrowingValue(int value)
+		: value(value) {
+	}
+
+	ThrowingValue(const ThrowingValue& other)
+		: value(other.value) {
+		if (copies.fetch_add(1) == throwingCopy.load()) {
+			throw std::exception();
+		}
+	}
+};
+
+// A build that throws partway, serial or on several threads, must reach
+// the caller, leave the tree as it was and free every node it made, which
+// the leak checker of the sanitizer builds verifies
+template <typename T>
+void testThrowingBuild(const char* name) {
+	vector<pair<int, ThrowingValue> > entries;
+	for (int i = 0; i < 200000; i++) {
+		entries.push_back(make_pair(2 * i, ThrowingValue(i)));
+	}
+
+	const long long LIMITS[] = {0, 1, 100000, 199999};
+	for (size_t i = 0; i < sizeof(LIMITS)/sizeof(LIMITS[0]); i++) {
+		for (unsigned threads = 1; threads <= 4; threads *= 4) {
+			T tree;
+			tree.put(-1, ThrowingValue(-1));
+
+			copies.store(0);
+			throwingCopy.store(LIMITS[i]);
+			bool thrown = false;
+			try {
+				tree.buildFromSortedParallel(entries.begin(), entries.end(), threads);
+			} catch (std::exception&) {
+				thrown = true;
+			}
+			throwingCopy.store(-1);
+
+			if (!thrown || !tree.contains(-1) || tree.contains(0) || !tree.isValid()) {
+				cout << "Fail on " << name << " throwing build test with limit " << LIMITS[i] << ", " << threads
+					<< " threads" << endl;
+				return;
+			}
+		}
+	}
+}
+
+int main() {
+	testOrderStatistics();
+	testEmptyOrderStatistics();
+	testBuildFromSorted<Tree>("RedBlackTree");
+	testBuildFromSorted<OrderTree>("RedBlackTree with OrderStatistics");
+	testSetOperations();
+	testSplitAndJoin<Tree>("RedBlackTree");
+	testSplitAndJoin<OrderTree>("RedBlackTree with OrderStatistics");
+	testPutNearEnd<Tree>("RedBlackTree");
+	testPutNearEnd<OrderTree>("RedBlackTree with OrderStatistics");
+	testPutBatch<Tree>("RedBlackTree");
+	testPutBatch<OrderTree>("RedBlackTree with OrderStatistics");
+	testThrowingBuild<RedBlackTree<int, ThrowingValue> >("RedBlackTree");
+	testThrowingBuild<RedBlackTree<int, ThrowingValue, true> >("RedBlackTree with OrderStatistics");
+
+	return 0;
+}
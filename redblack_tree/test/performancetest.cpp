@@ -0,0 +1,130 @@
+#include "redblacktree.h"
+#include <algorithm>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000, 10000000};
+
+// Increasing keys where each one is moved back by up to this much
+const int JITTER = 16;
+
+vector<int> sequentialKeys;
+vector<int> nearSortedKeys;
+vector<int> randomKeys;
+
+const size_t BATCH_SIZE = 1000;
+const size_t BATCHES = 1000;
+
+template <bool NearEnd>
+void testPut(const char* name, const vector<int>& keys, size_t count) {
+	RedBlackTree<int, int>* tree = new RedBlackTree<int, int>();
+
+	clock_t initial = clock();
+	for (size_t i = 0; i < count; i++) {
+		if (NearEnd) {
+			tree->putNearEnd(keys[i], static_cast<int>(i));
+		} else {
+			tree->put(keys[i], static_cast<int>(i));
+		}
+	}
+	clock_t afterPut = clock();
+
+	delete tree;
+
+	cout << name << " " << (afterPut - initial) * 1000 / CLOCKS_PER_SEC << "ms" << endl;
+}
+
+// Looks up and then puts batches of BATCH_SIZE random keys in a tree of
+// count keys, one key at a time and as batches
+template <bool Batched>
+void testBatches(const char* name, size_t count) {
+	RedBlackTree<int, int>* tree = new RedBlackTree<int, int>();
+	for (size_t i = 0; i < count; i++) {
+		tree->put(randomKeys[i], static_cast<int>(i));
+	}
+
+	vector<int> batch(BATCH_SIZE);
+	vector<pair<int, int> > entries(BATCH_SIZE);
+	vector<const int*> results(BATCH_SIZE);
+	long long sum = 0;
+
+	clock_t initial = clock();
+	for (size_t i = 0; i < BATCHES; i++) {
+		for (size_t j = 0; j < BATCH_SIZE; j++) {
+			batch[j] = randomKeys[(i * BATCH_SIZE + j) * 7919 % randomKeys.size()];
+		}
+
+		if (Batched) {
+			tree->findBatch(batch.begin(), batch.end(), &results[0]);
+		} else {
+			for (size_t j = 0; j < BATCH_SIZE; j++) {
+				results[j] = tree->find(batch[j]);
+			}
+		}
+
+		for (size_t j = 0; j < BATCH_SIZE; j++) {
+			sum += results[j] != 0;
+		}
+	}
+	clock_t afterFind = clock();
+
+	for (size_t i = 0; i < BATCHES; i++) {
+		for (size_t j = 0; j < BATCH_SIZE; j++) {
+			entries[j] = make_pair(randomKeys[(i * BATCH_SIZE + j) * 7919 % randomKeys.size()], static_cast<int>(j));
+		}
+
+		if (Batched) {
+			tree->putBatch(entries.begin(), entries.end());
+		} else {
+			for (size_t j = 0; j < BATCH_SIZE; j++) {
+				tree->put(entries[j].first, entries[j].second);
+			}
+		}
+	}
+	clock_t afterPut = clock();
+
+	delete tree;
+
+	cout << name << " find " << (afterFind - initial) * 1000 / CLOCKS_PER_SEC << "ms put "
+		<< (afterPut - afterFind) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+void testAll(const vector<int>& keys, size_t count) {
+	testPut<false>("put       ", keys, count);
+	testPut<true>("putNearEnd", keys, count);
+}
+
+int main() {
+	int maxSize = TEST_SIZES[sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]) - 1];
+
+	for (int i = 0; i < maxSize; i++) {
+		sequentialKeys.push_back(i);
+		nearSortedKeys.push_back(i * JITTER - rand() % JITTER);
+	}
+	randomKeys = sequentialKeys;
+	random_shuffle(randomKeys.begin(), randomKeys.end());
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		cout << "Sequential keys, size " << TEST_SIZES[i] << endl;
+		testAll(sequentialKeys, TEST_SIZES[i]);
+		cout << endl;
+
+		cout << "Near-sorted keys, size " << TEST_SIZES[i] << endl;
+		testAll(nearSortedKeys, TEST_SIZES[i]);
+		cout << endl;
+
+		cout << "Random keys, size " << TEST_SIZES[i] << endl;
+		testAll(randomKeys, TEST_SIZES[i]);
+		cout << endl;
+
+		cout << "Batches of " << BATCH_SIZE << " random keys, size " << TEST_SIZES[i] << endl;
+		testBatches<false>("one by one", TEST_SIZES[i]);
+		testBatches<true>("batched   ", TEST_SIZES[i]);
+		cout << endl;
+	}
+
+	return 0;
+}
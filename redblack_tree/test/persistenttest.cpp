@@ -0,0 +1,126 @@
+#include "persistentredblacktree.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+using namespace std;
+
+bool matches(const PersistentRedBlackTree<int, int>& tree, const map<int, int>& expected, int range) {
+	for (int key = 0; key < range; key++) {
+		map<int, int>::const_iterator i = expected.find(key);
+
+		if (tree.contains(key) != (i != expected.end()) || (i != expected.end() && tree.get(key) != i->second)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void testAgainstMap() {
+	PersistentRedBlackTree<int, int> t;
+	map<int, int> m;
+
+	for (int i = 0; i < 200000; i++) {
+		int key = rand() % 5000;
+
+		if (rand() % 2 == 0) {
+			t.put(key, i);
+			m[key] = i;
+		} else if (m.count(key) != 0) {
+			t.remove(key);
+			m.erase(key);
+		}
+	}
+
+	if (!matches(t, m, 5000)) {
+		cout << "testAgainstMap failed\n";
+	}
+}
+
+void testSnapshotsAreUnchanged() {
+	PersistentRedBlackTree<int, int> t;
+	map<int, int> m;
+	vector<PersistentRedBlackTree<int, int> > snapshots;
+	vector<map<int, int> > expected;
+
+	for (int i = 0; i < 50000; i++) {
+		int key = rand() % 1000;
+
+		if (rand() % 3 == 0 && m.count(key) != 0) {
+			t.remove(key);
+			m.erase(key);
+		} else {
+			t.put(key, i);
+			m[key] = i;
+		}
+
+		if (i % 5000 == 0) {
+			snapshots.push_back(t.snapshot());
+			expected.push_back(m);
+		}
+	}
+
+	for (size_t i = 0; i < snapshots.size(); i++) {
+		if (!matches(snapshots[i], expected[i], 1000)) {
+			cout << "Fail on snapshot test with snapshot " << i << endl;
+		}
+	}
+
+	if (!matches(t, m, 1000)) {
+		cout << "testSnapshotsAreUnchanged failed\n";
+	}
+}
+
+void readSnapshot(PersistentRedBlackTree<int, int> snapshot, map<int, int> expected, bool* failed) {
+	for (int i = 0; i < 20; i++) {
+		if (!matches(snapshot, expected, 2000)) {
+			*failed = true;
+		}
+	}
+}
+
+void testConcurrentReaders() {
+	PersistentRedBlackTree<int, int> t;
+	map<int, int> m;
+	vector<thread> readers;
+	bool failed[8] = {false};
+
+	for (int i = 0; i < 2000; i += 2) {
+		t.put(i, i);
+		m[i] = i;
+	}
+
+	for (int reader = 0; reader < 8; reader++) {
+		readers.push_back(thread(readSnapshot, t.snapshot(), m, &failed[reader]));
+
+		for (int i = 0; i < 2000; i++) {
+			int key = rand() % 2000;
+
+			if (m.count(key) != 0) {
+				t.remove(key);
+				m.erase(key);
+			} else {
+				t.put(key, reader);
+				m[key] = reader;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < readers.size(); i++) {
+		readers[i].join();
+
+		if (failed[i]) {
+			cout << "Fail on concurrent readers test with reader " << i << endl;
+		}
+	}
+}
+
+int main() {
+	testAgainstMap();
+	testSnapshotsAreUnchanged();
+	testConcurrentReaders();
+
+	return 0;
+}
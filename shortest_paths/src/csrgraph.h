@@ -0,0 +1,262 @@
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct GraphEdge {
+	int source;
+	int dest;
+	int weight;
+};
+
+// A CsrGraph file holds the arrays of the graph as they are in memory, so
+// a loaded graph is used straight from the mapping:
+//
+//   header   magic, vertex count, edge count
+//   offsets  vertex count + 1 unsigned 64-bit integers
+//   targets  edge count 32-bit integers
+//   weights  edge count 32-bit integers
+//
+// Every array starts aligned for its type. Integers are written in the
+// byte order of the machine that writes the file.
+struct CsrGraphHeader {
+	char magic[8];
+	unsigned long long vertexCount;
+	unsigned long long edgeCount;
+
+	static const char* expectedMagic() {
+		return "CSRGRPH1";
+	}
+};
+
+// Directed graph with nonnegative integer weights in compressed sparse row
+// form: the edges of every vertex are adjacent in two arrays of targets
+// and weights, and an array of offsets by vertex marks where they start.
+// Scanning the edges of a vertex thus reads contiguous memory, with 8
+// bytes per edge and 8 per vertex.
+class CsrGraph {
+	int vertexCount;
+	std::size_t edgeCount;
+	// The arrays of a graph built in memory
+	std::vector<unsigned long long> offsetStorage;
+	std::vector<int> targetStorage;
+	std::vector<int> weightStorage;
+	// The file of a loaded graph, 0 for one built in memory
+	void* mapping;
+	std::size_t mappingSize;
+
+	// The edges of vertex v are offsets[v]..offsets[v + 1] - 1
+	const unsigned long long* offsets;
+	const int* targets;
+	const int* weights;
+
+	CsrGraph(const CsrGraph&);
+	CsrGraph& operator=(const CsrGraph&);
+
+	void useStorage() {
+		offsets = offsetStorage.data();
+		targets = targetStorage.data();
+		weights = weightStorage.data();
+	}
+
+	static std::size_t fileSize(unsigned long long vertexCount, unsigned long long edgeCount) {
+		return sizeof(CsrGraphHeader) + (vertexCount + 1) * sizeof(unsigned long long) + 2 * edgeCount * sizeof(int);
+	}
+
+public:
+	CsrGraph()
+		: vertexCount(0), edgeCount(0), offsetStorage(1, 0), mapping(0), mappingSize(0) {
+			useStorage();
+	}
+
+	// Sorts edges by source, keeping the order of the edges of every
+	// vertex, in O(vertexCount + edges). Throws std::exception if an edge
+	// has an endpoint out of range or a negative weight.
+	CsrGraph(int vertexCount, const std::vector<GraphEdge>& edges)
+		: vertexCount(vertexCount), edgeCount(edges.size()), offsetStorage(vertexCount + 1, 0),
+			targetStorage(edges.size()), weightStorage(edges.size()), mapping(0), mappingSize(0) {
+			for (std::size_t i = 0; i < edges.size(); i++) {
+				const GraphEdge& edge = edges[i];
+				if (edge.source < 0 || edge.source >= vertexCount || edge.dest < 0 || edge.dest >= vertexCount
+						|| edge.weight < 0) {
+					throw std::exception();
+				}
+
+				offsetStorage[edge.source + 1]++;
+			}
+
+			for (int vertex = 0; vertex < vertexCount; vertex++) {
+				offsetStorage[vertex + 1] += offsetStorage[vertex];
+			}
+
+			// The next free slot of every vertex, which ends up at its end
+			std::vector<unsigned long long> next(offsetStorage.begin(), offsetStorage.end() - 1);
+			for (std::size_t i = 0; i < edges.size(); i++) {
+				unsigned long long slot = next[edges[i].source]++;
+				targetStorage[slot] = edges[i].dest;
+				weightStorage[slot] = edges[i].weight;
+			}
+
+			useStorage();
+	}
+
+	// Maps a file written by writeFile. Only the header and the ends of the
+	// offsets are read, so this takes constant time and the arrays are
+	// paged in as they are used; the rest of the file is trusted.
+	explicit CsrGraph(const char* path)
+		: vertexCount(0), edgeCount(0), mapping(0), mappingSize(0) {
+			int descriptor = open(path, O_RDONLY);
+			if (descriptor < 0) {
+				throw std::exception();
+			}
+
+			struct stat status;
+			if (fstat(descriptor, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(CsrGraphHeader)) {
+				close(descriptor);
+				throw std::exception();
+			}
+			mappingSize = status.st_size;
+
+			mapping = mmap(0, mappingSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			close(descriptor);
+			if (mapping == MAP_FAILED) {
+				mapping = 0;
+				throw std::exception();
+			}
+
+			const char* data = static_cast<const char*>(mapping);
+			CsrGraphHeader header;
+			std::memcpy(&header, data, sizeof(header));
+			offsets = reinterpret_cast<const unsigned long long*>(data + sizeof(header));
+			// Counts the arrays could not fit in the file are rejected before
+			// fileSize, which would overflow on them
+			std::size_t arraysSize = mappingSize - sizeof(header);
+
+			if (std::memcmp(header.magic, CsrGraphHeader::expectedMagic(), sizeof(header.magic)) != 0
+					|| header.vertexCount > static_cast<unsigned long long>(INT_MAX)
+					|| header.vertexCount >= arraysSize / sizeof(unsigned long long)
+					|| header.edgeCount > arraysSize / (2 * sizeof(int))
+					|| fileSize(header.vertexCount, header.edgeCount) != mappingSize
+					|| offsets[0] != 0 || offsets[header.vertexCount] != header.edgeCount) {
+				munmap(mapping, mappingSize);
+				throw std::exception();
+			}
+
+			vertexCount = static_cast<int>(header.vertexCount);
+			edgeCount = header.edgeCount;
+			targets = reinterpret_cast<const int*>(offsets + vertexCount + 1);
+			weights = targets + edgeCount;
+	}
+
+	~CsrGraph() {
+		if (mapping != 0) {
+			munmap(mapping, mappingSize);
+		}
+	}
+
+	// Writes the graph in the format the path constructor maps. Throws
+	// std::exception if the file cannot be written.
+	void writeFile(const char* path) const {
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			throw std::exception();
+		}
+
+		CsrGraphHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, CsrGraphHeader::expectedMagic(), sizeof(header.magic));
+		header.vertexCount = vertexCount;
+		header.edgeCount = edgeCount;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(offsets), (vertexCount + 1) * sizeof(unsigned long long));
+		file.write(reinterpret_cast<const char*>(targets), edgeCount * sizeof(int));
+		file.write(reinterpret_cast<const char*>(weights), edgeCount * sizeof(int));
+		file.close();
+
+		if (!file) {
+			throw std::exception();
+		}
+	}
+
+	int getVertexCount() const {
+		return vertexCount;
+	}
+
+	std::size_t getEdgeCount() const {
+		return edgeCount;
+	}
+
+	// The edges of vertex are edgesBegin(vertex)..edgesEnd(vertex) - 1
+	std::size_t edgesBegin(int vertex) const {
+		return offsets[vertex];
+	}
+
+	std::size_t edgesEnd(int vertex) const {
+		return offsets[vertex + 1];
+	}
+
+	int getTarget(std::size_t edge) const {
+		return targets[edge];
+	}
+
+	int getWeight(std::size_t edge) const {
+		return weights[edge];
+	}
+
+	// Stores the graph with every edge reversed in reversed, with the edges
+	// into every vertex in the order of their sources
+	void getReversed(CsrGraph& reversed) const {
+		CsrGraph result;
+		result.vertexCount = vertexCount;
+		result.edgeCount = edgeCount;
+		result.offsetStorage.assign(vertexCount + 1, 0);
+		result.targetStorage.resize(edgeCount);
+		result.weightStorage.resize(edgeCount);
+
+		for (std::size_t edge = 0; edge < edgeCount; edge++) {
+			result.offsetStorage[targets[edge] + 1]++;
+		}
+		for (int vertex = 0; vertex < vertexCount; vertex++) {
+			result.offsetStorage[vertex + 1] += result.offsetStorage[vertex];
+		}
+
+		std::vector<unsigned long long> next(result.offsetStorage.begin(), result.offsetStorage.end() - 1);
+		for (int vertex = 0; vertex < vertexCount; vertex++) {
+			for (std::size_t edge = offsets[vertex]; edge < offsets[vertex + 1]; edge++) {
+				unsigned long long slot = next[targets[edge]]++;
+				result.targetStorage[slot] = vertex;
+				result.weightStorage[slot] = weights[edge];
+			}
+		}
+
+		result.useStorage();
+		reversed.swap(result);
+	}
+
+	void swap(CsrGraph& graph) {
+		std::swap(vertexCount, graph.vertexCount);
+		std::swap(edgeCount, graph.edgeCount);
+		offsetStorage.swap(graph.offsetStorage);
+		targetStorage.swap(graph.targetStorage);
+		weightStorage.swap(graph.weightStorage);
+		std::swap(mapping, graph.mapping);
+		std::swap(mappingSize, graph.mappingSize);
+		std::swap(offsets, graph.offsets);
+		std::swap(targets, graph.targets);
+		std::swap(weights, graph.weights);
+	}
+};
+
+#endif
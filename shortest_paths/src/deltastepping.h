@@ -0,0 +1,318 @@
+#ifndef DELTASTEPPING_H
+#define DELTASTEPPING_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "csrgraph.h"
+#include "dijkstra.h"
+
+// Single source shortest paths by delta-stepping on several threads. The
+// tentative distances are sorted into buckets of width delta, and all
+// vertices of the lowest nonempty bucket have their edges relaxed in
+// parallel, with an atomic minimum on the distance of every target; a
+// target whose distance drops goes into the bucket of its new distance in
+// a bucket array of the relaxing thread. The bucket is repeated while its
+// vertices reenter it, then the threads gather the next nonempty one.
+//
+// Every new distance lies within the largest weight of the current
+// bucket, so the bucket arrays are cyclic, with maxWeight / delta + 2
+// buckets, up to MAX_BUCKETS. Past that, distances too far ahead wait in a
+// heap of the thread until the current bucket comes close enough, so
+// memory stays proportional to the graph whatever the weights.
+//
+// A delta around the average edge weight works well. A smaller one gives
+// less parallelism and more buckets, a larger one relaxes vertices before
+// their distance is final more often; with a delta above every distance
+// this becomes a parallel Bellman-Ford.
+class DeltaSteppingSearch {
+	// Frontier vertices a thread takes at a time
+	static const std::size_t CHUNK_SIZE = 64;
+	// The most buckets in the cyclic array of a thread
+	static const std::size_t MAX_BUCKETS = 1 << 16;
+
+	// Blocks the threads that call wait until all count of them have
+	class Barrier {
+		std::mutex mutex;
+		std::condition_variable condition;
+		unsigned count;
+		unsigned waiting;
+		unsigned generation;
+
+		void release() {
+			waiting = 0;
+			generation++;
+			condition.notify_all();
+		}
+
+	public:
+		explicit Barrier(unsigned count)
+			: count(count), waiting(0), generation(0) {
+		}
+
+		void wait() {
+			std::unique_lock<std::mutex> lock(mutex);
+			unsigned arrivedGeneration = generation;
+
+			if (++waiting == count) {
+				release();
+			} else {
+				while (generation == arrivedGeneration) {
+					condition.wait(lock);
+				}
+			}
+		}
+
+		// Stops waiting for removed threads, which never call wait
+		void remove(unsigned removed) {
+			std::lock_guard<std::mutex> lock(mutex);
+			count -= removed;
+			if (waiting > 0 && waiting == count) {
+				release();
+			}
+		}
+	};
+
+	// A distance with its vertex, too far ahead for the bucket array
+	typedef std::pair<long long, int> FarEntry;
+
+	struct ThreadBuckets {
+		// Bucket i holds the vertices of distance / delta congruent to i
+		std::vector<std::vector<int> > buckets;
+		std::priority_queue<FarEntry, std::vector<FarEntry>, std::greater<FarEntry> > far;
+		std::exception_ptr error;
+	};
+
+	const CsrGraph* graph;
+	long long delta;
+	unsigned threadCount;
+	std::size_t bucketCount;
+	std::unique_ptr<std::atomic<long long>[]> distances;
+
+	// The vertices of the current bucket, with those whose distance has
+	// since dropped below it to be skipped
+	std::vector<int> frontier;
+	std::atomic<std::size_t> nextFrontierIndex;
+	std::size_t currentBucket;
+	bool isDone;
+	// Set when a thread has thrown, so all of them stop after the phase
+	std::atomic<bool> isFailed;
+	// The buckets every thread has filled
+	std::vector<ThreadBuckets> threadBuckets;
+
+	static std::size_t bucketCountFor(const CsrGraph& graph, long long delta) {
+		long long maxWeight = 0;
+		for (std::size_t edge = 0; edge < graph.getEdgeCount(); edge++) {
+			if (graph.getWeight(edge) > maxWeight) {
+				maxWeight = graph.getWeight(edge);
+			}
+		}
+
+		long long count = maxWeight / delta + 2;
+		return count < static_cast<long long>(MAX_BUCKETS) ? static_cast<std::size_t>(count) : MAX_BUCKETS;
+	}
+
+	void relaxFrontier(ThreadBuckets& buckets) {
+		long long bucketStart = static_cast<long long>(currentBucket) * delta;
+
+		for (;;) {
+			std::size_t begin = nextFrontierIndex.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+			if (begin >= frontier.size()) {
+				return;
+			}
+			std::size_t end = begin + CHUNK_SIZE < frontier.size() ? begin + CHUNK_SIZE : frontier.size();
+
+			for (std::size_t i = begin; i < end; i++) {
+				int vertex = frontier[i];
+				long long distance = distances[vertex].load(std::memory_order_relaxed);
+				if (distance < bucketStart) {
+					continue;
+				}
+
+				for (std::size_t edge = graph->edgesBegin(vertex); edge < graph->edgesEnd(vertex); edge++) {
+					int target = graph->getTarget(edge);
+					long long newDistance = distance + graph->getWeight(edge);
+					long long oldDistance = distances[target].load(std::memory_order_relaxed);
+
+					while (newDistance < oldDistance) {
+						if (distances[target].compare_exchange_weak(oldDistance, newDistance,
+								std::memory_order_relaxed)) {
+							std::size_t bucket = newDistance / delta;
+							if (bucket - currentBucket < bucketCount) {
+								buckets.buckets[bucket % bucketCount].push_back(target);
+							} else {
+								buckets.far.push(FarEntry(newDistance, target));
+							}
+							break;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Makes the lowest nonempty bucket of all threads the frontier, or sets
+	// isDone if there is none. Runs on one thread while the others wait.
+	void advance() {
+		std::size_t nextBucket = 0;
+		bool isFound = false;
+
+		for (unsigned thread = 0; thread < threadCount; thread++) {
+			ThreadBuckets& buckets = threadBuckets[thread];
+
+			for (std::size_t bucket = currentBucket;
+					bucket - currentBucket < bucketCount && (!isFound || bucket < nextBucket); bucket++) {
+				if (!buckets.buckets[bucket % bucketCount].empty()) {
+					nextBucket = bucket;
+					isFound = true;
+					break;
+				}
+			}
+
+			if (!buckets.far.empty()) {
+				std::size_t farBucket = buckets.far.top().first / delta;
+				if (!isFound || farBucket < nextBucket) {
+					nextBucket = farBucket;
+					isFound = true;
+				}
+			}
+		}
+
+		if (!isFound) {
+			isDone = true;
+			return;
+		}
+
+		// The buckets below nextBucket are empty, so the arrays move on to
+		// the distances that come within their reach
+		frontier.clear();
+		for (unsigned thread = 0; thread < threadCount; thread++) {
+			ThreadBuckets& buckets = threadBuckets[thread];
+
+			while (!buckets.far.empty() && buckets.far.top().first / delta - nextBucket < bucketCount) {
+				FarEntry entry = buckets.far.top();
+				buckets.far.pop();
+
+				// A vertex whose distance dropped since has a newer entry
+				if (distances[entry.second].load(std::memory_order_relaxed) == entry.first) {
+					buckets.buckets[entry.first / delta % bucketCount].push_back(entry.second);
+				}
+			}
+
+			std::vector<int>& bucket = buckets.buckets[nextBucket % bucketCount];
+			frontier.insert(frontier.end(), bucket.begin(), bucket.end());
+			bucket.clear();
+		}
+		currentBucket = nextBucket;
+		nextFrontierIndex.store(0, std::memory_order_relaxed);
+	}
+
+	// Runs the phases on thread until the search is done. An exception
+	// stops every thread at the end of the phase and is kept for run.
+	void work(unsigned thread, Barrier& barrier) {
+		for (;;) {
+			try {
+				relaxFrontier(threadBuckets[thread]);
+			} catch (...) {
+				threadBuckets[thread].error = std::current_exception();
+				isFailed.store(true);
+			}
+			barrier.wait();
+
+			if (thread == 0) {
+				try {
+					if (!isFailed.load()) {
+						advance();
+					}
+				} catch (...) {
+					threadBuckets[thread].error = std::current_exception();
+					isFailed.store(true);
+				}
+				if (isFailed.load()) {
+					isDone = true;
+				}
+			}
+			barrier.wait();
+
+			if (isDone) {
+				return;
+			}
+		}
+	}
+
+public:
+	// graph must outlive the search; delta must be positive
+	DeltaSteppingSearch(const CsrGraph& graph, long long delta,
+			unsigned threads = std::thread::hardware_concurrency())
+		: graph(&graph), delta(delta), threadCount(threads > 0 ? threads : 1), bucketCount(bucketCountFor(graph, delta)),
+			distances(new std::atomic<long long>[graph.getVertexCount()]), nextFrontierIndex(0),
+			currentBucket(0), isDone(false), isFailed(false), threadBuckets(threadCount) {
+		for (unsigned thread = 0; thread < threadCount; thread++) {
+			threadBuckets[thread].buckets.resize(bucketCount);
+		}
+	}
+
+	// Computes the distances from source to every vertex. If a thread
+	// cannot be started the others do its share; an exception on any
+	// thread is rethrown here once all have stopped.
+	void run(int source) {
+		for (int vertex = 0; vertex < graph->getVertexCount(); vertex++) {
+			distances[vertex].store(UNREACHABLE_DISTANCE, std::memory_order_relaxed);
+		}
+		distances[source].store(0, std::memory_order_relaxed);
+		frontier.assign(1, source);
+		nextFrontierIndex.store(0, std::memory_order_relaxed);
+		currentBucket = 0;
+		isDone = false;
+		isFailed.store(false);
+		for (unsigned thread = 0; thread < threadCount; thread++) {
+			ThreadBuckets& buckets = threadBuckets[thread];
+			for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+				buckets.buckets[bucket].clear();
+			}
+			buckets.far = std::priority_queue<FarEntry, std::vector<FarEntry>, std::greater<FarEntry> >();
+			buckets.error = std::exception_ptr();
+		}
+
+		Barrier barrier(threadCount);
+		std::vector<std::thread> workers;
+		workers.reserve(threadCount - 1);
+		try {
+			for (unsigned thread = 1; thread < threadCount; thread++) {
+				workers.push_back(std::thread(&DeltaSteppingSearch::work, this, thread, std::ref(barrier)));
+			}
+		} catch (...) {
+			barrier.remove(threadCount - 1 - static_cast<unsigned>(workers.size()));
+		}
+		work(0, barrier);
+
+		for (std::size_t i = 0; i < workers.size(); i++) {
+			workers[i].join();
+		}
+		for (unsigned thread = 0; thread < threadCount; thread++) {
+			if (threadBuckets[thread].error != 0) {
+				std::rethrow_exception(threadBuckets[thread].error);
+			}
+		}
+	}
+
+	// UNREACHABLE_DISTANCE if the last run did not reach vertex
+	long long getDistance(int vertex) const {
+		return distances[vertex].load(std::memory_order_relaxed);
+	}
+
+	bool isReached(int vertex) const {
+		return getDistance(vertex) != UNREACHABLE_DISTANCE;
+	}
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef DIJKSTRA_H
+#define DIJKSTRA_H
+
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "csrgraph.h"
+#include "../../indexed_heap/src/indexedheap.h"
+
+// The distance of a vertex the search has not reached
+const long long UNREACHABLE_DISTANCE = LLONG_MAX;
+
+// Dijkstra's algorithm on a CsrGraph, for answering many queries against
+// one graph. The heap, distances and parents are sized for the graph once
+// and reused by every query, which resets only the vertices the previous
+// one reached, so a query allocates nothing once the buffers have grown.
+//
+// The heap holds every vertex at most once and decreases its priority when
+// a shorter path to it is found, so no outdated entries are ever extracted.
+class DijkstraSearch {
+	const CsrGraph* graph;
+	IndexedHeap<long long> heap;
+	std::vector<long long> distances;
+	std::vector<int> parents;
+	// The vertices with a distance, in the order they were reached
+	std::vector<int> reached;
+
+	void reset() {
+		for (std::size_t i = 0; i < reached.size(); i++) {
+			distances[reached[i]] = UNREACHABLE_DISTANCE;
+			parents[reached[i]] = -1;
+		}
+		reached.clear();
+		heap.clear();
+	}
+
+public:
+	// graph must outlive the search
+	explicit DijkstraSearch(const CsrGraph& graph)
+		: graph(&graph), heap(graph.getVertexCount()), distances(graph.getVertexCount(), UNREACHABLE_DISTANCE),
+			parents(graph.getVertexCount(), -1) {
+	}
+
+	// Computes the distances from source to every vertex, dropping those of
+	// the previous query
+	void run(int source) {
+		reset();
+
+		distances[source] = 0;
+		reached.push_back(source);
+		heap.push(source, 0);
+
+		while (!heap.isEmpty()) {
+			int vertex = heap.getMinId();
+			long long distance = heap.getMinPriority();
+			heap.extractMin();
+
+			for (std::size_t edge = graph->edgesBegin(vertex); edge < graph->edgesEnd(vertex); edge++) {
+				int target = graph->getTarget(edge);
+				long long newDistance = distance + graph->getWeight(edge);
+
+				// A settled target is never closer, so never reenters the heap
+				if (newDistance < distances[target]) {
+					if (distances[target] == UNREACHABLE_DISTANCE) {
+						reached.push_back(target);
+						heap.push(target, newDistance);
+					} else {
+						heap.decreaseKey(target, newDistance);
+					}
+
+					distances[target] = newDistance;
+					parents[target] = vertex;
+				}
+			}
+		}
+	}
+
+	// UNREACHABLE_DISTANCE if the last query did not reach vertex
+	long long getDistance(int vertex) const {
+		return distances[vertex];
+	}
+
+	bool isReached(int vertex) const {
+		return distances[vertex] != UNREACHABLE_DISTANCE;
+	}
+
+	// The vertex before vertex on a shortest path, -1 for the source and
+	// the vertices not reached
+	int getParent(int vertex) const {
+		return parents[vertex];
+	}
+
+	// The vertices the last query reached, in the order it reached them
+	const std::vector<int>& getReachedVertices() const {
+		return reached;
+	}
+
+	// Stores the vertices of a shortest path from the source to target in
+	// path, which is left empty if target was not reached
+	void getPath(int target, std::vector<int>& path) const {
+		path.clear();
+		if (!isReached(target)) {
+			return;
+		}
+
+		for (int vertex = target; vertex != -1; vertex = parents[vertex]) {
+			path.push_back(vertex);
+		}
+		for (std::size_t i = 0; i < path.size() / 2; i++) {
+			std::swap(path[i], path[path.size() - 1 - i]);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,254 @@
+#ifndef EDGELISTREADER_H
+#define EDGELISTREADER_H
+
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csrgraph.h"
+
+// Reads text edge lists: one "source dest weight" line per edge, with
+// vertices numbered from 1 as uidijkstra takes them and nonnegative
+// weights. A "# vertices n" line gives the vertex count, which otherwise is
+// the largest vertex number with an edge; isolated vertices numbered past
+// it exist only through that line. Other empty lines and lines starting
+// with # are skipped.
+
+inline bool isEdgeListBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Reads a nonnegative number at in, which must be followed by a blank, a
+// line end or end. Returns the position after it, or 0 if there is none.
+inline const char* readEdgeListNumber(const char* in, const char* end, int& number) {
+	if (in == end || *in < '0' || *in > '9') {
+		return 0;
+	}
+
+	long long result = 0;
+	for (; in != end && *in >= '0' && *in <= '9'; in++) {
+		result = result * 10 + (*in - '0');
+		if (result > INT_MAX) {
+			return 0;
+		}
+	}
+
+	if (in != end && !isEdgeListBlank(*in) && *in != '\n') {
+		return 0;
+	}
+	number = static_cast<int>(result);
+
+	return in;
+}
+
+const char EDGE_LIST_VERTEX_COUNT[] = "# vertices ";
+
+// Whether the line at in is a "# vertices n" line
+inline bool isEdgeListVertexCount(const char* in, const char* end) {
+	std::size_t length = sizeof(EDGE_LIST_VERTEX_COUNT) - 1;
+
+	return static_cast<std::size_t>(end - in) >= length && std::memcmp(in, EDGE_LIST_VERTEX_COUNT, length) == 0;
+}
+
+// Appends the edges of the lines in [in, end), both ways if isUndirected,
+// with vertices numbered from 0, raises maxVertex to the largest vertex and
+// sets vertexCount if there is a "# vertices n" line. Returns false on a
+// malformed line.
+inline bool readEdgeListLines(const char* in, const char* end, bool isUndirected, std::vector<GraphEdge>& edges,
+		int& maxVertex, int& vertexCount) {
+	while (in != end) {
+		if (isEdgeListBlank(*in) || *in == '\n') {
+			in++;
+			continue;
+		}
+		if (isEdgeListVertexCount(in, end)) {
+			in += sizeof(EDGE_LIST_VERTEX_COUNT) - 1;
+			while (in != end && isEdgeListBlank(*in)) {
+				in++;
+			}
+
+			int count;
+			in = readEdgeListNumber(in, end, count);
+			if (in == 0 || (vertexCount >= 0 && count != vertexCount)) {
+				return false;
+			}
+			vertexCount = count;
+
+			while (in != end && isEdgeListBlank(*in)) {
+				in++;
+			}
+			if (in != end && *in != '\n') {
+				return false;
+			}
+			continue;
+		}
+		if (*in == '#') {
+			while (in != end && *in != '\n') {
+				in++;
+			}
+			continue;
+		}
+
+		int numbers[3];
+		for (int i = 0; i < 3; i++) {
+			while (in != end && isEdgeListBlank(*in)) {
+				in++;
+			}
+
+			in = readEdgeListNumber(in, end, numbers[i]);
+			if (in == 0) {
+				return false;
+			}
+		}
+		while (in != end && isEdgeListBlank(*in)) {
+			in++;
+		}
+		if ((in != end && *in != '\n') || numbers[0] == 0 || numbers[1] == 0) {
+			return false;
+		}
+
+		GraphEdge edge = { numbers[0] - 1, numbers[1] - 1, numbers[2] };
+		edges.push_back(edge);
+		if (isUndirected) {
+			GraphEdge backward = { edge.dest, edge.source, edge.weight };
+			edges.push_back(backward);
+		}
+
+		if (edge.source > maxVertex) {
+			maxVertex = edge.source;
+		}
+		if (edge.dest > maxVertex) {
+			maxVertex = edge.dest;
+		}
+	}
+
+	return true;
+}
+
+// Reads the edge list file at path, split at line ends into one part per
+// thread, and returns its edges in file order. Sets vertexCount to that of
+// the "# vertices n" line, or to the largest vertex number without one.
+// Throws std::exception if the file cannot be read, has a malformed line,
+// has "# vertices" lines that disagree or an edge to a vertex past the
+// count; an exception in a reader thread is rethrown on the calling one.
+inline std::vector<GraphEdge> readEdgeListFile(const char* path, bool isUndirected, int& vertexCount,
+		unsigned threads = std::thread::hardware_concurrency()) {
+	int descriptor = open(path, O_RDONLY);
+	if (descriptor < 0) {
+		throw std::exception();
+	}
+
+	struct stat status;
+	if (fstat(descriptor, &status) != 0) {
+		close(descriptor);
+		throw std::exception();
+	}
+	std::size_t size = status.st_size;
+
+	vertexCount = 0;
+	if (size == 0) {
+		close(descriptor);
+		return std::vector<GraphEdge>();
+	}
+
+	void* mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+	if (mapping == MAP_FAILED) {
+		throw std::exception();
+	}
+	const char* data = static_cast<const char*>(mapping);
+
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	// Part i is [bounds[i], bounds[i + 1]), starting at a line
+	std::vector<std::size_t> bounds(threads + 1, size);
+	bounds[0] = 0;
+	for (unsigned i = 1; i < threads; i++) {
+		std::size_t bound = size / threads * i;
+		if (bound < bounds[i - 1]) {
+			bound = bounds[i - 1];
+		}
+		while (bound < size && bound > 0 && data[bound - 1] != '\n') {
+			bound++;
+		}
+		bounds[i] = bound;
+	}
+
+	std::vector<std::vector<GraphEdge> > parts(threads);
+	std::vector<int> maxVertices(threads, -1);
+	std::vector<int> vertexCounts(threads, -1);
+	std::vector<char> isValid(threads, false);
+	std::vector<std::exception_ptr> errors(threads);
+	auto readPart = [&](unsigned i) {
+		try {
+			isValid[i] = readEdgeListLines(data + bounds[i], data + bounds[i + 1], isUndirected, parts[i], maxVertices[i],
+				vertexCounts[i]);
+		} catch (...) {
+			errors[i] = std::current_exception();
+		}
+	};
+
+	std::vector<std::thread> readers;
+	try {
+		for (unsigned i = 1; i < threads; i++) {
+			readers.push_back(std::thread(readPart, i));
+		}
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	if (errors[0] == 0) {
+		readPart(0);
+	}
+
+	for (std::size_t i = 0; i < readers.size(); i++) {
+		readers[i].join();
+	}
+	munmap(mapping, size);
+
+	std::size_t edgeCount = 0;
+	int maxVertex = -1;
+	int declaredCount = -1;
+	for (unsigned i = 0; i < threads; i++) {
+		if (errors[i] != 0) {
+			std::rethrow_exception(errors[i]);
+		}
+	}
+	for (unsigned i = 0; i < threads; i++) {
+		if (!isValid[i] || (vertexCounts[i] >= 0 && declaredCount >= 0 && vertexCounts[i] != declaredCount)) {
+			throw std::exception();
+		}
+
+		edgeCount += parts[i].size();
+		if (maxVertices[i] > maxVertex) {
+			maxVertex = maxVertices[i];
+		}
+		if (vertexCounts[i] >= 0) {
+			declaredCount = vertexCounts[i];
+		}
+	}
+	if (declaredCount >= 0 && maxVertex >= declaredCount) {
+		throw std::exception();
+	}
+
+	std::vector<GraphEdge> edges;
+	edges.reserve(edgeCount);
+	for (unsigned i = 0; i < threads; i++) {
+		edges.insert(edges.end(), parts[i].begin(), parts[i].end());
+		std::vector<GraphEdge>().swap(parts[i]);
+	}
+	vertexCount = declaredCount >= 0 ? declaredCount : maxVertex + 1;
+
+	return edges;
+}
+
+#endif
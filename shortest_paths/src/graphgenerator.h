@@ -0,0 +1,134 @@
+#ifndef GRAPHGENERATOR_H
+#define GRAPHGENERATOR_H
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "csrgraph.h"
+
+// Generators of edge lists for testing and benchmarking the shortest path
+// algorithms. The same seed gives the same graph.
+
+// edgeCount edges between uniformly random vertices, with weights uniform
+// in 1..maxWeight
+inline std::vector<GraphEdge> generateRandomGraph(int vertexCount, std::size_t edgeCount, int maxWeight,
+		unsigned seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> vertex(0, vertexCount - 1);
+	std::uniform_int_distribution<int> weight(1, maxWeight);
+
+	std::vector<GraphEdge> edges(edgeCount);
+	for (std::size_t i = 0; i < edgeCount; i++) {
+		edges[i].source = vertex(generator);
+		edges[i].dest = vertex(generator);
+		edges[i].weight = weight(generator);
+	}
+
+	return edges;
+}
+
+// A rows by columns grid in which vertex r * columns + c has edges both
+// ways to its right and lower neighbours, with weights uniform in
+// 1..maxWeight
+inline std::vector<GraphEdge> generateGridGraph(int rows, int columns, int maxWeight, unsigned seed) {
+	std::mt19937 generator(seed);
+	std::uniform_int_distribution<int> weight(1, maxWeight);
+
+	std::vector<GraphEdge> edges;
+	edges.reserve(4 * static_cast<std::size_t>(rows) * columns);
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			int vertex = row * columns + column;
+
+			if (column + 1 < columns) {
+				int edgeWeight = weight(generator);
+				GraphEdge right = { vertex, vertex + 1, edgeWeight };
+				GraphEdge left = { vertex + 1, vertex, edgeWeight };
+				edges.push_back(right);
+				edges.push_back(left);
+			}
+			if (row + 1 < rows) {
+				int edgeWeight = weight(generator);
+				GraphEdge down = { vertex, vertex + columns, edgeWeight };
+				GraphEdge up = { vertex + columns, vertex, edgeWeight };
+				edges.push_back(down);
+				edges.push_back(up);
+			}
+		}
+	}
+
+	return edges;
+}
+
+// A road network like graph of rows * columns junctions: the junctions are
+// grid points moved by up to a third of the spacing, and streets join
+// neighbours both ways, some missing and some diagonal. Every 16th row and
+// column is a highway, four times as fast and never interrupted. The
+// weights are travel times, 10 per spacing on streets.
+inline std::vector<GraphEdge> generateRoadGraph(int rows, int columns, unsigned seed) {
+	const int HIGHWAY_SPACING = 16;
+	const double STREET_TIME = 10.0;
+	const double HIGHWAY_TIME = STREET_TIME / 4;
+
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<double> offset(-1.0 / 3, 1.0 / 3);
+	std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+	std::vector<double> x(static_cast<std::size_t>(rows) * columns);
+	std::vector<double> y(x.size());
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			x[row * columns + column] = column + offset(generator);
+			y[row * columns + column] = row + offset(generator);
+		}
+	}
+
+	std::vector<GraphEdge> edges;
+	edges.reserve(5 * x.size());
+
+	struct Street {
+		std::vector<GraphEdge>& edges;
+		const std::vector<double>& x;
+		const std::vector<double>& y;
+
+		void add(int from, int to, double timePerSpacing) {
+			double length = std::sqrt((x[from] - x[to]) * (x[from] - x[to]) + (y[from] - y[to]) * (y[from] - y[to]));
+			int time = static_cast<int>(length * timePerSpacing) + 1;
+
+			GraphEdge forward = { from, to, time };
+			GraphEdge backward = { to, from, time };
+			edges.push_back(forward);
+			edges.push_back(backward);
+		}
+	} street = { edges, x, y };
+
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			int vertex = row * columns + column;
+
+			if (column + 1 < columns) {
+				if (row % HIGHWAY_SPACING == 0) {
+					street.add(vertex, vertex + 1, HIGHWAY_TIME);
+				} else if (chance(generator) < 0.85) {
+					street.add(vertex, vertex + 1, STREET_TIME);
+				}
+			}
+			if (row + 1 < rows) {
+				if (column % HIGHWAY_SPACING == 0) {
+					street.add(vertex, vertex + columns, HIGHWAY_TIME);
+				} else if (chance(generator) < 0.85) {
+					street.add(vertex, vertex + columns, STREET_TIME);
+				}
+			}
+			if (row + 1 < rows && column + 1 < columns && chance(generator) < 0.1) {
+				street.add(vertex, vertex + columns + 1, STREET_TIME);
+			}
+		}
+	}
+
+	return edges;
+}
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef POINTTOPOINT_H
+#define POINTTOPOINT_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "csrgraph.h"
+#include "dijkstra.h"
+#include "../../indexed_heap/src/indexedheap.h"
+
+// The heuristic of plain Dijkstra
+struct ZeroHeuristic {
+	long long operator()(int, int) const {
+		return 0;
+	}
+};
+
+// The ALT heuristic: lower bounds on distances from the distances to and
+// from a few landmark vertices by the triangle inequality. For a landmark
+// L, d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L).
+// Landmarks far apart and at the edge of the graph give the best bounds,
+// so every landmark is the vertex farthest from those chosen before it.
+class LandmarkHeuristic {
+	int landmarkCount;
+	// The distances from and to landmark i of vertex v, at v * landmarkCount
+	// + i so that the bounds for one vertex read one block
+	std::vector<long long> fromLandmarks;
+	std::vector<long long> toLandmarks;
+
+public:
+	// reversed must be graph with every edge reversed (see
+	// CsrGraph::getReversed). Takes 2 * landmarkCount searches. With no
+	// landmarks every bound is 0.
+	LandmarkHeuristic(const CsrGraph& graph, const CsrGraph& reversed, int landmarkCount)
+		: landmarkCount(landmarkCount),
+			fromLandmarks(static_cast<std::size_t>(graph.getVertexCount()) * landmarkCount, UNREACHABLE_DISTANCE),
+			toLandmarks(fromLandmarks.size(), UNREACHABLE_DISTANCE) {
+		if (graph.getVertexCount() == 0 || landmarkCount == 0) {
+			return;
+		}
+
+		DijkstraSearch forward(graph);
+		DijkstraSearch backward(reversed);
+		// The distance of every vertex from the closest landmark so far
+		std::vector<long long> closest(graph.getVertexCount(), UNREACHABLE_DISTANCE);
+
+		// The first landmark is the vertex farthest from vertex 0
+		forward.run(0);
+		for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+			closest[vertex] = forward.getDistance(vertex);
+		}
+
+		for (int i = 0; i < landmarkCount; i++) {
+			int landmark = 0;
+			for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+				if (closest[vertex] != UNREACHABLE_DISTANCE
+						&& (closest[landmark] == UNREACHABLE_DISTANCE || closest[vertex] > closest[landmark])) {
+					landmark = vertex;
+				}
+			}
+			if (i == 0) {
+				closest.assign(closest.size(), UNREACHABLE_DISTANCE);
+			}
+
+			forward.run(landmark);
+			backward.run(landmark);
+			for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+				fromLandmarks[static_cast<std::size_t>(vertex) * landmarkCount + i] = forward.getDistance(vertex);
+				toLandmarks[static_cast<std::size_t>(vertex) * landmarkCount + i] = backward.getDistance(vertex);
+
+				if (forward.getDistance(vertex) < closest[vertex]) {
+					closest[vertex] = forward.getDistance(vertex);
+				}
+			}
+		}
+	}
+
+	int getLandmarkCount() const {
+		return landmarkCount;
+	}
+
+	long long operator()(int vertex, int target) const {
+		if (landmarkCount == 0) {
+			return 0;
+		}
+
+		const long long* vertexFrom = &fromLandmarks[static_cast<std::size_t>(vertex) * landmarkCount];
+		const long long* targetFrom = &fromLandmarks[static_cast<std::size_t>(target) * landmarkCount];
+		const long long* vertexTo = &toLandmarks[static_cast<std::size_t>(vertex) * landmarkCount];
+		const long long* targetTo = &toLandmarks[static_cast<std::size_t>(target) * landmarkCount];
+		long long result = 0;
+
+		for (int i = 0; i < landmarkCount; i++) {
+			if (vertexFrom[i] != UNREACHABLE_DISTANCE && targetFrom[i] != UNREACHABLE_DISTANCE
+					&& targetFrom[i] - vertexFrom[i] > result) {
+				result = targetFrom[i] - vertexFrom[i];
+			}
+			if (vertexTo[i] != UNREACHABLE_DISTANCE && targetTo[i] != UNREACHABLE_DISTANCE
+					&& vertexTo[i] - targetTo[i] > result) {
+				result = vertexTo[i] - targetTo[i];
+			}
+		}
+
+		return result;
+	}
+};
+
+// Shortest paths between two vertices, by Dijkstra's algorithm stopping at
+// the target, by bidirectional Dijkstra or by A*. A search owns its scratch
+// space: a heap, distances and parents for each direction, sized for the
+// graph once. Distances and parents carry the number of the query that set
+// them, so starting a query only increments that number instead of
+// clearing the arrays, and a query costs time in the vertices it reaches.
+// A search answers one query at a time; use one per thread.
+class PointToPointSearch {
+	struct Side {
+		const CsrGraph* graph;
+		IndexedHeap<long long> heap;
+		std::vector<long long> distances;
+		std::vector<int> parents;
+		// The distance and parent of vertex belong to the current query if
+		// stamps[vertex] is its number
+		std::vector<unsigned> stamps;
+
+		explicit Side(const CsrGraph& graph)
+			: graph(&graph), heap(graph.getVertexCount()), distances(graph.getVertexCount()),
+				parents(graph.getVertexCount()), stamps(graph.getVertexCount(), 0) {
+		}
+	};
+
+	Side forward;
+	Side backward;
+	unsigned query;
+	// Where the paths of the two sides meet on the path found by the last
+	// query, -1 if there is none
+	int meeting;
+	std::size_t settledCount;
+
+	void startQuery() {
+		if (++query == 0) {
+			forward.stamps.assign(forward.stamps.size(), 0);
+			backward.stamps.assign(backward.stamps.size(), 0);
+			query = 1;
+		}
+
+		forward.heap.clear();
+		backward.heap.clear();
+		meeting = -1;
+		settledCount = 0;
+	}
+
+	bool isSet(const Side& side, int vertex) const {
+		return side.stamps[vertex] == query;
+	}
+
+	void set(Side& side, int vertex, long long distance, int parent) {
+		side.stamps[vertex] = query;
+		side.distances[vertex] = distance;
+		side.parents[vertex] = parent;
+	}
+
+public:
+	// reversed must be graph with every edge reversed (see
+	// CsrGraph::getReversed). Both must outlive the search.
+	PointToPointSearch(const CsrGraph& graph, const CsrGraph& reversed)
+		: forward(graph), backward(reversed), query(0), meeting(-1), settledCount(0) {
+	}
+
+	// A* from source to target with heuristic(vertex, target) a lower bound
+	// on the distance from vertex to target. A vertex whose distance drops
+	// after it was settled goes back into the heap, which a consistent
+	// heuristic, one that drops by at most the weight of any edge, never
+	// causes. Returns the distance, or UNREACHABLE_DISTANCE.
+	template <typename Heuristic>
+	long long aStar(int source, int target, const Heuristic& heuristic) {
+		startQuery();
+
+		set(forward, source, 0, -1);
+		forward.heap.push(source, heuristic(source, target));
+
+		while (!forward.heap.isEmpty()) {
+			int vertex = forward.heap.getMinId();
+			forward.heap.extractMin();
+			settledCount++;
+
+			long long distance = forward.distances[vertex];
+			if (vertex == target) {
+				meeting = target;
+				return distance;
+			}
+
+			const CsrGraph& graph = *forward.graph;
+			for (std::size_t edge = graph.edgesBegin(vertex); edge < graph.edgesEnd(vertex); edge++) {
+				int next = graph.getTarget(edge);
+				long long newDistance = distance + graph.getWeight(edge);
+
+				if (!isSet(forward, next) || newDistance < forward.distances[next]) {
+					set(forward, next, newDistance, vertex);
+					forward.heap.pushOrDecrease(next, newDistance + heuristic(next, target));
+				}
+			}
+		}
+
+		return UNREACHABLE_DISTANCE;
+	}
+
+	// Dijkstra from source until target is settled
+	long long dijkstra(int source, int target) {
+		return aStar(source, target, ZeroHeuristic());
+	}
+
+	// Dijkstra from source on the graph and from target on the reversed one,
+	// advancing the side with the smaller heap, until the smallest distances
+	// in the two heaps add up to at least the shortest path seen. Settles
+	// about two balls of half the radius of the one of dijkstra.
+	long long bidirectional(int source, int target) {
+		startQuery();
+
+		long long best = UNREACHABLE_DISTANCE;
+		set(forward, source, 0, -1);
+		forward.heap.push(source, 0);
+		set(backward, target, 0, -1);
+		backward.heap.push(target, 0);
+		if (source == target) {
+			best = 0;
+			meeting = source;
+		}
+
+		while (!forward.heap.isEmpty() && !backward.heap.isEmpty()
+				&& forward.heap.getMinPriority() + backward.heap.getMinPriority() < best) {
+			bool isForward = forward.heap.getSize() <= backward.heap.getSize();
+			Side& side = isForward ? forward : backward;
+			Side& other = isForward ? backward : forward;
+
+			int vertex = side.heap.getMinId();
+			long long distance = side.heap.getMinPriority();
+			side.heap.extractMin();
+			settledCount++;
+
+			const CsrGraph& graph = *side.graph;
+			for (std::size_t edge = graph.edgesBegin(vertex); edge < graph.edgesEnd(vertex); edge++) {
+				int next = graph.getTarget(edge);
+				long long newDistance = distance + graph.getWeight(edge);
+
+				if (!isSet(side, next) || newDistance < side.distances[next]) {
+					set(side, next, newDistance, vertex);
+					side.heap.pushOrDecrease(next, newDistance);
+
+					if (isSet(other, next) && newDistance + other.distances[next] < best) {
+						best = newDistance + other.distances[next];
+						meeting = next;
+					}
+				}
+			}
+		}
+
+		return best;
+	}
+
+	// Stores the vertices of the path the last query found in path, which
+	// is left empty if there was none
+	void getPath(std::vector<int>& path) const {
+		path.clear();
+		if (meeting == -1) {
+			return;
+		}
+
+		for (int vertex = meeting; vertex != -1; vertex = forward.parents[vertex]) {
+			path.push_back(vertex);
+		}
+		for (std::size_t i = 0; i < path.size() / 2; i++) {
+			std::swap(path[i], path[path.size() - 1 - i]);
+		}
+
+		if (isSet(backward, meeting)) {
+			for (int vertex = backward.parents[meeting]; vertex != -1; vertex = backward.parents[vertex]) {
+				path.push_back(vertex);
+			}
+		}
+	}
+
+	// The vertices the last query took out of its heaps
+	std::size_t getSettledCount() const {
+		return settledCount;
+	}
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef QUERYENGINE_H
+#define QUERYENGINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "csrgraph.h"
+#include "pointtopoint.h"
+
+// Answers batches of point to point queries against one graph on a pool
+// of threads, each with its own PointToPointSearch. The threads start with
+// the engine and wait between batches; the queries of a batch are handed
+// out one at a time, so a few long ones do not hold up the rest.
+template <typename Heuristic = ZeroHeuristic>
+class QueryEngine {
+public:
+	enum Algorithm {DIJKSTRA, BIDIRECTIONAL, A_STAR};
+
+	struct Query {
+		int source;
+		int target;
+	};
+
+private:
+	Heuristic heuristic;
+	// One search per thread, the one of the calling thread first
+	std::vector<PointToPointSearch> searches;
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable batchStarted;
+	std::condition_variable batchFinished;
+	// Incremented for every batch
+	unsigned batch;
+	unsigned busyWorkers;
+	bool isStopping;
+
+	// The current batch
+	const Query* queries;
+	long long* results;
+	std::size_t queryCount;
+	Algorithm algorithm;
+	std::atomic<std::size_t> nextQuery;
+
+	QueryEngine(const QueryEngine&);
+	QueryEngine& operator=(const QueryEngine&);
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			isStopping = true;
+		}
+		batchStarted.notify_all();
+
+		for (std::size_t i = 0; i < workers.size(); i++) {
+			workers[i].join();
+		}
+	}
+
+	void answer(PointToPointSearch& search) {
+		for (;;) {
+			std::size_t i = nextQuery.fetch_add(1, std::memory_order_relaxed);
+			if (i >= queryCount) {
+				return;
+			}
+
+			switch (algorithm) {
+			case DIJKSTRA:
+				results[i] = search.dijkstra(queries[i].source, queries[i].target);
+				break;
+			case BIDIRECTIONAL:
+				results[i] = search.bidirectional(queries[i].source, queries[i].target);
+				break;
+			case A_STAR:
+				results[i] = search.aStar(queries[i].source, queries[i].target, heuristic);
+				break;
+			}
+		}
+	}
+
+	void work(unsigned index) {
+		unsigned seenBatch = 0;
+
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				while (batch == seenBatch && !isStopping) {
+					batchStarted.wait(lock);
+				}
+				if (isStopping) {
+					return;
+				}
+				seenBatch = batch;
+			}
+
+			answer(searches[index]);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--busyWorkers == 0) {
+				batchFinished.notify_one();
+			}
+		}
+	}
+
+public:
+	// reversed must be graph with every edge reversed (see
+	// CsrGraph::getReversed); both must outlive the engine. The heuristic is
+	// copied and shared by the threads.
+	QueryEngine(const CsrGraph& graph, const CsrGraph& reversed, const Heuristic& heuristic = Heuristic(),
+			unsigned threads = std::thread::hardware_concurrency())
+		: heuristic(heuristic), batch(0), busyWorkers(0), isStopping(false), queries(0), results(0), queryCount(0),
+			algorithm(DIJKSTRA), nextQuery(0) {
+		if (threads == 0) {
+			threads = 1;
+		}
+
+		searches.reserve(threads);
+		for (unsigned i = 0; i < threads; i++) {
+			searches.push_back(PointToPointSearch(graph, reversed));
+		}
+
+		// Reserved first, so a started thread is never lost to a failed
+		// push_back; if one cannot be started the others are stopped
+		workers.reserve(threads - 1);
+		try {
+			for (unsigned i = 1; i < threads; i++) {
+				workers.push_back(std::thread(&QueryEngine::work, this, i));
+			}
+		} catch (...) {
+			stop();
+			throw;
+		}
+	}
+
+	~QueryEngine() {
+		stop();
+	}
+
+	unsigned getThreadCount() const {
+		return searches.size();
+	}
+
+	// Answers queries with algorithm, the calling thread helping the pool,
+	// and stores the distance of queries[i] in results[i]. One batch runs at
+	// a time.
+	void run(const std::vector<Query>& queries, std::vector<long long>& results, Algorithm algorithm) {
+		results.resize(queries.size());
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			this->queries = queries.data();
+			this->results = results.data();
+			queryCount = queries.size();
+			this->algorithm = algorithm;
+			nextQuery.store(0, std::memory_order_relaxed);
+			busyWorkers = workers.size();
+			batch++;
+		}
+		batchStarted.notify_all();
+
+		answer(searches[0]);
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while (busyWorkers != 0) {
+			batchFinished.wait(lock);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,619 @@
+#include "csrgraph.h"
+#include "deltastepping.h"
+#include "dijkstra.h"
+#include "edgelistreader.h"
+#include "graphgenerator.h"
+#include "pointtopoint.h"
+#include "queryengine.h"
+#include "../../fibonacci_heap/src/fibheap.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int SOURCES = 5;
+const char* const GRAPH_PATH = "csrgraph-test.graph";
+const char* const EDGE_LIST_PATH = "csrgraph-test.txt";
+
+vector<long long> bellmanFord(const CsrGraph& graph, int source) {
+	vector<long long> distance(graph.getVertexCount(), UNREACHABLE_DISTANCE);
+	distance[source] = 0;
+
+	for (bool changed = true; changed;) {
+		changed = false;
+
+		for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+			if (distance[vertex] == UNREACHABLE_DISTANCE) {
+				continue;
+			}
+
+			for (size_t edge = graph.edgesBegin(vertex); edge < graph.edgesEnd(vertex); edge++) {
+				long long newDistance = distance[vertex] + graph.getWeight(edge);
+				if (newDistance < distance[graph.getTarget(edge)]) {
+					distance[graph.getTarget(edge)] = newDistance;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	return distance;
+}
+
+struct VertexDistance {
+	int vertex;
+	long long distance;
+
+	VertexDistance(int vertex, long long distance)
+		: vertex(vertex), distance(distance) {
+	}
+
+	bool operator<(const VertexDistance& other) const {
+		return distance < other.distance;
+	}
+};
+
+// Distances from source by Dijkstra on a FibonacciHeap
+vector<long long> fibonacciDijkstra(const CsrGraph& graph, int source) {
+	typedef FibonacciHeap<VertexDistance> Heap;
+
+	vector<long long> distance(graph.getVertexCount(), UNREACHABLE_DISTANCE);
+	vector<Heap::Element> elements(graph.getVertexCount());
+	vector<bool> isSettled(graph.getVertexCount(), false);
+	Heap heap;
+
+	distance[source] = 0;
+	elements[source] = heap.insert(VertexDistance(source, 0));
+	while (!heap.isEmpty()) {
+		int vertex = heap.getMin().vertex;
+		heap.extractMin();
+		isSettled[vertex] = true;
+
+		for (size_t edge = graph.edgesBegin(vertex); edge < graph.edgesEnd(vertex); edge++) {
+			int target = graph.getTarget(edge);
+			long long newDistance = distance[vertex] + graph.getWeight(edge);
+
+			if (!isSettled[target] && newDistance < distance[target]) {
+				if (distance[target] == UNREACHABLE_DISTANCE) {
+					elements[target] = heap.insert(VertexDistance(target, newDistance));
+				} else {
+					heap.decreaseKey(elements[target], VertexDistance(target, newDistance));
+				}
+				distance[target] = newDistance;
+			}
+		}
+	}
+
+	return distance;
+}
+
+// Whether the graph has an edge from source to dest of weight weight
+bool hasEdge(const CsrGraph& graph, int source, int dest, long long weight) {
+	for (size_t edge = graph.edgesBegin(source); edge < graph.edgesEnd(source); edge++) {
+		if (graph.getTarget(edge) == dest && graph.getWeight(edge) == weight) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void testCsrGraph() {
+	vector<GraphEdge> edges;
+	GraphEdge list[] = {{2, 0, 5}, {0, 1, 1}, {2, 1, 3}, {0, 2, 2}, {2, 2, 0}};
+	edges.assign(list, list + 5);
+
+	CsrGraph graph(4, edges);
+	if (graph.getVertexCount() != 4 || graph.getEdgeCount() != 5) {
+		cout << "Fail on CSR size test" << endl;
+	}
+
+	// The edges of every vertex keep their order
+	if (graph.edgesEnd(0) - graph.edgesBegin(0) != 2 || graph.getTarget(graph.edgesBegin(0)) != 1
+			|| graph.getTarget(graph.edgesBegin(0) + 1) != 2 || graph.edgesBegin(1) != graph.edgesEnd(1)
+			|| graph.edgesEnd(2) - graph.edgesBegin(2) != 3 || graph.getWeight(graph.edgesBegin(2)) != 5
+			|| graph.getWeight(graph.edgesBegin(2) + 2) != 0 || graph.edgesBegin(3) != graph.edgesEnd(3)) {
+		cout << "Fail on CSR order test" << endl;
+	}
+
+	GraphEdge badEdges[][1] = {{{0, 4, 1}}, {{-1, 0, 1}}, {{0, 1, -1}}};
+	for (int i = 0; i < 3; i++) {
+		bool thrown = false;
+		try {
+			CsrGraph badGraph(4, vector<GraphEdge>(badEdges[i], badEdges[i] + 1));
+		} catch (std::exception&) {
+			thrown = true;
+		}
+
+		if (!thrown) {
+			cout << "Fail on CSR bad edge test" << endl;
+		}
+	}
+}
+
+// Runs queries from several sources on one search and checks the
+// distances against Bellman-Ford, and the parents and paths against the
+// distances
+void testAgainstBellmanFord(const char* name, const CsrGraph& graph) {
+	DijkstraSearch search(graph);
+
+	for (int i = 0; i < SOURCES; i++) {
+		int source = rand() % graph.getVertexCount();
+		search.run(source);
+		vector<long long> expected = bellmanFord(graph, source);
+
+		size_t reachedCount = 0;
+		for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+			if (search.getDistance(vertex) != expected[vertex]) {
+				cout << "Fail on " << name << " distance test" << endl;
+				return;
+			}
+
+			if (!search.isReached(vertex)) {
+				if (search.getParent(vertex) != -1) {
+					cout << "Fail on " << name << " parent test" << endl;
+					return;
+				}
+				continue;
+			}
+			reachedCount++;
+
+			int parent = search.getParent(vertex);
+			if (vertex == source ? parent != -1 : parent == -1
+					|| !hasEdge(graph, parent, vertex, search.getDistance(vertex) - search.getDistance(parent))) {
+				cout << "Fail on " << name << " parent test" << endl;
+				return;
+			}
+		}
+
+		if (search.getReachedVertices().size() != reachedCount || search.getReachedVertices()[0] != source) {
+			cout << "Fail on " << name << " reached vertices test" << endl;
+			return;
+		}
+
+		int target = rand() % graph.getVertexCount();
+		vector<int> path;
+		search.getPath(target, path);
+		if (search.isReached(target) ? path.front() != source || path.back() != target : !path.empty()) {
+			cout << "Fail on " << name << " path test" << endl;
+			return;
+		}
+	}
+}
+
+void testUnreachable() {
+	vector<GraphEdge> edges;
+	GraphEdge list[] = {{0, 1, 4}, {1, 0, 4}, {2, 3, 1}};
+	edges.assign(list, list + 3);
+	CsrGraph graph(4, edges);
+	DijkstraSearch search(graph);
+
+	search.run(0);
+	search.run(2);
+	if (search.isReached(0) || search.isReached(1) || search.getDistance(3) != 1 || search.getParent(1) != -1) {
+		cout << "Fail on unreachable test" << endl;
+	}
+
+	vector<int> path;
+	search.getPath(1, path);
+	if (!path.empty()) {
+		cout << "Fail on unreachable test" << endl;
+	}
+}
+
+void testDeltaStepping(const char* name, const CsrGraph& graph) {
+	const long long DELTAS[] = {1, 50, 1000000000};
+	const unsigned THREADS[] = {1, 2, 4, 8};
+
+	for (int i = 0; i < 2; i++) {
+		int source = rand() % graph.getVertexCount();
+		vector<long long> expected = fibonacciDijkstra(graph, source);
+
+		for (size_t j = 0; j < sizeof(DELTAS)/sizeof(DELTAS[0]); j++) {
+			for (size_t k = 0; k < sizeof(THREADS)/sizeof(THREADS[0]); k++) {
+				DeltaSteppingSearch search(graph, DELTAS[j], THREADS[k]);
+
+				// A second run must not see the first one
+				search.run((source + 1) % graph.getVertexCount());
+				search.run(source);
+				for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+					if (search.getDistance(vertex) != expected[vertex]) {
+						cout << "Fail on " << name << " delta-stepping test, delta " << DELTAS[j] << ", "
+							<< THREADS[k] << " threads" << endl;
+						return;
+					}
+				}
+			}
+		}
+	}
+}
+
+// Weights far above delta: the bucket arrays must stay bounded, with the
+// distances out of their reach kept aside until the search gets near them
+void testDeltaSteppingLargeWeights() {
+	vector<GraphEdge> single(1);
+	single[0].source = 0;
+	single[0].dest = 1;
+	single[0].weight = 2000000000;
+	CsrGraph pair(2, single);
+
+	for (long long delta = 1; delta <= 2; delta++) {
+		DeltaSteppingSearch search(pair, delta, 2);
+		search.run(0);
+		if (search.getDistance(1) != 2000000000) {
+			cout << "Fail on large weight delta-stepping test, delta " << delta << endl;
+		}
+	}
+
+	CsrGraph graph(2000, generateRandomGraph(2000, 8000, 1000000000, 12));
+	const long long DELTAS[] = {1000, 100000, 10000000};
+	for (int i = 0; i < 2; i++) {
+		int source = rand() % graph.getVertexCount();
+		vector<long long> expected = fibonacciDijkstra(graph, source);
+
+		for (size_t j = 0; j < sizeof(DELTAS)/sizeof(DELTAS[0]); j++) {
+			DeltaSteppingSearch search(graph, DELTAS[j], 4);
+			search.run(source);
+
+			for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+				if (search.getDistance(vertex) != expected[vertex]) {
+					cout << "Fail on large weights delta-stepping test, delta " << DELTAS[j] << endl;
+					return;
+				}
+			}
+		}
+	}
+}
+
+bool isSameGraph(const CsrGraph& first, const CsrGraph& second) {
+	if (first.getVertexCount() != second.getVertexCount() || first.getEdgeCount() != second.getEdgeCount()) {
+		return false;
+	}
+
+	for (int vertex = 0; vertex <= first.getVertexCount(); vertex++) {
+		if (vertex < first.getVertexCount() && first.edgesEnd(vertex) != second.edgesEnd(vertex)) {
+			return false;
+		}
+	}
+	for (size_t edge = 0; edge < first.getEdgeCount(); edge++) {
+		if (first.getTarget(edge) != second.getTarget(edge) || first.getWeight(edge) != second.getWeight(edge)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void writeText(const char* path, const string& text) {
+	ofstream file(path, ios::binary | ios::trunc);
+	file << text;
+}
+
+void testGraphFile() {
+	CsrGraph graph(3000, generateRoadGraph(50, 60, 9));
+	graph.writeFile(GRAPH_PATH);
+
+	{
+		CsrGraph loaded(GRAPH_PATH);
+		if (!isSameGraph(graph, loaded)) {
+			cout << "Fail on graph file test" << endl;
+		}
+
+		DijkstraSearch search(graph);
+		DijkstraSearch loadedSearch(loaded);
+		search.run(7);
+		loadedSearch.run(7);
+		for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+			if (search.getDistance(vertex) != loadedSearch.getDistance(vertex)) {
+				cout << "Fail on graph file search test" << endl;
+				break;
+			}
+		}
+
+		// A swapped in mapping stays valid
+		CsrGraph swapped;
+		swapped.swap(loaded);
+		if (!isSameGraph(graph, swapped) || loaded.getVertexCount() != 0) {
+			cout << "Fail on graph file swap test" << endl;
+		}
+	}
+
+	CsrGraph empty;
+	empty.writeFile(GRAPH_PATH);
+	CsrGraph loadedEmpty(GRAPH_PATH);
+	if (loadedEmpty.getVertexCount() != 0 || loadedEmpty.getEdgeCount() != 0) {
+		cout << "Fail on empty graph file test" << endl;
+	}
+
+	graph.writeFile(GRAPH_PATH);
+	ifstream file(GRAPH_PATH, ios::binary);
+	string valid((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+	file.close();
+
+	string badMagic = valid;
+	badMagic[0] = 'X';
+	// An edge count 2^61 too large, so the array sizes it implies wrap
+	// around to the real size of the file
+	string wrappedEdgeCount = valid;
+	unsigned long long edgeCount = graph.getEdgeCount() + (1ULL << 61);
+	memcpy(&wrappedEdgeCount[offsetof(CsrGraphHeader, edgeCount)], &edgeCount, sizeof(edgeCount));
+	memcpy(&wrappedEdgeCount[sizeof(CsrGraphHeader) + graph.getVertexCount() * sizeof(edgeCount)], &edgeCount,
+		sizeof(edgeCount));
+	string badFiles[] = {"", valid.substr(0, 20), valid.substr(0, valid.size() - 4), badMagic, wrappedEdgeCount};
+	for (int i = 0; i < 5; i++) {
+		writeText(GRAPH_PATH, badFiles[i]);
+
+		bool thrown = false;
+		try {
+			CsrGraph badGraph(GRAPH_PATH);
+		} catch (std::exception&) {
+			thrown = true;
+		}
+
+		if (!thrown) {
+			cout << "Fail on bad graph file test " << i << endl;
+		}
+	}
+
+	remove(GRAPH_PATH);
+}
+
+void testEdgeListReader() {
+	vector<GraphEdge> generated = generateRandomGraph(500, 3000, 1000, 10);
+	string text = "# source dest weight\n\n";
+	for (size_t i = 0; i < generated.size(); i++) {
+		text += to_string(generated[i].source + 1) + (i % 3 == 0 ? "\t" : " ") + to_string(generated[i].dest + 1)
+			+ "  " + to_string(generated[i].weight) + (i % 5 == 0 ? "\r\n" : "\n");
+	}
+	text += "500 1 0";
+	writeText(EDGE_LIST_PATH, text);
+
+	const unsigned THREADS[] = {1, 2, 3, 8};
+	for (size_t i = 0; i < sizeof(THREADS)/sizeof(THREADS[0]); i++) {
+		int vertexCount;
+		vector<GraphEdge> edges = readEdgeListFile(EDGE_LIST_PATH, false, vertexCount, THREADS[i]);
+		vector<GraphEdge> undirectedEdges = readEdgeListFile(EDGE_LIST_PATH, true, vertexCount, THREADS[i]);
+
+		if (edges.size() != generated.size() + 1 || undirectedEdges.size() != 2 * edges.size() || vertexCount != 500) {
+			cout << "Fail on edge list size test, " << THREADS[i] << " threads" << endl;
+			continue;
+		}
+
+		for (size_t j = 0; j < generated.size(); j++) {
+			if (edges[j].source != generated[j].source || edges[j].dest != generated[j].dest
+					|| edges[j].weight != generated[j].weight || undirectedEdges[2 * j + 1].source != generated[j].dest
+					|| undirectedEdges[2 * j + 1].dest != generated[j].source) {
+				cout << "Fail on edge list order test, " << THREADS[i] << " threads" << endl;
+				break;
+			}
+		}
+	}
+
+	const char* badLists[] = {"1 2\n", "1 2 3 4\n", "0 1 2\n", "1 -2 3\n", "1 2 99999999999\n", "1 2 3x\n"};
+	for (int i = 0; i < 6; i++) {
+		writeText(EDGE_LIST_PATH, string("1 2 3\n") + badLists[i] + "2 3 4\n");
+
+		bool thrown = false;
+		try {
+			int vertexCount;
+			readEdgeListFile(EDGE_LIST_PATH, false, vertexCount, 2);
+		} catch (std::exception&) {
+			thrown = true;
+		}
+
+		if (!thrown) {
+			cout << "Fail on bad edge list test " << i << endl;
+		}
+	}
+
+	// Vertices past the last one with an edge exist only through the
+	// "# vertices" line, wherever in the file it is
+	const char* countedLists[] = {"# vertices 10\n1 2 3\n2 3 4\n", "1 2 3\n2 3 4\n#  comment\n# vertices  10 \r\n"};
+	for (int i = 0; i < 2; i++) {
+		writeText(EDGE_LIST_PATH, countedLists[i]);
+
+		for (size_t j = 0; j < sizeof(THREADS)/sizeof(THREADS[0]); j++) {
+			int vertexCount;
+			vector<GraphEdge> edges = readEdgeListFile(EDGE_LIST_PATH, false, vertexCount, THREADS[j]);
+			if (vertexCount != 10 || edges.size() != 2) {
+				cout << "Fail on edge list vertex count test " << i << ", " << THREADS[j] << " threads" << endl;
+			}
+		}
+	}
+
+	const char* badCounts[] = {"# vertices 2\n1 3 1\n", "# vertices 3\n1 2 1\n# vertices 4\n", "# vertices x\n1 2 1\n"};
+	for (int i = 0; i < 3; i++) {
+		writeText(EDGE_LIST_PATH, badCounts[i]);
+
+		for (size_t j = 0; j < sizeof(THREADS)/sizeof(THREADS[0]); j++) {
+			bool thrown = false;
+			try {
+				int vertexCount;
+				readEdgeListFile(EDGE_LIST_PATH, false, vertexCount, THREADS[j]);
+			} catch (std::exception&) {
+				thrown = true;
+			}
+
+			if (!thrown) {
+				cout << "Fail on bad edge list vertex count test " << i << ", " << THREADS[j] << " threads" << endl;
+			}
+		}
+	}
+
+	remove(EDGE_LIST_PATH);
+}
+
+void testReversed() {
+	CsrGraph graph(1000, generateRandomGraph(1000, 5000, 100, 11));
+	CsrGraph reversed;
+	graph.getReversed(reversed);
+
+	if (reversed.getVertexCount() != graph.getVertexCount() || reversed.getEdgeCount() != graph.getEdgeCount()) {
+		cout << "Fail on reversed size test" << endl;
+		return;
+	}
+
+	for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+		for (size_t edge = graph.edgesBegin(vertex); edge < graph.edgesEnd(vertex); edge++) {
+			if (!hasEdge(reversed, graph.getTarget(edge), vertex, graph.getWeight(edge))) {
+				cout << "Fail on reversed edge test" << endl;
+				return;
+			}
+		}
+	}
+}
+
+// Whether path is a path from source to target of length distance
+bool isPath(const CsrGraph& graph, const vector<int>& path, int source, int target, long long distance) {
+	if (path.empty() || path.front() != source || path.back() != target) {
+		return false;
+	}
+
+	long long length = 0;
+	for (size_t i = 0; i + 1 < path.size(); i++) {
+		long long shortest = UNREACHABLE_DISTANCE;
+		for (size_t edge = graph.edgesBegin(path[i]); edge < graph.edgesEnd(path[i]); edge++) {
+			if (graph.getTarget(edge) == path[i + 1] && graph.getWeight(edge) < shortest) {
+				shortest = graph.getWeight(edge);
+			}
+		}
+
+		if (shortest == UNREACHABLE_DISTANCE) {
+			return false;
+		}
+		length += shortest;
+	}
+
+	return length == distance;
+}
+
+void testPointToPoint(const char* name, const CsrGraph& graph) {
+	CsrGraph reversed;
+	graph.getReversed(reversed);
+	LandmarkHeuristic landmarks(graph, reversed, 4);
+	LandmarkHeuristic noLandmarks(graph, reversed, 0);
+	PointToPointSearch search(graph, reversed);
+	DijkstraSearch full(graph);
+	vector<int> path;
+
+	for (int i = 0; i < 10; i++) {
+		int source = rand() % graph.getVertexCount();
+		full.run(source);
+
+		for (int j = 0; j < 10; j++) {
+			int target = j == 0 ? source : rand() % graph.getVertexCount();
+			long long expected = full.getDistance(target);
+
+			if (landmarks(source, target) > expected) {
+				cout << "Fail on " << name << " landmark bound test" << endl;
+				return;
+			}
+			if (noLandmarks(source, target) != 0) {
+				cout << "Fail on " << name << " no landmarks test" << endl;
+				return;
+			}
+
+			for (int algorithm = 0; algorithm < 4; algorithm++) {
+				long long distance;
+				switch (algorithm) {
+				case 0:
+					distance = search.dijkstra(source, target);
+					break;
+				case 1:
+					distance = search.bidirectional(source, target);
+					break;
+				case 2:
+					distance = search.aStar(source, target, landmarks);
+					break;
+				default:
+					distance = search.aStar(source, target, ZeroHeuristic());
+					break;
+				}
+
+				search.getPath(path);
+				if (distance != expected || (expected == UNREACHABLE_DISTANCE ? !path.empty()
+						: !isPath(graph, path, source, target, expected))) {
+					cout << "Fail on " << name << " point to point test, algorithm " << algorithm << endl;
+					return;
+				}
+			}
+		}
+	}
+}
+
+void testQueryEngine() {
+	CsrGraph graph(40 * 50, generateRoadGraph(40, 50, 12));
+	CsrGraph reversed;
+	graph.getReversed(reversed);
+	LandmarkHeuristic landmarks(graph, reversed, 4);
+
+	vector<QueryEngine<LandmarkHeuristic>::Query> queries;
+	vector<long long> expected;
+	PointToPointSearch search(graph, reversed);
+	for (int i = 0; i < 300; i++) {
+		QueryEngine<LandmarkHeuristic>::Query query = { rand() % graph.getVertexCount(), rand() % graph.getVertexCount() };
+		queries.push_back(query);
+		expected.push_back(search.dijkstra(query.source, query.target));
+	}
+
+	const unsigned THREADS[] = {1, 3};
+	for (size_t i = 0; i < sizeof(THREADS)/sizeof(THREADS[0]); i++) {
+		QueryEngine<LandmarkHeuristic> engine(graph, reversed, landmarks, THREADS[i]);
+		vector<long long> results;
+
+		for (int round = 0; round < 2; round++) {
+			engine.run(queries, results, QueryEngine<LandmarkHeuristic>::DIJKSTRA);
+			if (results != expected) {
+				cout << "Fail on query engine Dijkstra test, " << THREADS[i] << " threads" << endl;
+			}
+			engine.run(queries, results, QueryEngine<LandmarkHeuristic>::BIDIRECTIONAL);
+			if (results != expected) {
+				cout << "Fail on query engine bidirectional test, " << THREADS[i] << " threads" << endl;
+			}
+			engine.run(queries, results, QueryEngine<LandmarkHeuristic>::A_STAR);
+			if (results != expected) {
+				cout << "Fail on query engine A* test, " << THREADS[i] << " threads" << endl;
+			}
+		}
+	}
+
+	QueryEngine<> engine(graph, reversed);
+	vector<long long> results;
+	engine.run(vector<QueryEngine<>::Query>(), results, QueryEngine<>::A_STAR);
+	if (!results.empty()) {
+		cout << "Fail on query engine empty batch test" << endl;
+	}
+}
+
+int main() {
+	testCsrGraph();
+	testAgainstBellmanFord("random graph", CsrGraph(2000, generateRandomGraph(2000, 6000, 100, 1)));
+	testAgainstBellmanFord("sparse random graph", CsrGraph(2000, generateRandomGraph(2000, 1500, 100, 2)));
+	testAgainstBellmanFord("grid graph", CsrGraph(40 * 50, generateGridGraph(40, 50, 100, 3)));
+	testAgainstBellmanFord("road graph", CsrGraph(40 * 50, generateRoadGraph(40, 50, 4)));
+	testUnreachable();
+
+	testDeltaStepping("random graph", CsrGraph(2000, generateRandomGraph(2000, 6000, 100, 5)));
+	testDeltaStepping("sparse random graph", CsrGraph(2000, generateRandomGraph(2000, 1500, 100, 6)));
+	testDeltaStepping("grid graph", CsrGraph(40 * 50, generateGridGraph(40, 50, 100, 7)));
+	testDeltaStepping("road graph", CsrGraph(40 * 50, generateRoadGraph(40, 50, 8)));
+	testDeltaSteppingLargeWeights();
+
+	testGraphFile();
+	testEdgeListReader();
+
+	testReversed();
+	testPointToPoint("random graph", CsrGraph(2000, generateRandomGraph(2000, 6000, 100, 13)));
+	testPointToPoint("sparse random graph", CsrGraph(2000, generateRandomGraph(2000, 1500, 100, 14)));
+	testPointToPoint("grid graph", CsrGraph(40 * 50, generateGridGraph(40, 50, 100, 15)));
+	testPointToPoint("road graph", CsrGraph(40 * 50, generateRoadGraph(40, 50, 16)));
+	testQueryEngine();
+
+	return 0;
+}
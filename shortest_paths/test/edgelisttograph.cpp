@@ -0,0 +1,41 @@
+#include "csrgraph.h"
+#include "edgelistreader.h"
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <vector>
+using namespace std;
+
+long long milliseconds(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+	return chrono::duration_cast<chrono::milliseconds>(to - from).count();
+}
+
+// Converts a text edge list to a CsrGraph file. The edges are taken both
+// ways, as uidijkstra does, unless "directed" is given.
+int main(int argc, char* argv[]) {
+	if (argc < 3 || (argc > 3 && strcmp(argv[3], "directed") != 0)) {
+		cout << "Usage: " << argv[0] << " <edge list> <graph file> [directed]" << endl;
+		return 1;
+	}
+
+	try {
+		chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+
+		int vertexCount;
+		vector<GraphEdge> edges = readEdgeListFile(argv[1], argc == 3, vertexCount);
+		chrono::steady_clock::time_point afterRead = chrono::steady_clock::now();
+
+		CsrGraph graph(vertexCount, edges);
+		graph.writeFile(argv[2]);
+		chrono::steady_clock::time_point afterWrite = chrono::steady_clock::now();
+
+		cout << vertexCount << " vertices, " << graph.getEdgeCount() << " edges; read "
+			<< milliseconds(initial, afterRead) << "ms, build and write " << milliseconds(afterRead, afterWrite) << "ms" << endl;
+	} catch (exception&) {
+		cout << "Cannot convert " << argv[1] << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,226 @@
+#include "csrgraph.h"
+#include "deltastepping.h"
+#include "dijkstra.h"
+#include "edgelistreader.h"
+#include "graphgenerator.h"
+#include "pointtopoint.h"
+#include "queryengine.h"
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Full single source queries per graph
+const int QUERIES = 10;
+
+// Point to point queries per graph
+const int POINT_QUERIES = 200;
+const int LANDMARKS = 8;
+
+const char* const GRAPH_PATH = "csrgraph-performance.graph";
+const char* const EDGE_LIST_PATH = "csrgraph-performance.txt";
+
+// Wall clock time, since clock() adds up the time of all threads
+long long milliseconds(chrono::steady_clock::time_point from, chrono::steady_clock::time_point to) {
+	return chrono::duration_cast<chrono::milliseconds>(to - from).count();
+}
+
+void testDeltaStepping(const CsrGraph& graph, const vector<int>& sources, long long delta, unsigned threads) {
+	DeltaSteppingSearch search(graph, delta, threads);
+	long long sum = 0;
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	for (int i = 0; i < QUERIES; i++) {
+		search.run(sources[i]);
+		sum += search.getDistance(sources[(i + 1) % QUERIES]) % 10;
+	}
+	chrono::steady_clock::time_point afterRuns = chrono::steady_clock::now();
+
+	cout << "delta-stepping, delta " << delta << ", " << threads << " threads "
+		<< milliseconds(initial, afterRuns) / QUERIES << "ms (" << sum % 10 << ")" << endl;
+}
+
+void testGraph(const char* name, int vertexCount, const vector<GraphEdge>& edges, long long delta) {
+	clock_t initial = clock();
+	CsrGraph graph(vertexCount, edges);
+	clock_t afterBuild = clock();
+
+	vector<int> sources;
+	for (int i = 0; i < QUERIES; i++) {
+		sources.push_back(rand() % vertexCount);
+	}
+
+	long long sum = 0;
+	DijkstraSearch search(graph);
+	for (int i = 0; i < QUERIES; i++) {
+		search.run(sources[i]);
+		sum += search.getReachedVertices().size();
+	}
+	clock_t afterReused = clock();
+
+	for (int i = 0; i < QUERIES; i++) {
+		DijkstraSearch freshSearch(graph);
+		freshSearch.run(sources[i]);
+		sum += freshSearch.getReachedVertices().size();
+	}
+	clock_t afterFresh = clock();
+
+	cout << name << ", " << vertexCount << " vertices, " << edges.size() << " edges" << endl;
+	cout << "CSR build " << (afterBuild - initial) * 1000 / CLOCKS_PER_SEC << "ms, query with reused search "
+		<< (afterReused - afterBuild) * 1000 / CLOCKS_PER_SEC / QUERIES << "ms, with fresh search "
+		<< (afterFresh - afterReused) * 1000 / CLOCKS_PER_SEC / QUERIES << "ms (" << sum % 10 << ")" << endl;
+
+	unsigned hardwareThreads = thread::hardware_concurrency();
+	testDeltaStepping(graph, sources, delta, 1);
+	if (hardwareThreads > 1) {
+		testDeltaStepping(graph, sources, delta, hardwareThreads);
+	}
+	cout << endl;
+}
+
+void testReadEdgeList(unsigned threads) {
+	int vertexCount;
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	vector<GraphEdge> edges = readEdgeListFile(EDGE_LIST_PATH, false, vertexCount, threads);
+	chrono::steady_clock::time_point afterRead = chrono::steady_clock::now();
+
+	cout << "readEdgeListFile, " << threads << " threads " << milliseconds(initial, afterRead) << "ms ("
+		<< edges.size() % 10 << ")" << endl;
+}
+
+// Loading a graph from a text edge list, with a stream and with
+// readEdgeListFile, and from a CsrGraph file
+void testFiles(int vertexCount, const vector<GraphEdge>& edges) {
+	{
+		ofstream file(EDGE_LIST_PATH);
+		for (size_t i = 0; i < edges.size(); i++) {
+			file << edges[i].source + 1 << " " << edges[i].dest + 1 << " " << edges[i].weight << "\n";
+		}
+	}
+	CsrGraph(vertexCount, edges).writeFile(GRAPH_PATH);
+
+	cout << "Files, " << vertexCount << " vertices, " << edges.size() << " edges" << endl;
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	vector<GraphEdge> streamEdges;
+	ifstream file(EDGE_LIST_PATH);
+	GraphEdge edge;
+	while (file >> edge.source >> edge.dest >> edge.weight) {
+		edge.source--;
+		edge.dest--;
+		streamEdges.push_back(edge);
+	}
+	chrono::steady_clock::time_point afterStream = chrono::steady_clock::now();
+	cout << "ifstream >>             " << milliseconds(initial, afterStream) << "ms (" << streamEdges.size() % 10 << ")" << endl;
+
+	unsigned hardwareThreads = thread::hardware_concurrency();
+	testReadEdgeList(1);
+	if (hardwareThreads > 1) {
+		testReadEdgeList(hardwareThreads);
+	}
+
+	chrono::steady_clock::time_point initialLoad = chrono::steady_clock::now();
+	CsrGraph graph(GRAPH_PATH);
+	chrono::steady_clock::time_point afterLoad = chrono::steady_clock::now();
+	DijkstraSearch search(graph);
+	search.run(0);
+	chrono::steady_clock::time_point afterQuery = chrono::steady_clock::now();
+
+	cout << "CsrGraph file load      " << milliseconds(initialLoad, afterLoad) << "ms, first query "
+		<< milliseconds(afterLoad, afterQuery) << "ms (" << search.getReachedVertices().size() % 10 << ")" << endl;
+	cout << endl;
+
+	remove(EDGE_LIST_PATH);
+	remove(GRAPH_PATH);
+}
+
+template <typename Heuristic>
+void testPointToPoint(PointToPointSearch& search, const vector<QueryEngine<LandmarkHeuristic>::Query>& queries,
+		int algorithm, const Heuristic& heuristic) {
+	const char* NAMES[] = {"Dijkstra to target    ", "bidirectional Dijkstra", "A* with landmarks     "};
+	long long sum = 0;
+	size_t settledCount = 0;
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	for (size_t i = 0; i < queries.size(); i++) {
+		if (algorithm == 0) {
+			sum += search.dijkstra(queries[i].source, queries[i].target);
+		} else if (algorithm == 1) {
+			sum += search.bidirectional(queries[i].source, queries[i].target);
+		} else {
+			sum += search.aStar(queries[i].source, queries[i].target, heuristic);
+		}
+		settledCount += search.getSettledCount();
+	}
+	chrono::steady_clock::time_point afterQueries = chrono::steady_clock::now();
+
+	long long elapsed = milliseconds(initial, afterQueries);
+	cout << NAMES[algorithm] << " " << (elapsed > 0 ? queries.size() * 1000 / elapsed : 0) << " queries/s, "
+		<< settledCount / queries.size() << " settled per query (" << sum % 10 << ")" << endl;
+}
+
+void testQueryEngine(const CsrGraph& graph, const CsrGraph& reversed, const LandmarkHeuristic& landmarks,
+		const vector<QueryEngine<LandmarkHeuristic>::Query>& queries, unsigned threads) {
+	QueryEngine<LandmarkHeuristic> engine(graph, reversed, landmarks, threads);
+	vector<long long> results;
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	engine.run(queries, results, QueryEngine<LandmarkHeuristic>::A_STAR);
+	chrono::steady_clock::time_point afterQueries = chrono::steady_clock::now();
+
+	long long elapsed = milliseconds(initial, afterQueries);
+	cout << "QueryEngine A*, " << threads << " threads " << (elapsed > 0 ? queries.size() * 1000 / elapsed : 0)
+		<< " queries/s (" << results.back() % 10 << ")" << endl;
+}
+
+// POINT_QUERIES queries between random vertices
+void testQueries(const char* name, int vertexCount, const vector<GraphEdge>& edges) {
+	CsrGraph graph(vertexCount, edges);
+	CsrGraph reversed;
+	graph.getReversed(reversed);
+
+	chrono::steady_clock::time_point initial = chrono::steady_clock::now();
+	LandmarkHeuristic landmarks(graph, reversed, LANDMARKS);
+	chrono::steady_clock::time_point afterLandmarks = chrono::steady_clock::now();
+
+	vector<QueryEngine<LandmarkHeuristic>::Query> queries;
+	for (int i = 0; i < POINT_QUERIES; i++) {
+		QueryEngine<LandmarkHeuristic>::Query query = { rand() % vertexCount, rand() % vertexCount };
+		queries.push_back(query);
+	}
+
+	cout << name << " queries, " << vertexCount << " vertices, " << edges.size() << " edges, " << LANDMARKS
+		<< " landmarks in " << milliseconds(initial, afterLandmarks) << "ms" << endl;
+
+	PointToPointSearch search(graph, reversed);
+	for (int algorithm = 0; algorithm < 3; algorithm++) {
+		testPointToPoint(search, queries, algorithm, landmarks);
+	}
+
+	unsigned hardwareThreads = thread::hardware_concurrency();
+	testQueryEngine(graph, reversed, landmarks, queries, 1);
+	if (hardwareThreads > 1) {
+		testQueryEngine(graph, reversed, landmarks, queries, hardwareThreads);
+	}
+	cout << endl;
+}
+
+int main() {
+	// Deltas around the average edge weight
+	testGraph("Random", 1000000, generateRandomGraph(1000000, 4000000, 1000, 1), 500);
+	testGraph("Grid", 1000 * 1000, generateGridGraph(1000, 1000, 1000, 2), 500);
+	testGraph("Road", 2000 * 2000, generateRoadGraph(2000, 2000, 3), 10);
+
+	testFiles(1000 * 1000, generateRoadGraph(1000, 1000, 4));
+
+	testQueries("Road", 1000 * 1000, generateRoadGraph(1000, 1000, 5));
+	testQueries("Grid", 1000 * 1000, generateGridGraph(1000, 1000, 1000, 6));
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include "csrgraph.h"
+#include "dijkstra.h"
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// Distances from source by Bellman-Ford, to check those of Dijkstra against
+vector<long long> bellmanFord(const CsrGraph& graph, int source) {
+	vector<long long> distance(graph.getVertexCount(), UNREACHABLE_DISTANCE);
+	distance[source] = 0;
+
+	for (bool changed = true; changed;) {
+		changed = false;
+
+		for (int vertex = 0; vertex < graph.getVertexCount(); vertex++) {
+			if (distance[vertex] == UNREACHABLE_DISTANCE) {
+				continue;
+			}
+
+			for (size_t edge = graph.edgesBegin(vertex); edge < graph.edgesEnd(vertex); edge++) {
+				long long newDistance = distance[vertex] + graph.getWeight(edge);
+				if (newDistance < distance[graph.getTarget(edge)]) {
+					distance[graph.getTarget(edge)] = newDistance;
+					changed = true;
+				}
+			}
+		}
+	}
+
+	return distance;
+}
+
+// Reads the graph from the CsrGraph file given as the argument, as
+// edgelisttograph writes it, or else from the input
+int main(int argc, char* argv[]) {
+	int numberOfVertices, target;
+	CsrGraph graph;
+
+	if (argc > 1) {
+		CsrGraph file(argv[1]);
+		graph.swap(file);
+		numberOfVertices = graph.getVertexCount();
+
+		cout << "Enter target: ";
+		cin >> target;
+	} else {
+		int numberOfEdges;
+
+		cout << "Enter number of vertices: ";
+		cin >> numberOfVertices;
+		cout << "Enter number of edges: ";
+		cin >> numberOfEdges;
+		cout << "Enter target: ";
+		cin >> target;
+
+		vector<GraphEdge> edges;
+
+		cout << "Enter edges:" << endl;
+		for (int i = 0; i < numberOfEdges; i++) {
+			int source, dest, weight;
+
+			cin >> source >> dest >> weight;
+
+			GraphEdge forward = { source - 1, dest - 1, weight };
+			GraphEdge backward = { dest - 1, source - 1, weight };
+			edges.push_back(forward);
+			edges.push_back(backward);
+		}
+
+		CsrGraph input(numberOfVertices, edges);
+		graph.swap(input);
+	}
+
+	DijkstraSearch search(graph);
+	search.run(0);
+
+	cout << "Distances: ";
+	for (int i = 0; i < numberOfVertices; i++) {
+		cout << (search.isReached(i) ? search.getDistance(i) : -1) << " ";
+	}
+	cout << endl;
+
+	cout << "Parents: ";
+	for (int i = 0; i < numberOfVertices; i++) {
+		cout << search.getParent(i) + 1 << " ";
+	}
+	cout << endl;
+
+	cout << "Dijkstra distance: " << (search.isReached(target - 1) ? search.getDistance(target - 1) : -1) << endl;
+
+	// Comparing against the simple Bellman-Ford algorithm
+	vector<long long> bellmanFordResult = bellmanFord(graph, 0);
+	long long bellmanFordDistance = bellmanFordResult[target - 1];
+
+	cout << "Bellman-Ford distance: " << (bellmanFordDistance != UNREACHABLE_DISTANCE ? bellmanFordDistance : -1) << endl;
+
+	return 0;
+}
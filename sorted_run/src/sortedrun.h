@@ -0,0 +1,482 @@
+#ifndef SORTEDRUN_H
+#define SORTEDRUN_H
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A sorted run is a read-only file of (key, value) entries in increasing key
+// order, meant for checkpointing an ordered index:
+//
+//   header  magic, entry count, block count, index offset, flags
+//   blocks  entries, about BLOCK_SIZE bytes per block
+//   index   offset and first key of every block
+//
+// The first entry of a block is stored whole. With prefix compression every
+// other key is stored relative to the key before it (see SortedRunCodec),
+// so a block is always decoded from its start. Integers are written in the
+// byte order of the machine that writes the file.
+
+inline void writeSortedRunVarint(std::string& out, std::size_t n) {
+	while (n >= 0x80) {
+		out += static_cast<char>(n | 0x80);
+		n >>= 7;
+	}
+	out += static_cast<char>(n);
+}
+
+inline const char* readSortedRunVarint(const char* in, std::size_t& n) {
+	n = 0;
+	for (int shift = 0; ; shift += 7) {
+		unsigned char byte = static_cast<unsigned char>(*in++);
+		n |= static_cast<std::size_t>(byte & 0x7f) << shift;
+		if (byte < 0x80) {
+			return in;
+		}
+	}
+}
+
+// How keys and values are laid out in a sorted run. Trivially copyable types
+// are copied byte for byte; other types need a specialization. writeShared
+// and readShared store a key relative to the previous key of its block.
+template <typename T>
+struct SortedRunCodec {
+	static_assert(std::is_trivially_copyable<T>::value, "SortedRunCodec needs a specialization for this type");
+
+	static void write(std::string& out, const T& value) {
+		out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	static const char* read(const char* in, T& value) {
+		std::memcpy(&value, in, sizeof(T));
+		return in + sizeof(T);
+	}
+
+	static void writeShared(std::string& out, const T& key, const T&) {
+		write(out, key);
+	}
+
+	static const char* readShared(const char* in, T& key, const T&) {
+		return read(in, key);
+	}
+};
+
+// Strings are stored as their length and bytes, and relative to the
+// previous key as the length of the prefix they share with it followed by
+// the rest
+template <>
+struct SortedRunCodec<std::string> {
+	static void write(std::string& out, const std::string& value) {
+		writeSortedRunVarint(out, value.size());
+		out += value;
+	}
+
+	static const char* read(const char* in, std::string& value) {
+		std::size_t length;
+		in = readSortedRunVarint(in, length);
+		value.assign(in, length);
+
+		return in + length;
+	}
+
+	static void writeShared(std::string& out, const std::string& key, const std::string& previous) {
+		std::size_t shared = 0;
+		while (shared < key.size() && shared < previous.size() && key[shared] == previous[shared]) {
+			shared++;
+		}
+
+		writeSortedRunVarint(out, shared);
+		writeSortedRunVarint(out, key.size() - shared);
+		out.append(key, shared, std::string::npos);
+	}
+
+	static const char* readShared(const char* in, std::string& key, const std::string& previous) {
+		std::size_t shared;
+		std::size_t length;
+		in = readSortedRunVarint(in, shared);
+		in = readSortedRunVarint(in, length);
+		key.assign(previous, 0, shared);
+		key.append(in, length);
+
+		return in + length;
+	}
+};
+
+struct SortedRunHeader {
+	char magic[8];
+	unsigned long long entryCount;
+	unsigned long long blockCount;
+	unsigned long long indexOffset;
+	unsigned long long flags;
+
+	static const unsigned long long PREFIX_COMPRESSION = 1;
+
+	static const char* expectedMagic() {
+		return "SORTRUN1";
+	}
+};
+
+// Writes a sorted run. Entries must be added in strictly increasing key
+// order, and the file is only complete once finish has been called.
+template <typename Key, typename Value>
+class SortedRunWriter {
+	std::ofstream file;
+	std::string block;
+	std::string index;
+	Key previousKey;
+	SortedRunHeader header;
+	unsigned long long offset;
+	bool compressPrefixes;
+
+	SortedRunWriter(const SortedRunWriter&);
+	SortedRunWriter& operator=(const SortedRunWriter&);
+
+	void flushBlock() {
+		file.write(block.data(), block.size());
+		offset += block.size();
+		block.clear();
+	}
+
+public:
+	// A block is closed as soon as it holds at least this many bytes
+	static const std::size_t BLOCK_SIZE = 1024;
+
+	// Passes every entry a tree's forEach visits to the writer
+	struct Adder {
+		SortedRunWriter* writer;
+
+		void operator()(const Key& key, const Value& value) const {
+			writer->add(key, value);
+		}
+	};
+
+	explicit SortedRunWriter(const char* path, bool compressPrefixes = true)
+		: file(path, std::ios::binary | std::ios::trunc), previousKey(), offset(sizeof(SortedRunHeader)), compressPrefixes(compressPrefixes) {
+			if (!file) {
+				throw std::exception();
+			}
+
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, SortedRunHeader::expectedMagic(), sizeof(header.magic));
+			header.flags = compressPrefixes ? SortedRunHeader::PREFIX_COMPRESSION : 0;
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	void add(const Key& key, const Value& value) {
+		if (header.entryCount != 0 && !(previousKey < key)) {
+			throw std::exception();
+		}
+
+		if (header.entryCount == 0 || block.size() >= BLOCK_SIZE) {
+			if (!block.empty()) {
+				flushBlock();
+			}
+
+			index.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+			SortedRunCodec<Key>::write(index, key);
+			SortedRunCodec<Key>::write(block, key);
+			header.blockCount++;
+		} else if (compressPrefixes) {
+			SortedRunCodec<Key>::writeShared(block, key, previousKey);
+		} else {
+			SortedRunCodec<Key>::write(block, key);
+		}
+		SortedRunCodec<Value>::write(block, value);
+
+		previousKey = key;
+		header.entryCount++;
+	}
+
+	Adder adder() {
+		Adder result;
+		result.writer = this;
+
+		return result;
+	}
+
+	void finish() {
+		flushBlock();
+		header.indexOffset = offset;
+		file.write(index.data(), index.size());
+
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.close();
+
+		if (!file) {
+			throw std::exception();
+		}
+	}
+};
+
+// A sorted run mapped into memory. Lookups binary search the block index,
+// which is the only part kept decoded, and then decode a single block
+// straight from the mapping. The file is trusted to be one written by
+// SortedRunWriter for the same Key and Value types.
+template <typename Key, typename Value>
+class SortedRun {
+	const char* data;
+	std::size_t size;
+	SortedRunHeader header;
+	std::vector<Key> firstKeys;
+	// blockOffsets[i] is where block i starts and blockOffsets[i + 1] where it ends
+	std::vector<std::size_t> blockOffsets;
+
+	SortedRun(const SortedRun&);
+	SortedRun& operator=(const SortedRun&);
+
+	void readIndex() {
+		if (size < sizeof(header)) {
+			throw std::exception();
+		}
+
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.magic, SortedRunHeader::expectedMagic(), sizeof(header.magic)) != 0 ||
+			header.indexOffset < sizeof(header) || header.indexOffset > size) {
+			throw std::exception();
+		}
+
+		const char* position = data + header.indexOffset;
+		firstKeys.resize(header.blockCount);
+		blockOffsets.resize(header.blockCount + 1);
+		for (std::size_t i = 0; i < header.blockCount; i++) {
+			unsigned long long offset;
+			std::memcpy(&offset, position, sizeof(offset));
+			position = SortedRunCodec<Key>::read(position + sizeof(offset), firstKeys[i]);
+
+			if (offset < (i == 0 ? sizeof(header) : blockOffsets[i - 1] + 1) || offset >= header.indexOffset) {
+				throw std::exception();
+			}
+			blockOffsets[i] = offset;
+		}
+		blockOffsets[header.blockCount] = header.indexOffset;
+	}
+
+	// The block that would hold key, or -1 if key is less than every key
+	long findBlock(const Key& key) const {
+		std::size_t low = 0;
+		std::size_t high = firstKeys.size();
+
+		while (low < high) {
+			std::size_t middle = low + (high - low) / 2;
+			if (key < firstKeys[middle]) {
+				high = middle;
+			} else {
+				low = middle + 1;
+			}
+		}
+
+		return static_cast<long>(low) - 1;
+	}
+
+	// Calls visitor(key, value) for the entries from the start of block
+	// onwards until it returns false
+	template <typename Visitor>
+	void scan(std::size_t block, Visitor& visitor) const {
+		Key key;
+		Key nextKey;
+		Value value;
+		bool isShared = (header.flags & SortedRunHeader::PREFIX_COMPRESSION) != 0;
+
+		for (; block < header.blockCount; block++) {
+			const char* position = data + blockOffsets[block];
+			const char* end = data + blockOffsets[block + 1];
+
+			position = SortedRunCodec<Key>::read(position, key);
+			position = SortedRunCodec<Value>::read(position, value);
+			while (true) {
+				if (!visitor(key, value)) {
+					return;
+				}
+				if (position == end) {
+					break;
+				}
+
+				if (isShared) {
+					position = SortedRunCodec<Key>::readShared(position, nextKey, key);
+				} else {
+					position = SortedRunCodec<Key>::read(position, nextKey);
+				}
+				position = SortedRunCodec<Value>::read(position, value);
+				std::swap(key, nextKey);
+			}
+		}
+	}
+
+public:
+	explicit SortedRun(const char* path)
+		: data(0), size(0) {
+			int descriptor = open(path, O_RDONLY);
+			if (descriptor < 0) {
+				throw std::exception();
+			}
+
+			struct stat status;
+			if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+				close(descriptor);
+				throw std::exception();
+			}
+			size = status.st_size;
+
+			void* mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			close(descriptor);
+			if (mapping == MAP_FAILED) {
+				throw std::exception();
+			}
+			data = static_cast<const char*>(mapping);
+
+			try {
+				readIndex();
+			} catch (...) {
+				munmap(const_cast<char*>(data), size);
+				throw;
+			}
+	}
+
+	~SortedRun() {
+		munmap(const_cast<char*>(data), size);
+	}
+
+	bool isEmpty() const {
+		return header.entryCount == 0;
+	}
+
+	std::size_t getSize() const {
+		return header.entryCount;
+	}
+
+	Value get(const Key& key) const {
+		Value value;
+
+		if (!find(key, value)) {
+			throw std::exception();
+		}
+
+		return value;
+	}
+
+	bool contains(const Key& key) const {
+		Value value;
+
+		return find(key, value);
+	}
+
+	// Stores the value for key in value and returns true, or returns false if
+	// key is absent. Decodes at most one block.
+	bool find(const Key& key, Value& value) const {
+		long block = findBlock(key);
+		bool found = false;
+
+		if (block >= 0) {
+			auto visitor = [&](const Key& entryKey, const Value& entryValue) {
+				if (entryKey < key) {
+					return true;
+				}
+
+				if (!(key < entryKey)) {
+					value = entryValue;
+					found = true;
+				}
+				return false;
+			};
+			scan(block, visitor);
+		}
+
+		return found;
+	}
+
+	// Finds the first entry whose key is not less than key. Returns false if
+	// there is none.
+	bool lowerBound(const Key& key, Key& resultKey, Value& resultValue) const {
+		long block = findBlock(key);
+		bool found = false;
+
+		auto visitor = [&](const Key& entryKey, const Value& entryValue) {
+			if (entryKey < key) {
+				return true;
+			}
+
+			resultKey = entryKey;
+			resultValue = entryValue;
+			found = true;
+			return false;
+		};
+		scan(block < 0 ? 0 : block, visitor);
+
+		return found;
+	}
+
+	// Calls visitor(key, value) for every entry with low <= key <= high in
+	// increasing key order
+	template <typename Visitor>
+	void forEachInRange(const Key& low, const Key& high, Visitor visitor) const {
+		long block = findBlock(low);
+
+		auto rangeVisitor = [&](const Key& entryKey, const Value& entryValue) {
+			if (entryKey < low) {
+				return true;
+			}
+			if (high < entryKey) {
+				return false;
+			}
+
+			visitor(entryKey, entryValue);
+			return true;
+		};
+		scan(block < 0 ? 0 : block, rangeVisitor);
+	}
+
+	// Calls visitor(key, value) for every entry in increasing key order
+	template <typename Visitor>
+	void forEach(Visitor visitor) const {
+		auto allVisitor = [&](const Key& entryKey, const Value& entryValue) {
+			visitor(entryKey, entryValue);
+			return true;
+		};
+		scan(0, allVisitor);
+	}
+
+	// Appends every entry to entries in increasing key order, ready for a
+	// tree's buildFromSorted
+	void readAll(std::vector<std::pair<Key, Value> >& entries) const {
+		entries.reserve(entries.size() + header.entryCount);
+
+		auto allVisitor = [&](const Key& entryKey, const Value& entryValue) {
+			entries.push_back(std::make_pair(entryKey, entryValue));
+			return true;
+		};
+		scan(0, allVisitor);
+	}
+};
+
+// Writes the contents of tree to path as a sorted run in O(n). Tree is a
+// tree with the forEach of RedBlackTree and AATree, whose Compare orders
+// keys like operator<.
+template <typename Tree>
+void writeSortedRun(const Tree& tree, const char* path, bool compressPrefixes = true) {
+	SortedRunWriter<typename Tree::KeyType, typename Tree::ValueType> writer(path, compressPrefixes);
+	tree.forEach(writer.adder());
+	writer.finish();
+}
+
+// Replaces the contents of tree with those of the sorted run at path in
+// O(n), with buildFromSortedParallel on up to threads threads
+template <typename Tree>
+void loadSortedRun(Tree& tree, const char* path, unsigned threads = std::thread::hardware_concurrency()) {
+	std::vector<std::pair<typename Tree::KeyType, typename Tree::ValueType> > entries;
+	SortedRun<typename Tree::KeyType, typename Tree::ValueType>(path).readAll(entries);
+	tree.buildFromSortedParallel(entries.begin(), entries.end(), threads);
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include "sortedrun.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+using namespace std;
+
+const char* const RUN_PATH = "sortedrun-test.run";
+const size_t RANGE_TESTS = 200;
+
+map<int, int> uniqueInts;
+map<string, string> uniqueStrings;
+
+template <typename Key, typename Value>
+void writeRun(const map<Key, Value>& entries, bool compressPrefixes) {
+	SortedRunWriter<Key, Value> writer(RUN_PATH, compressPrefixes);
+
+	for (typename map<Key, Value>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+		writer.add(i->first, i->second);
+	}
+	writer.finish();
+}
+
+template <typename Key, typename Value>
+struct RangeCollector {
+	vector<pair<Key, Value> >* entries;
+
+	void operator()(const Key& key, const Value& value) {
+		entries->push_back(make_pair(key, value));
+	}
+};
+
+template <typename Key, typename Value>
+void testLookups(const map<Key, Value>& expected, const vector<Key>& probes, const char* name) {
+	SortedRun<Key, Value> run(RUN_PATH);
+
+	if (run.getSize() != expected.size()) {
+		cout << "Fail on " << name << " size" << endl;
+	}
+
+	for (size_t i = 0; i < probes.size(); i++) {
+		const Key& key = probes[i];
+		typename map<Key, Value>::const_iterator entry = expected.find(key);
+
+		if (run.contains(key) != (entry != expected.end()) || (entry != expected.end() && run.get(key) != entry->second)) {
+			cout << "Fail on " << name << " get test with key " << key << endl;
+		}
+
+		Key foundKey;
+		Value foundValue;
+		typename map<Key, Value>::const_iterator bound = expected.lower_bound(key);
+		bool found = run.lowerBound(key, foundKey, foundValue);
+		if (found != (bound != expected.end()) || (found && (foundKey != bound->first || foundValue != bound->second))) {
+			cout << "Fail on " << name << " lowerBound test with key " << key << endl;
+		}
+	}
+
+	for (size_t i = 0; i + 1 < probes.size() && i < RANGE_TESTS * 2; i += 2) {
+		Key low = min(probes[i], probes[i + 1]);
+		Key high = max(probes[i], probes[i + 1]);
+		vector<pair<Key, Value> > entries;
+		RangeCollector<Key, Value> collector = { &entries };
+		run.forEachInRange(low, high, collector);
+
+		vector<pair<Key, Value> > expectedEntries(expected.lower_bound(low), expected.upper_bound(high));
+		if (entries != expectedEntries) {
+			cout << "Fail on " << name << " range test from " << low << " to " << high << endl;
+		}
+	}
+
+	vector<pair<Key, Value> > all;
+	run.readAll(all);
+	if (all != vector<pair<Key, Value> >(expected.begin(), expected.end())) {
+		cout << "Fail on " << name << " readAll test" << endl;
+	}
+}
+
+void testInts() {
+	vector<int> probes;
+	for (int i = 0; i < 20000; i++) {
+		probes.push_back(rand() % 200000 - 1000);
+	}
+
+	writeRun(uniqueInts, true);
+	testLookups(uniqueInts, probes, "int");
+}
+
+void testStrings() {
+	vector<string> probes;
+	for (map<string, string>::const_iterator i = uniqueStrings.begin(); i != uniqueStrings.end(); ++i) {
+		probes.push_back(i->first);
+		probes.push_back(i->first + "a");
+		probes.push_back(i->first.substr(0, i->first.size() / 2));
+	}
+
+	writeRun(uniqueStrings, true);
+	testLookups(uniqueStrings, probes, "compressed string");
+
+	writeRun(uniqueStrings, false);
+	testLookups(uniqueStrings, probes, "string");
+}
+
+void testEmpty() {
+	map<int, int> empty;
+	writeRun(empty, true);
+
+	SortedRun<int, int> run(RUN_PATH);
+	int key;
+	int value;
+	if (!run.isEmpty() || run.contains(0) || run.lowerBound(0, key, value)) {
+		cout << "testEmpty failed\n";
+	}
+}
+
+void testUnsortedAdd() {
+	SortedRunWriter<int, int> writer(RUN_PATH);
+	writer.add(2, 0);
+
+	try {
+		writer.add(2, 0);
+		cout << "testUnsortedAdd failed\n";
+	} catch (std::exception&) {
+	}
+}
+
+template <typename Tree>
+void testTree(const char* name) {
+	Tree tree;
+	for (map<string, string>::const_iterator i = uniqueStrings.begin(); i != uniqueStrings.end(); ++i) {
+		tree.put(i->first, i->second);
+	}
+	writeSortedRun(tree, RUN_PATH);
+
+	Tree loaded;
+	loaded.put("stale", "entry");
+	loadSortedRun(loaded, RUN_PATH, 2);
+
+	if (loaded.contains("stale")) {
+		cout << "Fail on " << name << " load test: old contents kept" << endl;
+	}
+	for (map<string, string>::const_iterator i = uniqueStrings.begin(); i != uniqueStrings.end(); ++i) {
+		if (!loaded.contains(i->first) || loaded.get(i->first) != i->second) {
+			cout << "Fail on " << name << " load test with key " << i->first << endl;
+		}
+	}
+}
+
+int main() {
+	for (int i = 0; i < 100000; i++) {
+		int key = rand() % 190000;
+		uniqueInts[key] = i;
+	}
+
+	// Keys sharing long prefixes, as URLs do
+	for (int i = 0; i < 30000; i++) {
+		string key = "https://example.com/";
+		int depth = rand() % 4;
+		for (int j = 0; j < depth; j++) {
+			key += "dir" + to_string(rand() % 20) + "/";
+		}
+		key += to_string(rand() % 1000);
+		uniqueStrings[key] = to_string(i);
+	}
+
+	testInts();
+	testStrings();
+	testEmpty();
+	testUnsortedAdd();
+	testTree<AATree<string, string> >("AATree");
+	testTree<RedBlackTree<string, string> >("RedBlackTree");
+
+	remove(RUN_PATH);
+
+	return 0;
+}
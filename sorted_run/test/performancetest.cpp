@@ -0,0 +1,96 @@
+#include "sortedrun.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000, 10000000};
+const char* const RUN_PATH = "sortedrun-performance.run";
+
+vector<int> randomKeys;
+
+long long fileSize(const char* path) {
+	FILE* file = fopen(path, "rb");
+	fseek(file, 0, SEEK_END);
+	long long size = ftell(file);
+	fclose(file);
+
+	return size;
+}
+
+// Restarting from a checkpoint: rebuilding with put from the entries in
+// key order, against loading the sorted run with the linear build
+template <typename Key>
+void testRestart(const vector<Key>& keys, size_t count) {
+	RedBlackTree<Key, int> tree;
+	for (size_t i = 0; i < count; i++) {
+		tree.put(keys[i], static_cast<int>(i));
+	}
+
+	clock_t initial = clock();
+	writeSortedRun(tree, RUN_PATH);
+	clock_t afterWrite = clock();
+
+	{
+		vector<pair<Key, int> > entries;
+		SortedRun<Key, int>(RUN_PATH).readAll(entries);
+		RedBlackTree<Key, int> rebuilt;
+		for (size_t i = 0; i < entries.size(); i++) {
+			rebuilt.put(entries[i].first, entries[i].second);
+		}
+	}
+	clock_t afterPut = clock();
+
+	{
+		RedBlackTree<Key, int> loaded;
+		loadSortedRun(loaded, RUN_PATH);
+	}
+	clock_t afterLoad = clock();
+
+	long long sum = 0;
+	{
+		SortedRun<Key, int> run(RUN_PATH);
+		for (size_t i = 0; i < count; i++) {
+			sum += run.get(keys[(i * 7919) % count]);
+		}
+	}
+	clock_t afterGet = clock();
+
+	cout << "file " << fileSize(RUN_PATH) / 1024 << "KB write " << (afterWrite - initial) * 1000 / CLOCKS_PER_SEC
+		<< "ms rebuild with put " << (afterPut - afterWrite) * 1000 / CLOCKS_PER_SEC
+		<< "ms load " << (afterLoad - afterPut) * 1000 / CLOCKS_PER_SEC
+		<< "ms get from file " << (afterGet - afterLoad) * 1000 / CLOCKS_PER_SEC << "ms (" << sum % 10 << ")" << endl;
+}
+
+int main() {
+	int maxSize = TEST_SIZES[sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]) - 1];
+
+	for (int i = 0; i < maxSize; i++) {
+		randomKeys.push_back(i);
+	}
+	random_shuffle(randomKeys.begin(), randomKeys.end());
+
+	for (size_t i = 0; i < sizeof(TEST_SIZES)/sizeof(TEST_SIZES[0]); i++) {
+		vector<string> urls;
+		for (int j = 0; j < TEST_SIZES[i]; j++) {
+			urls.push_back("https://example.com/items/" + to_string(randomKeys[j]));
+		}
+
+		cout << "Integer keys, size " << TEST_SIZES[i] << endl;
+		testRestart(randomKeys, TEST_SIZES[i]);
+		cout << endl;
+
+		cout << "URL keys, size " << TEST_SIZES[i] << endl;
+		testRestart(urls, TEST_SIZES[i]);
+		cout << endl;
+	}
+
+	remove(RUN_PATH);
+
+	return 0;
+}
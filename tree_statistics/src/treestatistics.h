@@ -0,0 +1,164 @@
+#ifndef TREESTATISTICS_H
+#define TREESTATISTICS_H
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef TREE_STATISTICS
+#include <atomic>
+#endif
+
+// Operation counter of the trees. Counting is compiled in only when
+// TREE_STATISTICS is defined; otherwise the counter is empty and adding to
+// it does nothing. Counts are atomic since const lookups and the parallel
+// set operations may update them from several threads.
+#ifdef TREE_STATISTICS
+class TreeCounter {
+	std::atomic<unsigned long long> value;
+
+public:
+	TreeCounter()
+		: value(0) {
+	}
+
+	void add(unsigned long long amount) {
+		value.fetch_add(amount, std::memory_order_relaxed);
+	}
+
+	unsigned long long get() const {
+		return value.load(std::memory_order_relaxed);
+	}
+
+	void reset() {
+		value.store(0, std::memory_order_relaxed);
+	}
+};
+#else
+class TreeCounter {
+public:
+	void add(unsigned long long) {
+	}
+
+	unsigned long long get() const {
+		return 0;
+	}
+
+	void reset() {
+	}
+};
+#endif
+
+// The counters a tree keeps. Each tree only uses the ones of its balancing
+// scheme: rotations and colorFlips for RedBlackTree, skews and splits (the
+// calls that actually restructured) for AATree.
+struct TreeCounters {
+	TreeCounter lookups;
+	TreeCounter lookupComparisons;
+	TreeCounter rotations;
+	TreeCounter colorFlips;
+	TreeCounter skews;
+	TreeCounter splits;
+
+	void reset() {
+		lookups.reset();
+		lookupComparisons.reset();
+		rotations.reset();
+		colorFlips.reset();
+		skews.reset();
+		splits.reset();
+	}
+};
+
+// Shape of a tree and the operation counts since the last reset. The
+// operation counts are all zero unless TREE_STATISTICS is defined.
+struct TreeStatistics {
+	bool countersEnabled;
+	std::size_t nodeCount;
+	// Nodes plus the tree object, without memory owned by keys and values
+	std::size_t bytesUsed;
+	// Number of levels; 0 for an empty tree
+	int height;
+	// depthHistogram[d] nodes are at depth d, the root being at depth 0
+	std::vector<std::size_t> depthHistogram;
+
+	unsigned long long lookups;
+	unsigned long long lookupComparisons;
+	unsigned long long rotations;
+	unsigned long long colorFlips;
+	unsigned long long skews;
+	unsigned long long splits;
+
+	TreeStatistics()
+		: countersEnabled(false), nodeCount(0), bytesUsed(0), height(0),
+		lookups(0), lookupComparisons(0), rotations(0), colorFlips(0), skews(0), splits(0) {
+	}
+
+	// Nodes a successful search visits, averaged over all keys
+	double averageSearchPathLength() const {
+		if (nodeCount == 0) {
+			return 0;
+		}
+
+		double total = 0;
+		for (std::size_t depth = 0; depth < depthHistogram.size(); depth++) {
+			total += static_cast<double>(depthHistogram[depth]) * (depth + 1);
+		}
+
+		return total / nodeCount;
+	}
+
+	double comparisonsPerLookup() const {
+		return lookups == 0 ? 0 : static_cast<double>(lookupComparisons) / lookups;
+	}
+
+	// Adds the node at depth to the shape
+	void addNode(int depth) {
+		if (depthHistogram.size() <= static_cast<std::size_t>(depth)) {
+			depthHistogram.resize(depth + 1);
+		}
+		depthHistogram[depth]++;
+		nodeCount++;
+		if (height < depth + 1) {
+			height = depth + 1;
+		}
+	}
+
+	void setCounters(const TreeCounters& counters) {
+#ifdef TREE_STATISTICS
+		countersEnabled = true;
+#endif
+		lookups = counters.lookups.get();
+		lookupComparisons = counters.lookupComparisons.get();
+		rotations = counters.rotations.get();
+		colorFlips = counters.colorFlips.get();
+		skews = counters.skews.get();
+		splits = counters.splits.get();
+	}
+
+	std::string toJson() const {
+		std::ostringstream json;
+
+		json << "{\"countersEnabled\": " << (countersEnabled ? "true" : "false")
+			<< ", \"nodeCount\": " << nodeCount
+			<< ", \"bytesUsed\": " << bytesUsed
+			<< ", \"height\": " << height
+			<< ", \"depthHistogram\": [";
+		for (std::size_t depth = 0; depth < depthHistogram.size(); depth++) {
+			json << (depth == 0 ? "" : ", ") << depthHistogram[depth];
+		}
+		json << "], \"averageSearchPathLength\": " << averageSearchPathLength()
+			<< ", \"lookups\": " << lookups
+			<< ", \"lookupComparisons\": " << lookupComparisons
+			<< ", \"comparisonsPerLookup\": " << comparisonsPerLookup()
+			<< ", \"rotations\": " << rotations
+			<< ", \"colorFlips\": " << colorFlips
+			<< ", \"skews\": " << skews
+			<< ", \"splits\": " << splits << "}";
+
+		return json.str();
+	}
+};
+
+#endif
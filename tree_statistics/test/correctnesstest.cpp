@@ -0,0 +1,104 @@
+#define TREE_STATISTICS
+#include "treestatistics.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+using namespace std;
+
+const int SIZE = 100000;
+
+vector<int> keys;
+
+template <typename Tree>
+void testShape(const char* name) {
+	Tree tree;
+	for (int i = 0; i < SIZE; i++) {
+		tree.put(keys[i], i);
+	}
+
+	TreeStatistics statistics = tree.statistics();
+	size_t histogramTotal = 0;
+	for (size_t depth = 0; depth < statistics.depthHistogram.size(); depth++) {
+		histogramTotal += statistics.depthHistogram[depth];
+	}
+
+	if (statistics.nodeCount != SIZE || histogramTotal != SIZE || statistics.depthHistogram[0] != 1 ||
+		static_cast<size_t>(statistics.height) != statistics.depthHistogram.size()) {
+		cout << "Fail on " << name << " shape test" << endl;
+	}
+
+	// Both schemes guarantee a height of at most 2 log2(n + 1)
+	if (statistics.height > 2 * log2(SIZE + 1.0) || statistics.height < log2(SIZE + 1.0)) {
+		cout << "Fail on " << name << " height test: " << statistics.height << endl;
+	}
+
+	if (statistics.averageSearchPathLength() < 1 || statistics.averageSearchPathLength() > statistics.height ||
+		statistics.bytesUsed < SIZE * (2 * sizeof(void*) + 2 * sizeof(int))) {
+		cout << "Fail on " << name << " size test" << endl;
+	}
+
+	if (!statistics.countersEnabled || statistics.rotations + statistics.skews + statistics.splits == 0) {
+		cout << "Fail on " << name << " rebalancing count test" << endl;
+	}
+}
+
+template <typename Tree>
+void testLookupCounts(const char* name) {
+	Tree tree;
+	for (int i = 0; i < SIZE; i++) {
+		tree.put(keys[i], i);
+	}
+	tree.resetCounters();
+
+	for (int i = 0; i < SIZE; i++) {
+		tree.contains(keys[i]);
+	}
+	vector<const int*> results(SIZE);
+	tree.findBatch(keys.begin(), keys.end(), &results[0]);
+
+	// Every visited node costs one comparison, so a successful lookup
+	// compares as often as its path is long
+	TreeStatistics statistics = tree.statistics();
+	if (statistics.lookups != 2 * SIZE || statistics.rotations + statistics.skews + statistics.splits != 0 ||
+		fabs(statistics.comparisonsPerLookup() - statistics.averageSearchPathLength()) > 1e-9) {
+		cout << "Fail on " << name << " lookup count test: " << statistics.toJson() << endl;
+	}
+}
+
+void testJson() {
+	RedBlackTree<int, int> tree;
+	tree.put(2, 0);
+	tree.put(1, 0);
+	tree.contains(1);
+
+	string json = tree.statistics().toJson();
+	if (json.find("\"nodeCount\": 2") == string::npos || json.find("\"depthHistogram\": [1, 1]") == string::npos ||
+		json.find("\"lookups\": 1") == string::npos || json.find("\"comparisonsPerLookup\": 2") == string::npos) {
+		cout << "testJson failed: " << json << endl;
+	}
+
+	if (AATree<int, int>().statistics().toJson().find("\"height\": 0") == string::npos) {
+		cout << "testJson failed on an empty tree\n";
+	}
+}
+
+int main() {
+	for (int i = 0; i < SIZE; i++) {
+		keys.push_back(i);
+	}
+	for (int i = SIZE - 1; i > 0; i--) {
+		swap(keys[i], keys[rand() % (i + 1)]);
+	}
+
+	testShape<AATree<int, int> >("AATree");
+	testShape<RedBlackTree<int, int> >("RedBlackTree");
+	testLookupCounts<AATree<int, int> >("AATree");
+	testLookupCounts<RedBlackTree<int, int> >("RedBlackTree");
+	testJson();
+
+	return 0;
+}
@@ -0,0 +1,59 @@
+#define TREE_STATISTICS
+#include "treestatistics.h"
+#include "../../aa_tree/src/aatree.h"
+#include "../../redblack_tree/src/redblacktree.h"
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+using namespace std;
+
+const int TEST_SIZES[] = {1000, 100000, 1000000};
+
+vector<int> sequentialKeys;
+vector<int> randomKeys;
+
+// Puts count keys, looks every one of them up and prints the time of each
+// phase followed by the statistics of the tree
+template <typename Tree>
+void testWorkload(const char* name, const vector<int>& keys, size_t count) {
+	Tree* tree = new Tree();
+
+	clock_t initial = clock();
+	for (size_t i = 0; i < count; i++) {
+		tree->put(keys[i], static_cast<int>(i));
+	}
+	clock_t afterPut = clock();
+
+	for (size_t i = 0; i < count; i++) {
+		tree->contains(keys[i]);
+	}
+	clock_t afterContains = clock();
+
+	cout << name << " put " << (afterPut - initial) * 1000 / CLOCKS_PER_SEC << "ms, contains "
+		<< (afterContains - afterPut) * 1000 / CLOCKS_PER_SEC << "ms" << endl;
+	cout << tree->statistics().toJson() << endl;
+
+	delete tree;
+}
+
+int main() {
+	for (int i = 0; i < TEST_SIZES[2]; i++) {
+		sequentialKeys.push_back(i);
+		randomKeys.push_back(i);
+	}
+	for (int i = TEST_SIZES[2] - 1; i > 0; i--) {
+		swap(randomKeys[i], randomKeys[(static_cast<long long>(rand()) * RAND_MAX + rand()) % (i + 1)]);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		cout << "Test size " << TEST_SIZES[i] << endl;
+		testWorkload<AATree<int, int> >("AATree sequential", sequentialKeys, TEST_SIZES[i]);
+		testWorkload<RedBlackTree<int, int> >("RedBlackTree sequential", sequentialKeys, TEST_SIZES[i]);
+		testWorkload<AATree<int, int> >("AATree random", randomKeys, TEST_SIZES[i]);
+		testWorkload<RedBlackTree<int, int> >("RedBlackTree random", randomKeys, TEST_SIZES[i]);
+	}
+
+	return 0;
+}